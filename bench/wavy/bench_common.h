@@ -0,0 +1,54 @@
+/**
+ * @file   bench_common.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.26
+ *
+ * @brief  Grid sizes and solver access shared by the benchmarks.
+ */
+
+#pragma once
+
+#include "fluid1d.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+#ifndef WAVY_BENCH_MAX_GRID_SIZE
+#define WAVY_BENCH_MAX_GRID_SIZE 100000000 // NOLINT(cppcoreguidelines-macro-usage)
+#endif
+
+namespace wavy::bench
+{
+    constexpr std::int64_t min_grid_size = 1'000;
+    constexpr std::int64_t max_grid_size = WAVY_BENCH_MAX_GRID_SIZE;
+    constexpr int grid_size_multiplier = 10;
+
+    /** Runs a benchmark for the grid sizes 1e3, 1e4, ... up to the configured maximum. */
+    inline void grid_sizes(benchmark::internal::Benchmark* bench)
+    {
+        bench->RangeMultiplier(grid_size_multiplier)->Range(min_grid_size, max_grid_size)->Unit(benchmark::kMicrosecond);
+    }
+
+    /** Reports the processed grid cells, so runs of different sizes are comparable. */
+    inline void set_cells_processed(benchmark::State& state)
+    {
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    /** Exposes the solver stages to the benchmarks. */
+    class FluidSolver1DBench : public FluidSolver1D
+    {
+    public:
+        using FluidSolver1D::FluidSolver1D;
+
+        using FluidSolver1D::advect;
+        using FluidSolver1D::bodyForces;
+        using FluidSolver1D::presure_gradient_rhs;
+        using FluidSolver1D::setup_A;
+
+        using FluidSolverBase::Integrate;
+        using FluidSolverBase::Interpolate;
+        using FluidSolverBase::InterpolateCubic;
+        using FluidSolverBase::InterpolateLinear;
+    };
+}
@@ -0,0 +1,90 @@
+/**
+ * @file   bench_fluid1d.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.26
+ *
+ * @brief  Benchmarks for the stages of the 1d fluid solver.
+ */
+
+#include "bench_common.h"
+
+#include <cmath>
+#include <vector>
+
+namespace wavy::bench
+{
+    namespace detail
+    {
+        constexpr float solver_delta_x = 0.01f;
+        constexpr float solver_g = 9.81f;
+        constexpr float solver_density = 1000.0f;
+        constexpr float solver_delta_t = 0.001f;
+
+        constexpr std::size_t ghost_cells = 2;
+
+        struct solver_state
+        {
+            explicit solver_state(std::size_t grid_size)
+                : solver{grid_size, solver_delta_x, solver_g, solver_density}
+                , u0_storage(utils::padded_size(grid_size + 1, ghost_cells), 0.0f)
+                , u0{u0_storage, ghost_cells}
+                , u1(grid_size + 1, 0.0f)
+                , rhs(grid_size, 0.0f)
+            {
+                for (std::size_t i = 0; i < u0.size(); ++i) { u0[i] = std::sin(0.01f * static_cast<float>(i)); }
+            }
+
+            FluidSolver1DBench solver;
+            std::vector<float> u0_storage;
+            utils::padded_span<float> u0;
+            std::vector<float> u1;
+            std::vector<float> rhs;
+        };
+    }
+
+    void BM_advect(benchmark::State& state)
+    {
+        detail::solver_state s{static_cast<std::size_t>(state.range(0))};
+        for (auto _ : state) {
+            s.solver.advect(detail::solver_delta_t, s.u0, s.u1);
+            benchmark::ClobberMemory();
+        }
+        set_cells_processed(state);
+    }
+
+    void BM_bodyForces(benchmark::State& state)
+    {
+        detail::solver_state s{static_cast<std::size_t>(state.range(0))};
+        for (auto _ : state) {
+            s.solver.bodyForces(detail::solver_delta_t, s.u0.get_content(), s.u1);
+            benchmark::ClobberMemory();
+        }
+        set_cells_processed(state);
+    }
+
+    void BM_setup_A(benchmark::State& state)
+    {
+        detail::solver_state s{static_cast<std::size_t>(state.range(0))};
+        for (auto _ : state) {
+            s.solver.setup_A(detail::solver_delta_t);
+            benchmark::ClobberMemory();
+        }
+        set_cells_processed(state);
+    }
+
+    void BM_presure_gradient_rhs(benchmark::State& state)
+    {
+        detail::solver_state s{static_cast<std::size_t>(state.range(0))};
+        auto solid_velocity = []([[maybe_unused]] std::size_t idx) { return 0.0f; };
+        for (auto _ : state) {
+            s.solver.presure_gradient_rhs(s.u0.get_content(), s.rhs, mysh::core::function_view<float(std::size_t)>{solid_velocity});
+            benchmark::ClobberMemory();
+        }
+        set_cells_processed(state);
+    }
+
+    BENCHMARK(BM_advect)->Apply(grid_sizes);
+    BENCHMARK(BM_bodyForces)->Apply(grid_sizes);
+    BENCHMARK(BM_setup_A)->Apply(grid_sizes);
+    BENCHMARK(BM_presure_gradient_rhs)->Apply(grid_sizes);
+}
@@ -0,0 +1,118 @@
+/**
+ * @file   bench_fluid_base.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.26
+ *
+ * @brief  Benchmarks for the interpolation and integration helpers of the fluid solvers.
+ */
+
+#include "bench_common.h"
+#include "utils/padded_span.h"
+
+#include <cmath>
+#include <vector>
+
+namespace wavy::bench
+{
+    namespace detail
+    {
+        constexpr std::size_t ghost_cells = 2;
+        constexpr float delta_x = 0.01f;
+        constexpr float delta_t = 0.001f;
+
+        class field
+        {
+        public:
+            explicit field(std::size_t size)
+                : m_storage(utils::padded_size(size, ghost_cells), 0.0f)
+                , m_padded{m_storage, ghost_cells}
+            {
+                for (std::size_t i = 0; i < size; ++i) { m_padded[i] = std::sin(0.01f * static_cast<float>(i)); }
+                m_padded.fill_ghost_cells();
+            }
+
+            [[nodiscard]] utils::padded_span<const float> padded() const { return m_padded; }
+            [[nodiscard]] utils::boundary_span<const float> bounded() const
+            {
+                return utils::boundary_span<const float>{m_padded.get_content()};
+            }
+
+        private:
+            std::vector<float> m_storage;
+            utils::padded_span<float> m_padded;
+        };
+
+        template<typename Field>
+        Field view(const field& f)
+        {
+            if constexpr (std::is_same_v<Field, utils::padded_span<const float>>) { return f.padded(); }
+            else { return f.bounded(); }
+        }
+    }
+
+    template<typename Field>
+    void BM_InterpolateLinear(benchmark::State& state)
+    {
+        const detail::field f{static_cast<std::size_t>(state.range(0))};
+        const auto q = detail::view<Field>(f);
+        for (auto _ : state) {
+            for (std::size_t i = 0; i < q.size(); ++i) {
+                benchmark::DoNotOptimize(FluidSolver1DBench::InterpolateLinear(q, 0.3f, i));
+            }
+        }
+        set_cells_processed(state);
+    }
+
+    template<typename Field>
+    void BM_InterpolateCubic(benchmark::State& state)
+    {
+        const detail::field f{static_cast<std::size_t>(state.range(0))};
+        const auto q = detail::view<Field>(f);
+        for (auto _ : state) {
+            for (std::size_t i = 0; i < q.size(); ++i) {
+                benchmark::DoNotOptimize(FluidSolver1DBench::InterpolateCubic(q, 0.3f, i));
+            }
+        }
+        set_cells_processed(state);
+    }
+
+    template<InterpolationMethod interpolation>
+    void BM_Interpolate(benchmark::State& state)
+    {
+        const detail::field f{static_cast<std::size_t>(state.range(0))};
+        const auto q = f.padded();
+        for (auto _ : state) {
+            for (std::size_t i = 0; i < q.size(); ++i) {
+                auto x = (static_cast<float>(i) + 0.3f) * detail::delta_x;
+                benchmark::DoNotOptimize(FluidSolver1DBench::Interpolate<interpolation>(q, x, detail::delta_x));
+            }
+        }
+        set_cells_processed(state);
+    }
+
+    template<IntegrationMethod integration, InterpolationMethod interpolation>
+    void BM_Integrate(benchmark::State& state)
+    {
+        const detail::field f{static_cast<std::size_t>(state.range(0))};
+        const auto u = f.padded();
+        for (auto _ : state) {
+            for (std::size_t i = 0; i < u.size(); ++i) {
+                auto x = static_cast<float>(i) * detail::delta_x;
+                benchmark::DoNotOptimize(
+                    FluidSolver1DBench::Integrate<integration, interpolation>(u, x, detail::delta_t, detail::delta_x));
+            }
+        }
+        set_cells_processed(state);
+    }
+
+    BENCHMARK_TEMPLATE(BM_InterpolateLinear, utils::boundary_span<const float>)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_InterpolateLinear, utils::padded_span<const float>)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_InterpolateCubic, utils::boundary_span<const float>)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_InterpolateCubic, utils::padded_span<const float>)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_Interpolate, InterpolationMethod::Linear)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_Interpolate, InterpolationMethod::Cubic)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_Integrate, IntegrationMethod::RK2, InterpolationMethod::Linear)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_Integrate, IntegrationMethod::RK3, InterpolationMethod::Linear)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_Integrate, IntegrationMethod::RK4, InterpolationMethod::Linear)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_Integrate, IntegrationMethod::RK4, InterpolationMethod::Cubic)->Apply(grid_sizes);
+}
@@ -0,0 +1,42 @@
+/**
+ * @file   bench_aligned_vector.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.26
+ *
+ * @brief  Benchmarks for element access of the aligned vector.
+ */
+
+#include "bench_common.h"
+#include "core/aligned_vector.h"
+
+#include <vector>
+
+namespace wavy::bench
+{
+    void BM_std_vector_access(benchmark::State& state)
+    {
+        const std::vector<float> v(static_cast<std::size_t>(state.range(0)), 1.0f);
+        for (auto _ : state) {
+            float sum = 0.0f;
+            for (std::size_t i = 0; i < v.size(); ++i) { sum += v[i]; }
+            benchmark::DoNotOptimize(sum);
+        }
+        set_cells_processed(state);
+    }
+
+    template<std::size_t aligned_size>
+    void BM_aligned_vector_access(benchmark::State& state)
+    {
+        const mysh::core::aligned_vector<float> v(aligned_size, static_cast<std::size_t>(state.range(0)), 1.0f);
+        for (auto _ : state) {
+            float sum = 0.0f;
+            for (std::size_t i = 0; i < v.size(); ++i) { sum += v[i]; }
+            benchmark::DoNotOptimize(sum);
+        }
+        set_cells_processed(state);
+    }
+
+    BENCHMARK(BM_std_vector_access)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_aligned_vector_access, sizeof(float))->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_aligned_vector_access, 4 * sizeof(float))->Apply(grid_sizes);
+}
@@ -0,0 +1,96 @@
+/**
+ * @file   bench_iterators.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.26
+ *
+ * @brief  Benchmarks comparing the zip and enumerate iterators with raw index loops.
+ */
+
+#include "bench_common.h"
+#include "utils/enumerate.h"
+#include "utils/index_range.h"
+#include "utils/zip.h"
+
+#include <execution>
+#include <numeric>
+#include <vector>
+
+namespace wavy::bench
+{
+    namespace detail
+    {
+        constexpr float saxpy_factor = 2.0f;
+
+        struct saxpy_data
+        {
+            explicit saxpy_data(std::size_t size) : x(size), y(size, 1.0f), result(size, 0.0f)
+            {
+                std::iota(std::begin(x), std::end(x), 0.0f);
+            }
+
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> result;
+        };
+    }
+
+    void BM_raw_index_loop(benchmark::State& state)
+    {
+        detail::saxpy_data d{static_cast<std::size_t>(state.range(0))};
+        for (auto _ : state) {
+            for (std::size_t i = 0; i < d.result.size(); ++i) { d.result[i] = detail::saxpy_factor * d.x[i] + d.y[i]; }
+            benchmark::ClobberMemory();
+        }
+        set_cells_processed(state);
+    }
+
+    template<const auto& execution_policy>
+    void BM_raw_index_for_each(benchmark::State& state)
+    {
+        detail::saxpy_data d{static_cast<std::size_t>(state.range(0))};
+        auto range = utils::indices(0, d.result.size());
+        for (auto _ : state) {
+            std::for_each(execution_policy, std::begin(range), std::end(range),
+                          [&d](std::size_t i) { d.result[i] = detail::saxpy_factor * d.x[i] + d.y[i]; });
+            benchmark::ClobberMemory();
+        }
+        set_cells_processed(state);
+    }
+
+    template<const auto& execution_policy>
+    void BM_zip_for_each(benchmark::State& state)
+    {
+        detail::saxpy_data d{static_cast<std::size_t>(state.range(0))};
+        auto zipped = utils::zip(d.x, d.y, d.result);
+        for (auto _ : state) {
+            std::for_each(execution_policy, std::begin(zipped), std::end(zipped), [](auto element) {
+                std::get<2>(element) = detail::saxpy_factor * std::get<0>(element) + std::get<1>(element);
+            });
+            benchmark::ClobberMemory();
+        }
+        set_cells_processed(state);
+    }
+
+    template<const auto& execution_policy>
+    void BM_enumerate_for_each(benchmark::State& state)
+    {
+        detail::saxpy_data d{static_cast<std::size_t>(state.range(0))};
+        auto enumerated = utils::enumerate(d.result);
+        for (auto _ : state) {
+            std::for_each(execution_policy, std::begin(enumerated), std::end(enumerated), [&d](auto element) {
+                auto i = std::get<0>(element);
+                std::get<1>(element) = detail::saxpy_factor * d.x[i] + d.y[i];
+            });
+            benchmark::ClobberMemory();
+        }
+        set_cells_processed(state);
+    }
+
+    BENCHMARK(BM_raw_index_loop)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_raw_index_for_each, std::execution::seq)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_raw_index_for_each, std::execution::par)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_zip_for_each, std::execution::seq)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_zip_for_each, std::execution::par)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_enumerate_for_each, std::execution::seq)->Apply(grid_sizes);
+    BENCHMARK_TEMPLATE(BM_enumerate_for_each, std::execution::par)->Apply(grid_sizes);
+}
@@ -44,6 +44,7 @@ namespace wavy
         RK2, RK3, RK4
     };
 
+    /** Default schemes, the fluid solvers can select others at construction (see kernels::AdvectionSettings). */
     constexpr InterpolationMethod interpolation_method = InterpolationMethod::Linear;
     constexpr IntegrationMethod integration_method = IntegrationMethod::RK2;
 }
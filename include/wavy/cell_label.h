@@ -0,0 +1,21 @@
+/**
+ * @file   cell_label.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.23
+ *
+ * @brief  Classification of grid cells.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace wavy
+{
+    enum class CellLabel : std::uint8_t
+    {
+        FLUID,
+        SOLID,
+        EMPTY
+    };
+}
@@ -8,212 +8,588 @@
 
 #pragma once
 
+#include <algorithm>
 #include <bit>
-#include <vector>
+#include <cassert>
+#include <compare>
 #include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 namespace mysh::core {
 
-    template<typename T> class aligned_vector
+    /** Random access iterator over elements that lie a fixed number of bytes apart. */
+    template<typename T>
+    class stride_iterator
     {
+        using byte_type = std::conditional_t<std::is_const_v<T>, const std::byte, std::byte>;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        stride_iterator() noexcept = default;
+        stride_iterator(T* element, std::size_t stride) noexcept
+            : m_element{element}
+            , m_stride{static_cast<difference_type>(stride)}
+        {
+        }
+        /** Converts a mutable iterator to a read only one. */
+        template<typename U>
+            requires(std::is_const_v<T> && std::is_same_v<std::remove_const_t<T>, U>)
+        stride_iterator(const stride_iterator<U>& other) noexcept // NOLINT(hicpp-explicit-conversions)
+            : m_element{other.operator->()}
+            , m_stride{other.stride()}
+        {
+        }
+
+        [[nodiscard]] reference operator*() const noexcept { return *m_element; }
+        [[nodiscard]] pointer operator->() const noexcept { return m_element; }
+        [[nodiscard]] reference operator[](difference_type n) const noexcept { return *advanced(n); }
+
+        stride_iterator& operator++() noexcept { return *this += 1; }
+        stride_iterator operator++(int) noexcept
+        {
+            auto result = *this;
+            *this += 1;
+            return result;
+        }
+        stride_iterator& operator--() noexcept { return *this -= 1; }
+        stride_iterator operator--(int) noexcept
+        {
+            auto result = *this;
+            *this -= 1;
+            return result;
+        }
+        stride_iterator& operator+=(difference_type n) noexcept
+        {
+            m_element = advanced(n);
+            return *this;
+        }
+        stride_iterator& operator-=(difference_type n) noexcept { return *this += -n; }
+
+        [[nodiscard]] friend stride_iterator operator+(stride_iterator it, difference_type n) noexcept { return it += n; }
+        [[nodiscard]] friend stride_iterator operator+(difference_type n, stride_iterator it) noexcept { return it += n; }
+        [[nodiscard]] friend stride_iterator operator-(stride_iterator it, difference_type n) noexcept { return it -= n; }
+        [[nodiscard]] friend difference_type operator-(const stride_iterator& lhs, const stride_iterator& rhs) noexcept
+        {
+            return (std::bit_cast<byte_type*>(lhs.m_element) - std::bit_cast<byte_type*>(rhs.m_element)) / lhs.m_stride;
+        }
+        [[nodiscard]] friend bool operator==(const stride_iterator& lhs, const stride_iterator& rhs) noexcept
+        {
+            return lhs.m_element == rhs.m_element;
+        }
+        [[nodiscard]] friend std::strong_ordering operator<=>(const stride_iterator& lhs,
+                                                              const stride_iterator& rhs) noexcept
+        {
+            return std::compare_three_way{}(lhs.m_element, rhs.m_element);
+        }
+
+        [[nodiscard]] difference_type stride() const noexcept { return m_stride; }
+
+    private:
+        [[nodiscard]] T* advanced(difference_type n) const noexcept
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            return std::bit_cast<T*>(std::bit_cast<byte_type*>(m_element) + n * m_stride);
+        }
+
+        T* m_element = nullptr;
+        difference_type m_stride = 1;
+    };
+
+    /**
+     *  A vector whose elements start every alignedSize bytes, in a buffer whose base address is a multiple of
+     *  Alignment. With alignedSize a multiple of the SIMD width every element can be loaded with aligned loads, with
+     *  alignedSize == sizeof(T) the elements are packed and can be viewed as a std::span.
+     *
+     *  The buffer is requested from the allocator (rebound to std::byte) with Alignment - 1 bytes of slack, so any
+     *  allocator can be used, e.g. a std::pmr::polymorphic_allocator on a ScratchArena.
+     */
+    template<typename T, std::size_t Alignment = 64, typename Allocator = std::allocator<std::byte>>
+    class aligned_vector
+    {
+        static_assert(std::has_single_bit(Alignment) && Alignment >= alignof(T),
+                      "The alignment has to be a power of two that is valid for the element type.");
+
     public:
         using value_type = T;
+        using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<std::byte>;
         using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
         using reference = value_type&;
         using const_reference = const value_type&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = stride_iterator<T>;
+        using const_iterator = stride_iterator<const T>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-        aligned_vector(size_type alignedSize, size_type count, const T& value);
-        explicit aligned_vector(size_type alignedSize, size_type count = 0) : m_alignedSize{alignedSize}
+        static constexpr std::size_t base_alignment = Alignment;
+
+        explicit aligned_vector(size_type alignedSize, const allocator_type& alloc = allocator_type{}) noexcept
+            : m_alloc{alloc}
+            , m_alignedSize{alignedSize}
         {
-            m_cont.resize(count * alignedSize);
+            assert(alignedSize >= sizeof(T) && alignedSize % alignof(T) == 0);
         }
-        // template<class InputIt> aligned_vector(size_type alignedSize, InputIt first, InputIt last);
-        aligned_vector(size_type alignedSize, std::initializer_list<T> init);
-        aligned_vector(const aligned_vector& rhs) : m_alignedSize{rhs.m_alignedSize}, m_cont{rhs.m_cont} {}
-        aligned_vector& operator=(const aligned_vector& /*rhs*/);
-        aligned_vector(aligned_vector&& rhs) noexcept : m_alignedSize{rhs.m_alignedSize}, m_cont{std::move(rhs.m_cont)}
+        explicit aligned_vector(size_type alignedSize, size_type count, const allocator_type& alloc = allocator_type{})
+            : aligned_vector{alignedSize, alloc}
         {
+            resize(count);
         }
-        aligned_vector& operator=(aligned_vector&& /*rhs*/) noexcept;
-        ~aligned_vector();
-
-        /*aligned_vector& operator=(std::initializer_list<T> ilist);
+        aligned_vector(size_type alignedSize, size_type count, const T& value,
+                       const allocator_type& alloc = allocator_type{})
+            : aligned_vector{alignedSize, alloc}
+        {
+            resize(count, value);
+        }
+        template<std::input_iterator InputIt>
+        aligned_vector(size_type alignedSize, InputIt first, InputIt last, const allocator_type& alloc = allocator_type{})
+            : aligned_vector{alignedSize, alloc}
+        {
+            assign(first, last);
+        }
+        aligned_vector(size_type alignedSize, std::initializer_list<T> init, const allocator_type& alloc = allocator_type{})
+            : aligned_vector{alignedSize, init.begin(), init.end(), alloc}
+        {
+        }
+        aligned_vector(const aligned_vector& rhs)
+            : aligned_vector{rhs, alloc_traits::select_on_container_copy_construction(rhs.m_alloc)}
+        {
+        }
+        aligned_vector(const aligned_vector& rhs, const allocator_type& alloc)
+            : aligned_vector{rhs.m_alignedSize, rhs.begin(), rhs.end(), alloc}
+        {
+        }
+        aligned_vector(aligned_vector&& rhs) noexcept
+            : m_alloc{std::move(rhs.m_alloc)}
+            , m_alignedSize{rhs.m_alignedSize}
+            , m_buffer{std::exchange(rhs.m_buffer, nullptr)}
+            , m_bufferSize{std::exchange(rhs.m_bufferSize, 0)}
+            , m_data{std::exchange(rhs.m_data, nullptr)}
+            , m_size{std::exchange(rhs.m_size, 0)}
+            , m_capacity{std::exchange(rhs.m_capacity, 0)}
+        {
+        }
+        aligned_vector(aligned_vector&& rhs, const allocator_type& alloc);
+        aligned_vector& operator=(const aligned_vector& rhs);
+        aligned_vector& operator=(aligned_vector&& rhs) noexcept(
+            std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value
+            || std::allocator_traits<allocator_type>::is_always_equal::value);
+        aligned_vector& operator=(std::initializer_list<T> ilist)
+        {
+            assign(ilist);
+            return *this;
+        }
+        ~aligned_vector() { release(); }
 
         void assign(size_type count, const T& value);
-        template<class InputIt> void assign(size_type alignment, InputIt first, InputIt last);
-        void assign(std::initializer_list<T> init);*/
+        template<std::input_iterator InputIt> void assign(InputIt first, InputIt last);
+        void assign(std::initializer_list<T> init) { assign(init.begin(), init.end()); }
+
+        [[nodiscard]] allocator_type get_allocator() const noexcept { return m_alloc; }
 
         [[nodiscard]] reference at(size_type pos)
         {
-            return *std::bit_cast<T*>(&m_cont.at(pos * m_alignedSize));
+            if (pos >= m_size) { throw std::out_of_range{"aligned_vector::at"}; }
+            return *element(pos);
         }
         [[nodiscard]] const_reference at(size_type pos) const
         {
-            return *std::bit_cast<const T*>(&m_cont.at(pos * m_alignedSize));
-        }
-        [[nodiscard]] reference operator[](size_type pos) { return *std::bit_cast<T*>(&m_cont[pos * m_alignedSize]); }
-        [[nodiscard]] const_reference operator[](size_type pos) const
-        {
-            return *std::bit_cast<const T*>(&m_cont[pos * m_alignedSize]);
-        }
-        [[nodiscard]] reference front() { return *std::bit_cast<T*>(&m_cont.front()); }
-        [[nodiscard]] const_reference front() const { return *std::bit_cast<const T*>(&m_cont.front()); }
-        [[nodiscard]] reference back() { return *std::bit_cast<T*>(&m_cont[m_cont.size() - m_alignedSize]); }
-        [[nodiscard]] const_reference back() const
-        {
-            return *std::bit_cast<const T*>(&m_cont[m_cont.size() - m_alignedSize]);
-        }
-        [[nodiscard]] T* data() noexcept { return std::bit_cast<T*>(m_cont.data()); }
-        [[nodiscard]] const T* data() const noexcept { return std::bit_cast<const T*>(m_cont.data()); }
-
-        /*iterator begin() noexcept;
-        const_iterator begin() const noexcept;
-        const_iterator cbegin() const noexcept;
-        iterator end() noexcept;
-        const_iterator end() const noexcept;
-        const_iterator cend() const noexcept;
-        reverse_iterator rbegin() noexcept;
-        const_reverse_iterator rbegin() const noexcept;
-        const_reverse_iterator crbegin() const noexcept;
-        reverse_iterator rend() noexcept;
-        const_reverse_iterator rend() const noexcept;
-        const_reverse_iterator crend() const noexcept;*/
-
-        [[nodiscard]] bool empty() const noexcept { return m_cont.empty(); }
-        [[nodiscard]] size_type size() const noexcept { return m_cont.size() / m_alignedSize; }
-        [[nodiscard]] size_type max_size() const noexcept { return m_cont.max_size() / m_alignedSize; }
-        void reserve(size_type new_cap) { m_cont.reserve(new_cap * m_alignedSize); }
-        [[nodiscard]] size_type capacity() const noexcept { return m_cont.capacity() / m_alignedSize; }
-        void shrink_to_fit() { m_cont.shrink_to_fit(); }
-
-        void clear() noexcept { m_cont.clear(); }
-        /*iterator insert(const_iterator pos, const T& value);
-        iterator insert(const_iterator pos, T&& value);
+            if (pos >= m_size) { throw std::out_of_range{"aligned_vector::at"}; }
+            return *element(pos);
+        }
+        [[nodiscard]] reference operator[](size_type pos) { return *element(pos); }
+        [[nodiscard]] const_reference operator[](size_type pos) const { return *element(pos); }
+        [[nodiscard]] reference front() { return *element(0); }
+        [[nodiscard]] const_reference front() const { return *element(0); }
+        [[nodiscard]] reference back() { return *element(m_size - 1); }
+        [[nodiscard]] const_reference back() const { return *element(m_size - 1); }
+        [[nodiscard]] T* data() noexcept { return std::bit_cast<T*>(m_data); }
+        [[nodiscard]] const T* data() const noexcept { return std::bit_cast<const T*>(m_data); }
+
+        /** Whether the elements are packed without padding, only then the vector can be viewed as a span. */
+        [[nodiscard]] bool is_contiguous() const noexcept { return m_alignedSize == sizeof(T); }
+        [[nodiscard]] std::span<T> as_span() noexcept
+        {
+            assert(is_contiguous());
+            return {data(), m_size};
+        }
+        [[nodiscard]] std::span<const T> as_span() const noexcept
+        {
+            assert(is_contiguous());
+            return {data(), m_size};
+        }
+
+        [[nodiscard]] iterator begin() noexcept { return iterator{data(), m_alignedSize}; }
+        [[nodiscard]] const_iterator begin() const noexcept { return const_iterator{data(), m_alignedSize}; }
+        [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+        [[nodiscard]] iterator end() noexcept { return begin() + static_cast<difference_type>(m_size); }
+        [[nodiscard]] const_iterator end() const noexcept { return begin() + static_cast<difference_type>(m_size); }
+        [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+        [[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+        [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+        [[nodiscard]] const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+        [[nodiscard]] reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+        [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+        [[nodiscard]] const_reverse_iterator crend() const noexcept { return rend(); }
+
+        [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+        [[nodiscard]] size_type size() const noexcept { return m_size; }
+        [[nodiscard]] size_type max_size() const noexcept
+        {
+            return (alloc_traits::max_size(m_alloc) - Alignment) / m_alignedSize;
+        }
+        void reserve(size_type new_cap)
+        {
+            if (new_cap > max_size()) { throw std::length_error{"aligned_vector::reserve"}; }
+            if (new_cap > m_capacity) { reallocate(new_cap); }
+        }
+        [[nodiscard]] size_type capacity() const noexcept { return m_capacity; }
+        void shrink_to_fit()
+        {
+            if (m_capacity > m_size) { reallocate(m_size); }
+        }
+
+        void clear() noexcept { destroy_from(0); }
+        iterator insert(const_iterator pos, const T& value) { return insert(pos, 1, value); }
+        iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
         iterator insert(const_iterator pos, size_type count, const T& value);
-        template<class InputIt> iterator insert(const_iterator pos, InputIt first, InputIt last);
-        iterator insert(const_iterator pos, std::initializer_list<T> ilist);
+        template<std::input_iterator InputIt> iterator insert(const_iterator pos, InputIt first, InputIt last);
+        iterator insert(const_iterator pos, std::initializer_list<T> ilist)
+        {
+            return insert(pos, ilist.begin(), ilist.end());
+        }
         template<class... Args> iterator emplace(const_iterator pos, Args&&... args);
-        iterator erase(const_iterator pos);
-        iterator erase(const_iterator first, const_iterator last);*/
-        void push_back(const T& value);
-        void push_back(T&& value);
+        iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+        iterator erase(const_iterator first, const_iterator last);
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
         template<class... Args> reference emplace_back(Args&&... args);
         void pop_back();
-        void resize(size_type count) { m_cont.resize(count * m_alignedSize); }
+        void resize(size_type count);
         void resize(size_type count, const value_type& value);
         void swap(aligned_vector& other) noexcept;
 
         [[nodiscard]] std::size_t GetAlignedSize() const { return m_alignedSize; }
 
+        [[nodiscard]] friend bool operator==(const aligned_vector& lhs, const aligned_vector& rhs)
+        {
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
+
     private:
+        using alloc_traits = std::allocator_traits<allocator_type>;
+
+        [[nodiscard]] T* element(size_type pos) const noexcept
+        {
+            return std::bit_cast<T*>(m_data + pos * m_alignedSize); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        [[nodiscard]] size_type index(const_iterator pos) const noexcept
+        {
+            return static_cast<size_type>(pos - cbegin());
+        }
+        /** Moves the elements to a new buffer of new_capacity elements. */
+        void reallocate(size_type new_capacity);
+        /** Grows the buffer geometrically until count elements fit. */
+        void grow_to(size_type count);
+        /** Moves the elements from pos on count places back, the gap keeps (moved from) elements below the old size. */
+        void open_gap(size_type pos, size_type count);
+        /** Writes value to the slot pos of a gap, assigning to it if old_size says it still holds an element. */
+        template<typename U> void fill_gap(size_type pos, size_type old_size, U&& value);
+        void destroy_from(size_type pos) noexcept;
+        /** Destroys all elements and gives the buffer back. */
+        void release() noexcept;
+
+        allocator_type m_alloc;
         /** Holds the vectors alignment. */
         std::size_t m_alignedSize{};
-        /** Holds the internal byte vector. */
-        std::vector<std::uint8_t> m_cont;
+        /** The buffer as returned by the allocator and its size in bytes. */
+        std::byte* m_buffer = nullptr;
+        std::size_t m_bufferSize = 0;
+        /** The first element, the first multiple of Alignment in the buffer. */
+        std::byte* m_data = nullptr;
+        size_type m_size = 0;
+        size_type m_capacity = 0;
     };
 
-    template<typename T>
-    inline aligned_vector<T>::aligned_vector(size_type alignedSize, size_type count, const T& value) :
-        aligned_vector{ alignedSize, count }
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline aligned_vector<T, Alignment, Allocator>::aligned_vector(aligned_vector&& rhs, const allocator_type& alloc)
+        : aligned_vector{rhs.m_alignedSize, alloc}
     {
-        for (size_type i = 0U; i < count; ++i) { new (std::bit_cast<T*>(&m_cont[i * m_alignedSize])) T(value); }
+        if (m_alloc == rhs.m_alloc) {
+            swap(rhs);
+            return;
+        }
+        reserve(rhs.m_size);
+        for (auto& elem : rhs) { emplace_back(std::move(elem)); }
     }
 
-    template<typename T>
-    inline aligned_vector<T>::aligned_vector(size_type alignedSize, std::initializer_list<T> init) :
-        aligned_vector{ alignedSize, init.size() }
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline aligned_vector<T, Alignment, Allocator>&
+    aligned_vector<T, Alignment, Allocator>::operator=(const aligned_vector& rhs)
     {
-        size_type i = 0U;
-        for (const auto& elem : init) {
-            new (std::bit_cast<T*>(m_cont[i * m_alignedSize])) T(elem);
-            i += 1;
+        if (this == &rhs) { return *this; }
+        if (m_alignedSize != rhs.m_alignedSize
+            || (alloc_traits::propagate_on_container_copy_assignment::value && m_alloc != rhs.m_alloc)) {
+            // the buffer does not fit the new layout or belongs to an allocator that is replaced.
+            release();
         }
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) { m_alloc = rhs.m_alloc; }
+        m_alignedSize = rhs.m_alignedSize;
+        assign(rhs.begin(), rhs.end());
+        return *this;
     }
 
-    template<typename T>
-    inline aligned_vector<T>& aligned_vector<T>::operator=(const aligned_vector<T>& rhs)
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline aligned_vector<T, Alignment, Allocator>&
+    aligned_vector<T, Alignment, Allocator>::operator=(aligned_vector&& rhs) noexcept(
+        std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value
+        || std::allocator_traits<allocator_type>::is_always_equal::value)
     {
-        if (this != &rhs) {
+        if (this == &rhs) { return *this; }
+        if (alloc_traits::propagate_on_container_move_assignment::value || m_alloc == rhs.m_alloc) {
+            release();
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+                m_alloc = std::move(rhs.m_alloc);
+            }
             m_alignedSize = rhs.m_alignedSize;
-            m_cont = rhs.m_cont;
+            m_buffer = std::exchange(rhs.m_buffer, nullptr);
+            m_bufferSize = std::exchange(rhs.m_bufferSize, 0);
+            m_data = std::exchange(rhs.m_data, nullptr);
+            m_size = std::exchange(rhs.m_size, 0);
+            m_capacity = std::exchange(rhs.m_capacity, 0);
+            return *this;
         }
+        // the allocators differ and stay, so the elements are moved one by one.
+        if (m_alignedSize != rhs.m_alignedSize) { release(); }
+        m_alignedSize = rhs.m_alignedSize;
+        assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+        rhs.clear();
         return *this;
     }
 
-    template<typename T>
-    inline aligned_vector<T>& aligned_vector<T>::operator=(aligned_vector<T>&& rhs) noexcept
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::assign(size_type count, const T& value)
     {
-        m_alignedSize = rhs.m_alignedSize;
-        m_cont = std::move(rhs.m_cont);
-        return *this;
+        const T copy = value;
+        clear();
+        resize(count, copy);
     }
 
-    template<typename T>
-    inline aligned_vector<T>::~aligned_vector()
+    template<typename T, std::size_t Alignment, typename Allocator>
+    template<std::input_iterator InputIt>
+    inline void aligned_vector<T, Alignment, Allocator>::assign(InputIt first, InputIt last)
     {
-        for (size_type i = 0; i < m_cont.size(); i += m_alignedSize) {
-            auto* element_ptr = std::bit_cast<T*>(&m_cont[i]);
-            element_ptr->~T();
-        }
+        clear();
+        if constexpr (std::forward_iterator<InputIt>) { reserve(static_cast<size_type>(std::distance(first, last))); }
+        for (; first != last; ++first) { emplace_back(*first); }
     }
 
-    template<typename T>
-    inline void aligned_vector<T>::push_back(const T& value)
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline typename aligned_vector<T, Alignment, Allocator>::iterator
+    aligned_vector<T, Alignment, Allocator>::insert(const_iterator pos, size_type count, const T& value)
     {
-        auto oldSize = m_cont.size();
-        m_cont.resize(oldSize + m_alignedSize);
-        new (std::bit_cast<T*>(m_cont.data() + oldSize)) T(value); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto first = index(pos);
+        // the value may be an element of this vector, it is copied before anything moves.
+        const T copy = value;
+        const auto old_size = m_size;
+        open_gap(first, count);
+        for (size_type i = 0; i < count; ++i) { fill_gap(first + i, old_size, copy); }
+        m_size = old_size + count;
+        return begin() + static_cast<difference_type>(first);
     }
 
-    template<typename T>
-    inline void aligned_vector<T>::push_back(T&& value)
+    template<typename T, std::size_t Alignment, typename Allocator>
+    template<std::input_iterator InputIt>
+    inline typename aligned_vector<T, Alignment, Allocator>::iterator
+    aligned_vector<T, Alignment, Allocator>::insert(const_iterator pos, InputIt first, InputIt last)
     {
-        auto oldSize = m_cont.size();
-        m_cont.resize(oldSize + m_alignedSize);
-        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-        new (std::bit_cast<T*>(m_cont.data() + oldSize))T(std::move(value));
-        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto first_index = index(pos);
+        if constexpr (std::forward_iterator<InputIt>) {
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            const auto old_size = m_size;
+            open_gap(first_index, count);
+            for (size_type i = 0; i < count; ++i, ++first) { fill_gap(first_index + i, old_size, *first); }
+            m_size = old_size + count;
+        } else {
+            // single pass ranges are collected first, so the elements behind pos are moved only once.
+            aligned_vector values{m_alignedSize, first, last, m_alloc};
+            insert(pos, std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+        }
+        return begin() + static_cast<difference_type>(first_index);
     }
 
-    template<typename T>
-    template<class ...Args>
-    inline typename aligned_vector<T>::reference aligned_vector<T>::emplace_back(Args&&... args)
+    template<typename T, std::size_t Alignment, typename Allocator>
+    template<class... Args>
+    inline typename aligned_vector<T, Alignment, Allocator>::iterator
+    aligned_vector<T, Alignment, Allocator>::emplace(const_iterator pos, Args&&... args)
+    {
+        const auto first = index(pos);
+        if (first == m_size) {
+            emplace_back(std::forward<Args>(args)...);
+        } else {
+            T value(std::forward<Args>(args)...);
+            const auto old_size = m_size;
+            open_gap(first, 1);
+            fill_gap(first, old_size, std::move(value));
+            m_size = old_size + 1;
+        }
+        return begin() + static_cast<difference_type>(first);
+    }
+
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline typename aligned_vector<T, Alignment, Allocator>::iterator
+    aligned_vector<T, Alignment, Allocator>::erase(const_iterator first, const_iterator last)
     {
-        auto oldSize = m_cont.size();
-        m_cont.resize(oldSize + m_alignedSize);
-        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-        new (std::bit_cast<T*>(m_cont.data() + oldSize)) T(std::forward<Args>(args)...);
-        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto first_index = index(first);
+        const auto count = static_cast<size_type>(last - first);
+        if (count == 0) { return begin() + static_cast<difference_type>(first_index); }
+        for (auto i = first_index; i + count < m_size; ++i) { *element(i) = std::move(*element(i + count)); }
+        destroy_from(m_size - count);
+        return begin() + static_cast<difference_type>(first_index);
+    }
 
+    template<typename T, std::size_t Alignment, typename Allocator>
+    template<class... Args>
+    inline typename aligned_vector<T, Alignment, Allocator>::reference
+    aligned_vector<T, Alignment, Allocator>::emplace_back(Args&&... args)
+    {
+        if (m_size == m_capacity) {
+            // the arguments may refer to an element, so the new one is created before the buffer moves.
+            T value(std::forward<Args>(args)...);
+            grow_to(m_size + 1);
+            std::construct_at(element(m_size), std::move(value));
+        } else {
+            std::construct_at(element(m_size), std::forward<Args>(args)...);
+        }
+        m_size += 1;
         return back();
     }
 
-    template<typename T>
-    inline void aligned_vector<T>::pop_back()
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::pop_back()
     {
-        back()->~T();
-        for (auto i = 0U; i < m_alignedSize; ++i) { m_cont.pop_back(); }
+        assert(!empty());
+        destroy_from(m_size - 1);
     }
 
-    template<typename T>
-    inline void aligned_vector<T>::resize(size_type count, const value_type& value)
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::resize(size_type count)
     {
-        auto oldElems = m_cont.size() / m_alignedSize;
-        m_cont.resize(count * m_alignedSize);
-        for (auto i = oldElems; i < count; ++i) {
-            auto newElemPos = (oldElems + i) * m_alignedSize;
-            // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            new (std::bit_cast<T*>(m_cont.data() + newElemPos)) T(value);
-            // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (count <= m_size) {
+            destroy_from(count);
+            return;
         }
+        reserve(count);
+        for (; m_size < count; ++m_size) { std::construct_at(element(m_size)); }
     }
 
-    template<typename T>
-    inline void aligned_vector<T>::swap(aligned_vector& other) noexcept
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::resize(size_type count, const value_type& value)
+    {
+        if (count <= m_size) {
+            destroy_from(count);
+            return;
+        }
+        const T copy = value;
+        reserve(count);
+        for (; m_size < count; ++m_size) { std::construct_at(element(m_size), copy); }
+    }
+
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::swap(aligned_vector& other) noexcept
+    {
+        if constexpr (alloc_traits::propagate_on_container_swap::value) { std::swap(m_alloc, other.m_alloc); }
+        std::swap(m_alignedSize, other.m_alignedSize);
+        std::swap(m_buffer, other.m_buffer);
+        std::swap(m_bufferSize, other.m_bufferSize);
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+    }
+
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::reallocate(size_type new_capacity)
+    {
+        std::byte* buffer = nullptr;
+        std::size_t buffer_size = 0;
+        std::byte* data = nullptr;
+        if (new_capacity > 0) {
+            buffer_size = new_capacity * m_alignedSize + Alignment - 1;
+            buffer = alloc_traits::allocate(m_alloc, buffer_size);
+            const auto offset = (Alignment - std::bit_cast<std::uintptr_t>(buffer) % Alignment) % Alignment;
+            data = buffer + offset; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+
+        for (size_type i = 0; i < m_size; ++i) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            std::construct_at(std::bit_cast<T*>(data + i * m_alignedSize), std::move_if_noexcept(*element(i)));
+            std::destroy_at(element(i));
+        }
+        if (m_buffer != nullptr) { alloc_traits::deallocate(m_alloc, m_buffer, m_bufferSize); }
+        m_buffer = buffer;
+        m_bufferSize = buffer_size;
+        m_data = data;
+        m_capacity = new_capacity;
+    }
+
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::grow_to(size_type count)
+    {
+        if (count > m_capacity) { reserve(std::max(count, 2 * m_capacity)); }
+    }
+
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::open_gap(size_type pos, size_type count)
+    {
+        grow_to(m_size + count);
+        for (auto i = m_size; i-- > pos;) {
+            if (i + count >= m_size) {
+                std::construct_at(element(i + count), std::move(*element(i)));
+            } else {
+                *element(i + count) = std::move(*element(i));
+            }
+        }
+    }
+
+    template<typename T, std::size_t Alignment, typename Allocator>
+    template<typename U>
+    inline void aligned_vector<T, Alignment, Allocator>::fill_gap(size_type pos, size_type old_size, U&& value)
+    {
+        if (pos < old_size) {
+            *element(pos) = std::forward<U>(value);
+        } else {
+            std::construct_at(element(pos), std::forward<U>(value));
+        }
+    }
+
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::destroy_from(size_type pos) noexcept
+    {
+        for (auto i = pos; i < m_size; ++i) { std::destroy_at(element(i)); }
+        m_size = std::min(m_size, pos);
+    }
+
+    template<typename T, std::size_t Alignment, typename Allocator>
+    inline void aligned_vector<T, Alignment, Allocator>::release() noexcept
     {
-        auto tmp = other.m_alignedSize;
-        other.m_alignedSize = m_alignedSize;
-        m_alignedSize = tmp;
-        m_cont.swap(other.m_cont);
+        clear();
+        if (m_buffer != nullptr) { alloc_traits::deallocate(m_alloc, m_buffer, m_bufferSize); }
+        m_buffer = nullptr;
+        m_bufferSize = 0;
+        m_data = nullptr;
+        m_capacity = 0;
     }
 }
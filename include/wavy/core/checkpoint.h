@@ -0,0 +1,168 @@
+/**
+ * @file   checkpoint.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.05
+ *
+ * @brief  Binary checkpoints of solver state that are written in the background and loaded by memory mapping.
+ */
+
+#pragma once
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <span>
+#include <sstream>
+#include <spanstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace mysh::core {
+
+    /** The version of the file layout, files of other versions are rejected. */
+    constexpr std::uint32_t checkpoint_format_version = 1;
+
+    class CheckpointError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /** A field stored in a checkpoint, the offset is relative to the first block. */
+    struct CheckpointBlock
+    {
+        std::string name;
+        std::uint64_t offset = 0;
+        std::uint64_t bytes = 0;
+        std::uint32_t element_size = 0;
+
+        template<typename Archive>
+        void serialize(Archive& archive, [[maybe_unused]] std::uint32_t version)
+        {
+            archive(name, offset, bytes, element_size);
+        }
+    };
+
+    /** Describes the content of a checkpoint, it is followed by the raw blocks in the file. */
+    struct CheckpointHeader
+    {
+        /** What wrote the checkpoint, e.g. the solver class, so it is not restored into something else. */
+        std::string kind;
+        /** The parameters of the writer as a cereal archive, see Checkpoint::set_parameters. */
+        std::string parameters;
+        std::vector<CheckpointBlock> blocks;
+
+        template<typename Archive>
+        void serialize(Archive& archive, [[maybe_unused]] std::uint32_t version)
+        {
+            archive(kind, parameters, blocks);
+        }
+    };
+
+    namespace detail {
+        /** Every block starts at a multiple of this, so mapped fields can be used for vector loads directly. */
+        constexpr std::size_t checkpoint_block_alignment = 64;
+    }
+
+    /**
+     *  A snapshot of solver state: parameters of any cereal serializable type and named fields of trivially copyable
+     *  values. The fields are copied when they are added, so the solver can go on while the snapshot is written, e.g.
+     *  with std::move(checkpoint).write_async(path).
+     *
+     *  The file holds a small fixed preamble, the header as a portable cereal archive and then the raw field blocks,
+     *  each aligned to a cache line. A MappedCheckpoint reads the fields in place without parsing or copying them.
+     */
+    class Checkpoint
+    {
+    public:
+        explicit Checkpoint(std::string kind) { m_header.kind = std::move(kind); }
+
+        template<typename Parameters>
+        void set_parameters(const Parameters& parameters)
+        {
+            std::ostringstream stream;
+            {
+                cereal::PortableBinaryOutputArchive archive{stream};
+                archive(parameters);
+            }
+            m_header.parameters = std::move(stream).str();
+        }
+
+        template<typename T>
+        void add_field(std::string name, std::span<const T> values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Fields are stored as raw bytes.");
+            add_block(std::move(name), std::as_bytes(values), sizeof(T));
+        }
+
+        /** Writes the checkpoint to a temporary file next to path and renames it, so path is never half written. */
+        void write(const std::filesystem::path& path) const;
+        /** Writes the checkpoint on a background thread, the future rethrows errors of the write. */
+        [[nodiscard]] std::future<void> write_async(std::filesystem::path path) &&;
+
+    private:
+        void add_block(std::string name, std::span<const std::byte> bytes, std::size_t element_size);
+
+        CheckpointHeader m_header;
+        std::vector<std::byte> m_blocks;
+    };
+
+    /**
+     *  A checkpoint file mapped into memory. Only the header is parsed on opening, the fields are views of the
+     *  mapping and their pages are read by the operating system when they are first accessed.
+     */
+    class MappedCheckpoint
+    {
+    public:
+        explicit MappedCheckpoint(const std::filesystem::path& path);
+        MappedCheckpoint(const MappedCheckpoint&) = delete;
+        MappedCheckpoint& operator=(const MappedCheckpoint&) = delete;
+        MappedCheckpoint(MappedCheckpoint&& rhs) noexcept;
+        MappedCheckpoint& operator=(MappedCheckpoint&& rhs) noexcept;
+        ~MappedCheckpoint();
+
+        [[nodiscard]] const std::string& kind() const { return m_header.kind; }
+
+        template<typename Parameters>
+        [[nodiscard]] Parameters parameters() const
+        {
+            Parameters parameters{};
+            std::ispanstream stream{std::span<const char>{m_header.parameters}};
+            cereal::PortableBinaryInputArchive archive{stream};
+            archive(parameters);
+            return parameters;
+        }
+
+        [[nodiscard]] bool contains(std::string_view name) const;
+
+        /** The values of a field, throws a CheckpointError if it is missing or holds values of another size. */
+        template<typename T>
+        [[nodiscard]] std::span<const T> field(std::string_view name) const
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Fields are stored as raw bytes.");
+            auto bytes = block(name, sizeof(T));
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            return {reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T)};
+        }
+
+    private:
+        [[nodiscard]] std::span<const std::byte> block(std::string_view name, std::size_t element_size) const;
+        void unmap() noexcept;
+
+        const std::byte* m_data = nullptr;
+        std::size_t m_size = 0;
+        std::size_t m_blocks_offset = 0;
+        CheckpointHeader m_header;
+    };
+}
+
+CEREAL_CLASS_VERSION(mysh::core::CheckpointBlock, 1)
+CEREAL_CLASS_VERSION(mysh::core::CheckpointHeader, 1)
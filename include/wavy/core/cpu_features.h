@@ -0,0 +1,25 @@
+/**
+ * @file   cpu_features.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.25
+ *
+ * @brief  Runtime detection of the vector instruction sets of the CPU.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace mysh::core {
+
+    /** Vector instruction set levels that kernels are specialized for, ordered by width. */
+    enum class SimdLevel : std::uint8_t
+    {
+        Scalar,
+        AVX2,
+        AVX512
+    };
+
+    /** Returns the widest level supported by the CPU and the operating system (detected once). */
+    [[nodiscard]] SimdLevel simd_level();
+}
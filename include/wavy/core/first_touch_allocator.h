@@ -0,0 +1,113 @@
+/**
+ * @file   first_touch_allocator.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.02
+ *
+ * @brief  Allocator for fields whose pages are placed by the threads that first write them.
+ */
+
+#pragma once
+
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mysh::core {
+
+    struct FirstTouchSettings
+    {
+        /**
+         *  Initializes the fields in parallel with the same chunks the solver stages use, so on NUMA systems every
+         *  page lands on the node of the thread that works on it. Otherwise the constructing thread touches all pages.
+         */
+        bool parallel = true;
+        /** Aligns fields of at least 2 MiB to huge pages and asks the system to back them with huge pages (Linux). */
+        bool huge_pages = false;
+    };
+
+    namespace detail {
+        void* allocate_pages(std::size_t bytes, std::size_t alignment, bool huge_pages);
+        void deallocate_pages(void* ptr, std::size_t bytes, std::size_t alignment, bool huge_pages) noexcept;
+    }
+
+    /**
+     *  An allocator that default initializes the elements it constructs without arguments. A vector of trivial values
+     *  created with it does not write its memory, so the operating system has not placed any of its pages yet and
+     *  first_touch can decide where they go.
+     */
+    template<typename T>
+    class first_touch_allocator
+    {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        first_touch_allocator() noexcept = default;
+        explicit first_touch_allocator(bool huge_pages) noexcept : m_huge_pages{huge_pages} {}
+        template<typename U>
+        first_touch_allocator(const first_touch_allocator<U>& other) noexcept // NOLINT(hicpp-explicit-conversions)
+            : m_huge_pages{other.huge_pages()}
+        {
+        }
+
+        [[nodiscard]] T* allocate(std::size_t n)
+        {
+            return static_cast<T*>(detail::allocate_pages(n * sizeof(T), alignof(T), m_huge_pages));
+        }
+        void deallocate(T* ptr, std::size_t n) noexcept
+        {
+            detail::deallocate_pages(ptr, n * sizeof(T), alignof(T), m_huge_pages);
+        }
+
+        template<typename U>
+        void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+        {
+            ::new (static_cast<void*>(ptr)) U;
+        }
+        template<typename U, typename... Args>
+        void construct(U* ptr, Args&&... args)
+        {
+            std::construct_at(ptr, std::forward<Args>(args)...);
+        }
+
+        [[nodiscard]] bool huge_pages() const noexcept { return m_huge_pages; }
+
+        template<typename U>
+        bool operator==(const first_touch_allocator<U>& other) const noexcept
+        {
+            return m_huge_pages == other.huge_pages();
+        }
+
+    private:
+        bool m_huge_pages = false;
+    };
+
+    /** A vector whose elements are left uninitialized on creation, they are written by first_touch. */
+    template<typename T>
+    using first_touch_vector = std::vector<T, first_touch_allocator<T>>;
+
+    /**
+     *  Writes value to all elements in chunks of grain_size on the pool. Passing the grain size of the stages that
+     *  use the data makes the same threads touch (and thereby place) the same pages. Without settings.parallel the
+     *  calling thread writes everything.
+     */
+    template<typename T>
+    void first_touch(ThreadPool& pool, std::span<T> data, const T& value, std::size_t grain_size,
+                     const FirstTouchSettings& settings = {})
+    {
+        if (!settings.parallel) { grain_size = data.size(); }
+        pool.parallel_for(0, data.size(), grain_size, [data, &value](std::size_t first, std::size_t last) {
+            std::fill(data.begin() + static_cast<std::ptrdiff_t>(first), data.begin() + static_cast<std::ptrdiff_t>(last),
+                      value);
+        });
+    }
+}
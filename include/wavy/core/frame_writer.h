@@ -0,0 +1,163 @@
+/**
+ * @file   frame_writer.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.06
+ *
+ * @brief  Streams simulation frames to a file from a background thread.
+ */
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mysh::core {
+
+    /** The version of the frame file layout, files of other versions are rejected. */
+    constexpr std::uint32_t frame_format_version = 1;
+
+    class FrameFileError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    struct FrameWriterSettings
+    {
+        /** Compresses the fields with lz4 on the writer thread. */
+        bool compress = false;
+    };
+
+    /** A field of a frame: a name and the raw bytes of its values. */
+    struct FrameField
+    {
+        std::string_view name;
+        std::span<const std::byte> bytes;
+        std::uint32_t element_size = 0;
+    };
+
+    template<typename T>
+    [[nodiscard]] FrameField frame_field(std::string_view name, std::span<const T> values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Fields are stored as raw bytes.");
+        return {name, std::as_bytes(values), sizeof(T)};
+    }
+
+    /**
+     *  Writes a stream of frames, each a time and a set of named fields. write_frame only copies the fields into one
+     *  of two buffers that are kept between frames, compressing and writing happens on a background thread. The
+     *  simulation only waits if both buffers are still queued, i.e. if the disk is slower than the simulation.
+     *
+     *  Every frame is a self contained chunk in the file, the file ends with an index of the chunk offsets so a
+     *  FrameReader can seek to any frame. Errors of the writer thread are rethrown by the next write_frame or close.
+     */
+    class FrameWriter
+    {
+    public:
+        explicit FrameWriter(const std::filesystem::path& path, const FrameWriterSettings& settings = {});
+        FrameWriter(const FrameWriter&) = delete;
+        FrameWriter& operator=(const FrameWriter&) = delete;
+        FrameWriter(FrameWriter&&) = delete;
+        FrameWriter& operator=(FrameWriter&&) = delete;
+        /** Closes the file, errors of the writer thread are logged. */
+        ~FrameWriter();
+
+        void write_frame(double time, std::span<const FrameField> fields);
+        void write_frame(double time, std::initializer_list<FrameField> fields)
+        {
+            write_frame(time, std::span<const FrameField>{fields.begin(), fields.size()});
+        }
+        /** Writes the queued frames and the index. */
+        void close();
+
+        [[nodiscard]] std::size_t frame_count() const { return m_frame_count; }
+
+    private:
+        struct FieldRecord
+        {
+            std::string name;
+            std::uint32_t element_size = 0;
+            std::size_t offset = 0;
+            std::size_t bytes = 0;
+        };
+
+        struct Buffer
+        {
+            double time = 0.0;
+            std::vector<FieldRecord> fields;
+            std::vector<std::byte> data;
+            std::vector<std::byte> compressed;
+        };
+
+        void run();
+        void write_buffer(Buffer& buffer);
+        void write_index();
+
+        FrameWriterSettings m_settings;
+        std::ofstream m_file;
+        std::size_t m_frame_count = 0;
+        /** The file offset and time of every written frame. */
+        std::vector<std::pair<std::uint64_t, double>> m_index;
+
+        std::array<Buffer, 2> m_buffers;
+        std::mutex m_mutex;
+        std::condition_variable m_buffer_queued;
+        std::condition_variable m_buffer_freed;
+        std::deque<Buffer*> m_free;
+        std::deque<Buffer*> m_queued;
+        bool m_closing = false;
+        std::exception_ptr m_error;
+        std::thread m_thread;
+    };
+
+    /** A frame read from a file, the fields are stored with the alignment of operator new. */
+    struct Frame
+    {
+        double time = 0.0;
+        std::vector<std::string> names;
+        std::vector<std::uint32_t> element_sizes;
+        std::vector<std::vector<std::byte>> data;
+
+        template<typename T>
+        [[nodiscard]] std::span<const T> field(std::string_view name) const
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Fields are stored as raw bytes.");
+            const auto& bytes = field_bytes(name, sizeof(T));
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            return {reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T)};
+        }
+
+    private:
+        [[nodiscard]] const std::vector<std::byte>& field_bytes(std::string_view name, std::size_t element_size) const;
+    };
+
+    /** Reads single frames of a file written by FrameWriter using the index at its end. */
+    class FrameReader
+    {
+    public:
+        explicit FrameReader(const std::filesystem::path& path);
+
+        [[nodiscard]] std::size_t frame_count() const { return m_index.size(); }
+        [[nodiscard]] double time(std::size_t frame) const { return m_index[frame].second; }
+        [[nodiscard]] Frame read_frame(std::size_t frame);
+
+    private:
+        std::ifstream m_file;
+        std::vector<std::pair<std::uint64_t, double>> m_index;
+    };
+}
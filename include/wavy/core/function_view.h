@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <bit>
+#include <cstdint>
 #include <type_traits>
 #include <functional>
 
@@ -30,7 +32,7 @@ namespace mysh::core {
 
         template<typename Callable> static Ret callback_fn(intptr_t callable, Params... params)
         {
-            return (*bit_cast<Callable*>(callable))(std::forward<Params>(params)...);
+            return (*std::bit_cast<Callable*>(callable))(std::forward<Params>(params)...);
         }
 
     public:
@@ -48,7 +50,7 @@ namespace mysh::core {
                                                                      function_view>::value>::type* /*unused*/
                                = nullptr)
             : callback(callback_fn<typename std::remove_reference<Callable>::type>)
-            , callable(bit_cast<intptr_t>(&callable))
+            , callable(std::bit_cast<intptr_t>(&callable))
         {
         }
 
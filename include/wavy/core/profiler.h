@@ -0,0 +1,95 @@
+/**
+ * @file   profiler.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.08
+ *
+ * @brief  Scoped timers for the stages of a solver with statistics per frame.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mysh::core {
+
+    /** Set by the WAVY_ENABLE_PROFILING CMake option, without it the WAVY_PROFILE_SCOPE timers are removed. */
+#ifdef WAVY_PROFILING
+    constexpr bool profiling_enabled = true;
+#else
+    constexpr bool profiling_enabled = false;
+#endif
+
+    /** The timings of one stage during a frame. */
+    struct StageStatistics
+    {
+        std::string_view name;
+        std::size_t count = 0;
+        std::chrono::nanoseconds total{};
+        std::chrono::nanoseconds min{};
+        std::chrono::nanoseconds mean{};
+        std::chrono::nanoseconds p99{};
+    };
+
+    /**
+     *  Collects the durations of named stages and reduces them to statistics at the end of every frame. A profiler
+     *  belongs to the thread that drives its solver, so recording only appends to a vector of that stage without any
+     *  synchronization, the vectors keep their capacity between frames. Solvers run by different threads, e.g. the
+     *  members of an ensemble, each have their own profiler.
+     */
+    class Profiler
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /** Measures from its construction to its destruction. */
+        class ScopedTimer
+        {
+        public:
+            ScopedTimer(Profiler& profiler, std::size_t stage) : m_profiler{&profiler}, m_stage{stage} {}
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+            ScopedTimer(ScopedTimer&&) = delete;
+            ScopedTimer& operator=(ScopedTimer&&) = delete;
+            ~ScopedTimer() { m_profiler->record(m_stage, clock::now() - m_start); }
+
+        private:
+            Profiler* m_profiler;
+            std::size_t m_stage;
+            clock::time_point m_start = clock::now();
+        };
+
+        /** The names are not copied, stage i is recorded by scope(i). */
+        explicit Profiler(std::vector<std::string_view> stage_names);
+
+        [[nodiscard]] ScopedTimer scope(std::size_t stage) { return {*this, stage}; }
+        void record(std::size_t stage, clock::duration duration) { m_samples[stage].push_back(duration); }
+
+        /** Reduces the samples since the last call to the statistics of every stage and starts a new frame. */
+        std::span<const StageStatistics> endFrame();
+        /** The statistics of the last finished frame. */
+        [[nodiscard]] std::span<const StageStatistics> lastFrame() const { return m_statistics; }
+
+    private:
+        std::vector<std::vector<clock::duration>> m_samples;
+        std::vector<StageStatistics> m_statistics;
+    };
+
+    /** Formats the stages with samples as a table, one stage per line. */
+    [[nodiscard]] std::string format_stage_statistics(std::span<const StageStatistics> statistics);
+}
+
+#define WAVY_PROFILE_CONCAT_IMPL(a, b) a##b
+#define WAVY_PROFILE_CONCAT(a, b) WAVY_PROFILE_CONCAT_IMPL(a, b)
+
+/** Times the rest of the enclosing scope as the given stage of a profiler, if profiling is enabled. */
+#ifdef WAVY_PROFILING
+#define WAVY_PROFILE_SCOPE(profiler, stage)                                                                          \
+    const auto WAVY_PROFILE_CONCAT(wavy_profile_scope_, __LINE__) = (profiler).scope(stage)
+#else
+#define WAVY_PROFILE_SCOPE(profiler, stage) static_cast<void>(0)
+#endif
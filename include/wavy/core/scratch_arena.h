@@ -0,0 +1,93 @@
+/**
+ * @file   scratch_arena.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.03
+ *
+ * @brief  Memory resource that carves the scratch fields of a solver from one aligned block.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace mysh::core {
+
+    /**
+     *  A monotonic memory resource over a single block that is allocated once at construction. Every allocation starts
+     *  at a multiple of the arena alignment (a cache line by default), so fields carved one after the other are
+     *  contiguous and never share a cache line. Requests that do not fit anymore are served by the upstream resource
+     *  and counted in overflow(), sizing the arena with footprint() avoids them.
+     *
+     *  Deallocating only reclaims memory if it was the last allocation in the block. Everything else in the block is
+     *  reclaimed by rewind() or reset(), e.g. once per frame for temporaries, which must not be in use anymore then.
+     *  Allocations served by the upstream resource are only given back when they are deallocated or the arena is
+     *  destroyed, so containers holding them stay valid across reset().
+     */
+    class ScratchArena : public std::pmr::memory_resource
+    {
+    public:
+        static constexpr std::size_t default_alignment = 64;
+        /** The position of the next allocation in the block, see mark() and rewind(). */
+        using Marker = std::size_t;
+
+        explicit ScratchArena(std::size_t capacity, std::size_t alignment = default_alignment,
+                              std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+        ScratchArena(ScratchArena&&) = delete;
+        ScratchArena& operator=(ScratchArena&&) = delete;
+        ~ScratchArena() override;
+
+        /** The bytes an allocation of the given size takes from an arena with the given alignment. */
+        [[nodiscard]] static constexpr std::size_t footprint(std::size_t bytes,
+                                                             std::size_t alignment = default_alignment)
+        {
+            return (bytes + alignment - 1) / alignment * alignment;
+        }
+        /** The bytes a field of count elements of type T takes from an arena with the given alignment. */
+        template<typename T>
+        [[nodiscard]] static constexpr std::size_t footprint(std::size_t count,
+                                                             std::size_t alignment = default_alignment)
+        {
+            return footprint(count * sizeof(T), alignment);
+        }
+
+        [[nodiscard]] Marker mark() const { return m_offset; }
+        /** Releases all allocations from the block made after the marker was taken. */
+        void rewind(Marker marker);
+        /**
+         *  Releases all allocations from the block, nothing allocated from it may be used afterwards. Allocations
+         *  served by the upstream resource are kept until their owners deallocate them.
+         */
+        void reset();
+
+        [[nodiscard]] std::size_t capacity() const { return m_capacity; }
+        [[nodiscard]] std::size_t used() const { return m_offset; }
+        /** The bytes currently allocated from the upstream resource because the block was full. */
+        [[nodiscard]] std::size_t overflow() const { return m_overflow_bytes; }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        struct Overflow
+        {
+            void* ptr;
+            std::size_t bytes;
+            std::size_t alignment;
+        };
+
+        std::pmr::memory_resource* m_upstream;
+        std::size_t m_capacity;
+        std::size_t m_alignment;
+        std::byte* m_block;
+        std::size_t m_offset = 0;
+
+        std::vector<Overflow> m_overflow;
+        std::size_t m_overflow_bytes = 0;
+    };
+}
@@ -0,0 +1,127 @@
+/**
+ * @file   thread_pool.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.01
+ *
+ * @brief  Persistent worker threads with work stealing parallel loops.
+ */
+
+#pragma once
+
+#include "core/function_view.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mysh::core {
+
+    struct ThreadPoolSettings
+    {
+        /** Threads working on a loop including the calling one, 0 uses all hardware threads. */
+        std::size_t threads = 0;
+        /** Pins worker i to the CPU first_cpu + i + 1 (modulo the hardware threads), the caller is never pinned. */
+        bool pin_threads = false;
+        std::size_t first_cpu = 0;
+    };
+
+    /**
+     *  A fixed set of worker threads that stay alive between loops. A loop is split into chunks of grain_size
+     *  indices, every thread gets a contiguous share of the chunks and idle threads steal half of the rest of
+     *  another share. The calling thread works on the loop as well and returns once all chunks are done.
+     *
+     *  Loops started from inside a loop body run inline on the calling thread. Loops started concurrently from
+     *  different threads are run one after the other.
+     *
+     *  If a loop body throws, no further chunks are started, and the first exception is rethrown to the caller of
+     *  the loop once all threads have left it. Chunks that were already running are finished.
+     */
+    class ThreadPool
+    {
+    public:
+        using RangeFunction = function_view<void(std::size_t first, std::size_t last)>;
+
+        explicit ThreadPool(const ThreadPoolSettings& settings = {});
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+        ~ThreadPool();
+
+        /** Calls fn(chunk_first, chunk_last) for chunks of at most grain_size indices covering [first, last). */
+        template<typename Fn>
+        void parallel_for(std::size_t first, std::size_t last, std::size_t grain_size, Fn&& fn)
+        {
+            run(first, last, grain_size, RangeFunction{fn});
+        }
+
+        /**
+         *  Reduces the values fn(chunk_first, chunk_last) of the chunks of [first, last) with combine, starting from
+         *  identity. The chunk values are combined in chunk order, so the result does not depend on the threads.
+         */
+        template<typename T, typename Fn, typename Combine>
+        [[nodiscard]] T parallel_reduce(std::size_t first, std::size_t last, std::size_t grain_size, T identity,
+                                        Fn&& fn, Combine&& combine)
+        {
+            if (first >= last) { return identity; }
+            grain_size = std::max(grain_size, std::size_t{1});
+            std::vector<T> chunk_values((last - first + grain_size - 1) / grain_size, identity);
+            parallel_for(first, last, grain_size,
+                         [first, grain_size, &fn, &chunk_values](std::size_t chunk_first, std::size_t chunk_last) {
+                             chunk_values[(chunk_first - first) / grain_size] = fn(chunk_first, chunk_last);
+                         });
+            for (const auto& value : chunk_values) { identity = combine(identity, value); }
+            return identity;
+        }
+
+        /** The number of threads working on a loop, including the calling one. */
+        [[nodiscard]] std::size_t thread_count() const { return m_workers.size() + 1; }
+
+        /** A pool with the default settings shared by everything that is not given its own pool. */
+        static ThreadPool& global();
+
+    private:
+        /** The chunks [begin, end) a thread has not started yet. */
+        struct alignas(64) ChunkQueue
+        {
+            std::mutex mutex;
+            std::size_t begin = 0;
+            std::size_t end = 0;
+        };
+
+        void run(std::size_t first, std::size_t last, std::size_t grain_size, RangeFunction fn);
+        void workerLoop(std::size_t worker);
+        /** Works on chunks until no thread has any left. */
+        void work(std::size_t participant);
+        /** Keeps the first exception of the loop and drops all chunks that were not started yet. */
+        void cancel(std::exception_ptr exception);
+        bool popChunk(std::size_t participant, std::size_t& chunk);
+        bool stealChunks(std::size_t participant, std::size_t& chunk);
+
+        std::vector<std::thread> m_workers;
+        std::unique_ptr<ChunkQueue[]> m_queues; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+
+        /** Serializes loops started from different threads. */
+        std::mutex m_run_mutex;
+        std::mutex m_wake_mutex;
+        std::condition_variable m_wake;
+        std::uint64_t m_generation = 0;
+        bool m_stop = false;
+
+        // the current loop, written before the workers are woken.
+        RangeFunction m_fn;
+        std::size_t m_first = 0;
+        std::size_t m_last = 0;
+        std::size_t m_grain_size = 1;
+        std::atomic<std::size_t> m_busy_workers = 0;
+        /** The first exception thrown by a body of the current loop. */
+        std::mutex m_exception_mutex;
+        std::exception_ptr m_exception;
+    };
+}
@@ -39,8 +39,8 @@ namespace mysh::core {
     template<typename T, std::size_t N>
     struct has_contiguous_memory<T[N]> : std::true_type{}; // NOLINT(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
 
-    template<typename T>
-    struct has_contiguous_memory<aligned_vector<T>> : std::true_type {};
+    template<typename T, std::size_t Alignment, typename Allocator>
+    struct has_contiguous_memory<aligned_vector<T, Alignment, Allocator>> : std::true_type {};
 
 
     template<typename T> concept contiguous_memory =
@@ -52,7 +52,8 @@ namespace mysh::core {
         return static_cast<std::size_t>(sizeof(typename T::value_type) * data.size());
     }
 
-    template<class T> std::size_t byteSizeOf(const aligned_vector<T>& data) {
+    template<class T, std::size_t Alignment, typename Allocator>
+    std::size_t byteSizeOf(const aligned_vector<T, Alignment, Allocator>& data) {
         return static_cast<std::size_t>(data.GetAlignedSize() * data.size());
     }
 }
@@ -0,0 +1,75 @@
+/**
+ * @file   ensemble.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.07
+ *
+ * @brief  Runs many independent 1d simulations, e.g. parameter sweeps, in parallel.
+ */
+
+#pragma once
+
+#include "fluid1d.h"
+
+#include <span>
+#include <vector>
+
+namespace wavy
+{
+    /** The parameters of one member of an ensemble. */
+    struct EnsembleMember
+    {
+        float delta_x = 0.0f;
+        float g = 0.0f;
+        float density = 0.0f;
+    };
+
+    /** The setup all members of an ensemble share. */
+    struct EnsembleSettings
+    {
+        std::size_t grid_size = 0;
+        /** The initial labels of every member, empty keeps all cells fluid. Only read, it is not copied per member. */
+        std::span<const CellLabel> labels;
+        solver::PressureSolverSettings pressure;
+        kernels::AdvectionSettings advection;
+        mysh::core::FirstTouchSettings memory;
+    };
+
+    /** The state of a member after the ensemble ran. */
+    struct EnsembleResult
+    {
+        float time = 0.0f;
+        std::size_t substeps = 0;
+        solver::SolverResult last_pressure_solve;
+    };
+
+    /**
+     *  Runs a FluidSolver1D per member, one member per worker of a thread pool at a time. Small grids do not scale
+     *  over the cores of a machine, so instead of splitting the stages of one solver the members run side by side:
+     *  every worker creates, runs and destroys whole solvers. Each solver, including its pressure solver, runs its
+     *  loops on the pool of the ensemble, and loops started from a loop body run inline, so a member never starts
+     *  further threads and the ensemble keeps to the thread count of its pool. The solver fields and the arena of
+     *  its pressure solver are thus first touched and used by one thread only, and only the members currently
+     *  running take memory. Members taking more substeps are balanced by work stealing.
+     */
+    class Ensemble
+    {
+    public:
+        /** Called on the worker running a member after each of its frames. */
+        using FrameObserver = mysh::core::function_view<void(std::size_t member, std::size_t frame,
+                                                             const FluidSolver1D& solver)>;
+
+        Ensemble(const EnsembleSettings& settings, std::vector<EnsembleMember> members,
+                 mysh::core::ThreadPool& pool = mysh::core::ThreadPool::global());
+
+        /** Simulates frame_count frames of delta_t_frame for every member. */
+        std::vector<EnsembleResult> run(std::size_t frame_count, float delta_t_frame, FrameObserver observer = {});
+
+        [[nodiscard]] std::size_t size() const { return m_members.size(); }
+        [[nodiscard]] const EnsembleMember& member(std::size_t index) const { return m_members[index]; }
+
+    private:
+        EnsembleSettings m_settings;
+        std::vector<EnsembleMember> m_members;
+        mysh::core::ThreadPool* m_pool;
+    };
+}
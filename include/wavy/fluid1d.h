@@ -9,39 +9,122 @@
 #pragma once
 
 #include "fluid_base.h"
+#include "core/checkpoint.h"
+#include "core/first_touch_allocator.h"
+#include "core/frame_writer.h"
 #include "core/function_view.h"
+#include "core/profiler.h"
+#include "kernels/advection.h"
+#include "solver/pressure_solver.h"
+#include "utils/field_ring.h"
+#include "utils/padded_span.h"
+#include "utils/soa_fields.h"
 
+#include <cstdint>
+#include <limits>
+#include <span>
 #include <vector>
 
 namespace wavy
 {
-    class FluidSolver1D : public FluidSolverBase
+    class FluidSolver1D : public FluidSolverBase<1>
     {
     public:
-        FluidSolver1D(std::size_t grid_size, float delta_x, float g, float density);
+        FluidSolver1D(std::size_t grid_size, float delta_x, float g, float density,
+                      const solver::PressureSolverSettings& pressure_settings = {},
+                      const kernels::AdvectionSettings& advection_settings = {},
+                      const mysh::core::FirstTouchSettings& memory_settings = {});
+        /** Restarts from a checkpoint written by checkpoint(), the settings are not part of the checkpoint. */
+        explicit FluidSolver1D(const mysh::core::MappedCheckpoint& checkpoint,
+                               const solver::PressureSolverSettings& pressure_settings = {},
+                               const kernels::AdvectionSettings& advection_settings = {},
+                               const mysh::core::FirstTouchSettings& memory_settings = {});
+
+        void setLabels(std::span<const CellLabel> labels);
 
         void solveNextStep(float delta_t_frame);
 
+        /** Returns the statistics of the last pressure solve. */
+        [[nodiscard]] const solver::SolverResult& lastPressureSolve() const { return m_pressure_result; }
+        /** Returns the number of substeps the last call of solveNextStep needed. */
+        [[nodiscard]] std::size_t lastSubsteps() const { return m_substeps; }
+        /** Returns the current face velocities. */
+        [[nodiscard]] std::span<const float> velocity() const;
+        /** Returns the simulated time. */
+        [[nodiscard]] float time() const { return tn0; }
+        /** Copies the state needed for a restart, it can be written while the solver goes on. */
+        [[nodiscard]] mysh::core::Checkpoint checkpoint() const;
+        /** Queues the labels, velocity and pressure of the current step as a frame. */
+        void writeFrame(mysh::core::FrameWriter& writer) const;
+        /** Returns the stage timings of the last frame, they are only recorded if WAVY_PROFILING is defined. */
+        [[nodiscard]] std::span<const mysh::core::StageStatistics> lastFrameProfile() const
+        {
+            return m_profiler.lastFrame();
+        }
+
     protected:
-        void advect(float delta_t, const std::vector<float>& qn0, std::vector<float>& qn1) const;
-        void bodyForces(float delta_t, const std::vector<float>& qn0, std::vector<float>& qn1) const;
-        void project(float delta_t, const std::vector<float>& qn0, std::vector<float>& qn1,
+        /** Advects qn0 through the current velocity into qn1 and adds delta_t * acceleration. Fills the ghost cells of qn0. */
+        void advect(float delta_t, utils::padded_span<float> qn0, std::span<float> qn1, float acceleration = 0.0f);
+        void bodyForces(float delta_t, std::span<const float> qn0, std::span<float> qn1) const;
+        /** Projects qn0 to a divergence free qn1, both may be the same field. */
+        void project(float delta_t, std::span<const float> qn0, std::span<float> qn1,
                      mysh::core::function_view<float(std::size_t idx)> u_solid);
 
+        void presure_gradient_rhs(std::span<const float> u, std::span<float> rhs, mysh::core::function_view<float(std::size_t idx)> u_solid) const;
+        void setup_A(float delta_t);
+        /** The matrix assembled by the last projection or setup_A, it is reused while the labels and delta_t match. */
+        [[nodiscard]] solver::PoissonStencil<1> pressureMatrix() const;
+        /** The rhs assembled by the last projection. */
+        [[nodiscard]] std::span<const float> pressureRhs() const;
+        void pressure_update(float delta_t, std::span<const float> qn0, std::span<float> qn1,
+                             mysh::core::function_view<float(std::size_t idx)> u_solid) const;
+
     private:
+        using Field = mysh::core::first_touch_vector<float>;
+        struct Pressure {};
+        struct Rhs {};
+        struct ADiag {};
+        struct AX {};
+        /** The cell fields, each pressure solve streams over all of them. */
+        using CellFields = utils::basic_soa_fields<mysh::core::first_touch_allocator<std::byte>,
+                                                   utils::field_channel<Pressure>, utils::field_channel<Rhs>,
+                                                   utils::field_channel<ADiag>, utils::field_channel<AX>>;
+        static constexpr std::uint64_t no_generation = std::numeric_limits<std::uint64_t>::max();
+
+        /** The parameters of the solver stored in checkpoints. */
+        struct CheckpointParameters
+        {
+            std::uint64_t grid_size = 0;
+            float delta_x = 0.0f;
+            float g = 0.0f;
+            float density = 0.0f;
+            float time = 0.0f;
+
+            template<typename Archive>
+            void serialize(Archive& archive, [[maybe_unused]] std::uint32_t version)
+            {
+                archive(grid_size, delta_x, g, density, time);
+            }
+        };
+
+        FluidSolver1D(const CheckpointParameters& parameters, const mysh::core::MappedCheckpoint& checkpoint,
+                      const solver::PressureSolverSettings& pressure_settings,
+                      const kernels::AdvectionSettings& advection_settings,
+                      const mysh::core::FirstTouchSettings& memory_settings);
+        [[nodiscard]] static CheckpointParameters checkpointParameters(const mysh::core::MappedCheckpoint& checkpoint);
+
+        /** Assembles the rhs and/or the matrix in a single pass over the cells. */
+        template<bool with_rhs, bool with_A>
+        void assemble(float delta_t, std::span<const float> u, std::span<float> rhs, std::span<float> A_diag,
+                      std::span<float> A_x, mysh::core::function_view<float(std::size_t idx)> u_solid) const;
+
         [[nodiscard]] float estimateAdvectionDeltaT() const;
         [[nodiscard]] float estimateBodyForcesDeltaT() const;
         [[nodiscard]] float estimateProjectDeltaT() const;
 
-        void presure_gradient_rhs(const std::vector<float>& u, std::vector<float>& rhs, mysh::core::function_view<float(std::size_t idx)> u_solid) const;
-        void setup_A(float delta_t);
-
         [[nodiscard]] float toPosition(std::size_t index) const;
         [[nodiscard]] std::size_t toGrid(float position) const;
 
-        [[nodiscard]] float interpolate(const utils::boundary_span<const float>& q, float x_P) const;
-        [[nodiscard]] float integrate(const utils::boundary_span<const float>& f, float q, float delta_t) const;
-
          // NOLINTBEGIN(cppcoreguidelines-avoid-const-or-ref-data-members)
         const float m_delta_x;
         const float m_g;
@@ -49,16 +132,25 @@ namespace wavy
         // NOLINTEND(cppcoreguidelines-avoid-const-or-ref-data-members)
 
         float tn0 = 0.0f;
+        std::size_t m_substeps = 0;
         std::vector<float> m_position;
 
-        std::vector<float> m_p;
-        std::vector<float> m_u_n0;
-        std::vector<float> m_u_A;
-        std::vector<float> m_u_B;
-        std::vector<float> m_u_n1;
+        /** The fields the stages work on are first written by the threads of the stages, see FirstTouchSettings. */
+        CellFields m_cells;
+        /** Face velocities of the current and next step, stored with ghost cells for the advection. */
+        utils::field_ring<float, 2, Field::allocator_type> m_u;
+        kernels::SemiLagrangianAdvection m_advection;
+
+        /** The label generation and time step the matrix was assembled for, it is reused while both match. */
+        std::uint64_t m_A_generation = no_generation;
+        float m_A_delta_t = 0.0f;
+
+        /** Holds all vectors of the pressure solver in one block. */
+        mysh::core::ScratchArena m_scratch;
+        solver::PressureSolver1D m_pressure_solver;
+        solver::SolverResult m_pressure_result;
 
-        std::vector<float> m_rhs;
-        std::vector<float> m_A_diag;
-        std::vector<float> m_A_x;
+        /** Times the stages, the const stages record as well. */
+        mutable mysh::core::Profiler m_profiler;
     };
 }
@@ -0,0 +1,32 @@
+/**
+ * @file   fluid2d.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.28
+ *
+ * @brief  Fluid solver for 2d fluids on a staggered (MAC) grid.
+ */
+
+#pragma once
+
+#include "mac_solver.h"
+
+namespace wavy
+{
+    /**
+     *  The x velocities u live at the centers of the vertical faces and the y velocities v at the centers of the
+     *  horizontal faces. Face (i, j) of u lies between the cells (i - 1, j) and (i, j), face (i, j) of v between
+     *  (i, j - 1) and (i, j). All stages run in parallel over tiles of rows.
+     */
+    class FluidSolver2D : public MacFluidSolver<2, TiledIteration<2>>
+    {
+    public:
+        FluidSolver2D(std::size_t size_x, std::size_t size_y, float delta_x, float g, float density,
+                      const solver::PCGSettings& pressure_settings = {},
+                      const kernels::AdvectionSettings& advection_settings = {});
+
+        /** Returns the current x velocities, (size_x + 1) * size_y faces with x running fastest. */
+        [[nodiscard]] std::span<const float> velocityX() const { return velocity(0); }
+        /** Returns the current y velocities, size_x * (size_y + 1) faces with x running fastest. */
+        [[nodiscard]] std::span<const float> velocityY() const { return velocity(1); }
+    };
+}
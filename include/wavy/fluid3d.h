@@ -0,0 +1,50 @@
+/**
+ * @file   fluid3d.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.29
+ *
+ * @brief  Fluid solver for 3d fluids on a staggered (MAC) grid.
+ */
+
+#pragma once
+
+#include "mac_solver.h"
+
+namespace wavy
+{
+    /**
+     *  All stages iterate over bricks of 8x8x8 cells or faces. Only bricks that contain a fluid cell (or, for the
+     *  faces, border one) are visited, so domains that are mostly solid or empty cost little more than their fluid.
+     *  The active bricks are recomputed whenever the labels change. Faces without a fluid cell on either side stay at
+     *  rest, so skipping a brick gives the same result as visiting it.
+     */
+    class FluidSolver3D : public MacFluidSolver<3, ActiveBricks<3>>
+    {
+    public:
+        FluidSolver3D(std::size_t size_x, std::size_t size_y, std::size_t size_z, float delta_x, float g,
+                      float density, const solver::PCGSettings& pressure_settings = {},
+                      const kernels::AdvectionSettings& advection_settings = {});
+
+        /**
+         *  Replaces the labels of all cells (x running fastest) and updates the active bricks. Velocities and pressures
+         *  in bricks that become inactive are set to zero, those in bricks that stay active are kept.
+         */
+        void setLabels(std::span<const CellLabel> labels);
+
+        /** Returns the number of cell bricks that contain fluid. */
+        [[nodiscard]] std::size_t activeBricks() const { return iteration().cells().active.size(); }
+
+    protected:
+        using BrickSet = ActiveBricks<3>::BrickSet;
+
+        /** Recomputes the active bricks and clears everything the stages no longer visit. */
+        void updateActiveBricks();
+        /** The bricks of the cells and of the faces of component dim, kept up to date by updateActiveBricks. */
+        [[nodiscard]] BrickSet& cellBricks() { return iteration().cells(); }
+        [[nodiscard]] BrickSet& faceBricks(std::size_t dim) { return iteration().faces(dim); }
+
+    private:
+        /** Returns whether a cell of the box, grown by one cell towards -e_dim, is fluid (dim = 3 grows nothing). */
+        [[nodiscard]] bool containsFluid(utils::grid_box<3> box, std::size_t dim) const;
+    };
+}
@@ -3,59 +3,311 @@
  * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
  * @date   2023.10.06
  *
- * @brief  Fluid solver base class.
+ * @brief  Fluid solver base class for grids of any dimension.
  */
 
 #pragma once
 
+#include "app_constants.h"
+#include "cell_label.h"
+#include "core/thread_pool.h"
+#include "packed_labels.h"
 #include "utils/boundary_span.h"
+#include "utils/grid_layout.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <vector>
 
 namespace wavy
 {
+    /** A sampled scalar field that can be read at (possibly out of range) indices, e.g. a boundary or padded span. */
+    template<typename Field>
+    concept sampled_field = requires(const Field& q, std::size_t idx) {
+        { q[idx] } -> std::convertible_to<float>;
+        { q.size() } -> std::convertible_to<std::size_t>;
+    };
+
+    namespace detail
+    {
+        // some constants used for Runge Kutta integration.
+        constexpr float one_sixth = 1.0f / 6.0f;
+        constexpr float one_nineth = 1.0f / 9.0f;
+        constexpr float three_fourth = 0.75f;
+    }
+
+    /** A substep of a frame, last is set for the step that reaches the end of the frame. */
+    struct Substep
+    {
+        float delta_t = 0.0f;
+        bool last = false;
+    };
+
+    /**
+     *  Returns the substep starting at time t of a frame for the largest stable step delta_t_max. A full step that
+     *  would leave less than another full step splits the rest of the frame in two equal steps, so no step gets tiny.
+     *  Without a positive finite limit (a fluid at rest without gravity or a diverged state), or if the limit is too
+     *  small to advance t, the rest of the frame is taken as one step, so every frame ends.
+     */
+    [[nodiscard]] Substep next_substep(float t, float delta_t_max, float delta_t_frame);
+
+    /**
+     *  Common parts of the fluid solvers on D dimensional grids: the cell labels, the grid layout and the
+     *  semi-Lagrangian sampling and back tracing. The one dimensional helpers take a single sampled field, the grid
+     *  ones work on dense fields in the layout of a grid and sample them with clamped indices.
+     */
+    template<std::size_t D>
     class FluidSolverBase
     {
     public:
+        /** Runs the stages on the given pool instead of the global one, e.g. to give each solver its own cores. */
+        void setThreadPool(mysh::core::ThreadPool& pool) { m_thread_pool = &pool; }
 
     protected:
-        enum class Label : std::uint8_t
-        {
-            FLUID,
-            SOLID,
-            EMPTY
-        };
+        using Label = CellLabel;
+        using LabelSpan = utils::boundary_span<Label, utils::boundary::constant<Label>>;
+        using Layout = utils::grid_layout<D>;
+        using Cell = typename Layout::index_type;
+        using CellOffset = typename Layout::offset_type;
+        /** A position in (possibly fractional) grid coordinates. */
+        using GridPosition = std::array<float, D>;
 
-        struct LabeledCellIndex
-        {
-            std::size_t index : 24;
-            Label label;
-            LabeledCellIndex& operator++()
-            {
-                index += 1;
-                return *this;
-            }
-        };
+        FluidSolverBase(const Cell& grid_size, Label boundary_label);
+
+        template<sampled_field Field>
+        [[nodiscard]] static float InterpolateLinear(const Field& q, float s, std::size_t xi);
+        template<sampled_field Field>
+        [[nodiscard]] static float InterpolateCubic(const Field& q, float s, std::size_t xi);
+        template<InterpolationMethod interpolation = interpolation_method, sampled_field Field>
+        [[nodiscard]] static float Interpolate(const Field& q, float x_P, float delta_x);
 
-        FluidSolverBase(
-            std::size_t grid_size,
-            const std::function<Label(const std::span<Label>&, std::size_t)>& labels_handler);
+        template<InterpolationMethod interpolation = interpolation_method, sampled_field Field>
+        [[nodiscard]] static float IntegrateRG2(const Field& f, float q, float delta_t, float delta_x);
+        template<InterpolationMethod interpolation = interpolation_method, sampled_field Field>
+        [[nodiscard]] static float IntegrateRG3(const Field& f, float q, float delta_t, float delta_x);
+        template<InterpolationMethod interpolation = interpolation_method, sampled_field Field>
+        [[nodiscard]] static float IntegrateRG4(const Field& f, float q, float delta_t, float delta_x);
+        template<IntegrationMethod integration = integration_method,
+                 InterpolationMethod interpolation = interpolation_method, sampled_field Field>
+        [[nodiscard]] static float Integrate(const Field& f, float q, float delta_t, float delta_x);
+
+        /** Weights of the cubic stencil at xi - 1, ..., xi + 2 for the fraction s. */
+        [[nodiscard]] static std::array<float, 4> CubicWeights(float s);
+        /** Samples a field in the given layout at grid coordinates x, clamped to the grid (bilinear/bicubic in 2d). */
+        template<InterpolationMethod interpolation = interpolation_method>
+        [[nodiscard]] static float SampleGrid(std::span<const float> q, const Layout& layout, const GridPosition& x);
+        /** Traces x back through the velocity u(x) (in grid units per time) by step = delta_t / delta_x. */
+        template<IntegrationMethod integration = integration_method, typename Velocity>
+        [[nodiscard]] static GridPosition TraceBack(const Velocity& u, const GridPosition& x, float step);
+
+        /** Returns the coordinates of the cell delta cells away from cell in dimension dim. */
+        [[nodiscard]] static CellOffset Neighbor(const Cell& cell, std::size_t dim, std::ptrdiff_t delta)
+        {
+            CellOffset result{};
+            for (std::size_t d = 0; d < D; ++d) { result[d] = static_cast<std::ptrdiff_t>(cell[d]); }
+            result[dim] += delta;
+            return result;
+        }
 
-        [[nodiscard]] static float InterpolateLinear(const utils::boundary_span<const float>& q, float s, std::size_t xi);
-        [[nodiscard]] static float InterpolateCubic(const utils::boundary_span<const float>& q, float s, std::size_t xi);
-        [[nodiscard]] static float Interpolate(const utils::boundary_span<const float>& q, float x_P, float delta_x);
+        [[nodiscard]] mysh::core::ThreadPool& threadPool() const { return *m_thread_pool; }
+        [[nodiscard]] const Layout& grid() const { return m_grid; }
+        /** Returns the label of a cell, cells outside the grid have the boundary label. */
+        [[nodiscard]] Label label(const CellOffset& cell) const
+        {
+            if (!m_grid.contains(cell)) [[unlikely]] { return boundaryLabel(); }
+            std::size_t index = 0;
+            for (std::size_t d = 0; d < D; ++d) { index += static_cast<std::size_t>(cell[d]) * m_grid.stride(d); }
+            return m_labels_data[index];
+        }
 
-        [[nodiscard]] static float IntegrateRG2(const utils::boundary_span<const float>& f, float q, float delta_t, float delta_x);
-        [[nodiscard]] static float IntegrateRG3(const utils::boundary_span<const float>& f, float q, float delta_t, float delta_x);
-        [[nodiscard]] static float IntegrateRG4(const utils::boundary_span<const float>& f, float q, float delta_t, float delta_x);
-        [[nodiscard]] static float Integrate(const utils::boundary_span<const float>& f, float q, float delta_t, float delta_x);
+        /** Returns the label of all cells outside the grid. */
+        [[nodiscard]] Label boundaryLabel() const { return m_labels.get_policy().value; }
 
         [[nodiscard]] const std::vector<Label>& labels_data() const { return m_labels_data; }
         [[nodiscard]] std::vector<Label>& labels_data() { return m_labels_data; }
-        [[nodiscard]] const utils::boundary_span<Label>& labels() const { return m_labels; }
-        [[nodiscard]] utils::boundary_span<Label>& labels() { return m_labels; }
+        /** The labels as a flat span, neighbors of an index are only the neighboring cells in 1d. */
+        [[nodiscard]] const LabelSpan& labels() const requires(D == 1) { return m_labels; }
+        [[nodiscard]] LabelSpan& labels() requires(D == 1) { return m_labels; }
+        /** The labels with two bits per cell, for word parallel tests in the stencils. */
+        [[nodiscard]] const PackedLabels& packed_labels() const { return m_packed_labels; }
+        /** Incremented whenever the labels change, so stages can cache data derived from them. */
+        [[nodiscard]] std::uint64_t labelGeneration() const { return m_label_generation; }
+        /** Has to be called after the labels were changed through labels_data(). */
+        void labelsChanged()
+        {
+            m_packed_labels.assign(m_labels_data);
+            m_label_generation += 1;
+        }
 
     private:
+        mysh::core::ThreadPool* m_thread_pool = &mysh::core::ThreadPool::global();
+        Layout m_grid;
         std::vector<Label> m_labels_data;
-        utils::boundary_span<Label> m_labels;
+        LabelSpan m_labels;
+        PackedLabels m_packed_labels;
+        std::uint64_t m_label_generation = 0;
 
     };
+
+    extern template class FluidSolverBase<1>;
+    extern template class FluidSolverBase<2>;
+    extern template class FluidSolverBase<3>;
+
+    template<std::size_t D>
+    template<sampled_field Field>
+    float FluidSolverBase<D>::InterpolateLinear(const Field& q, float s, std::size_t xi) // NOLINT(bugprone-easily-swappable-parameters)
+    {
+        return glm::mix(static_cast<float>(q[xi]), static_cast<float>(q[xi + 1]), s);
+    }
+
+    template<std::size_t D>
+    template<sampled_field Field>
+    float FluidSolverBase<D>::InterpolateCubic(const Field& q, float s, std::size_t xi) // NOLINT(bugprone-easily-swappable-parameters)
+    {
+        auto [w_1, w0, w1, w2] = CubicWeights(s);
+        return w_1 * q[xi - 1] + w0 * q[xi] + w1 * q[xi + 1] + w2 * q[xi + 2];
+    }
+
+    template<std::size_t D>
+    template<InterpolationMethod interpolation, sampled_field Field>
+    float FluidSolverBase<D>::Interpolate(const Field& q, float x_P, float delta_x)
+    {
+        auto x = x_P / delta_x;
+        // padded fields only hold a few ghost cells, so positions are projected onto the sampled domain which
+        // matches a clamped boundary.
+        if constexpr (requires { q.ghost_cells(); }) {
+            x = glm::clamp(x, 0.0f, static_cast<float>(q.size() - 1));
+        }
+        auto xi_f = glm::floor(x);
+        // going through a signed index lets positions left of the domain wrap around to "negative" indices.
+        auto xi = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(xi_f));
+        auto alpha = x - xi_f;
+        if constexpr (interpolation == InterpolationMethod::Linear) { return InterpolateLinear(q, alpha, xi); }
+        if constexpr (interpolation == InterpolationMethod::Cubic) { return InterpolateCubic(q, alpha, xi); }
+    }
+
+    template<std::size_t D>
+    template<InterpolationMethod interpolation, sampled_field Field>
+    float FluidSolverBase<D>::IntegrateRG2(const Field& f, float q, float delta_t, float delta_x)
+    {
+        auto qMid = q - 0.5f * delta_t * Interpolate<interpolation>(f, q, delta_x);
+        return q - delta_t * Interpolate<interpolation>(f, qMid, delta_x);
+    }
+
+    template<std::size_t D>
+    template<InterpolationMethod interpolation, sampled_field Field>
+    float FluidSolverBase<D>::IntegrateRG3(const Field& f, float q, float delta_t, float delta_x)
+    {
+        auto k1 = Interpolate<interpolation>(f, q, delta_x);
+        auto k2 = Interpolate<interpolation>(f, q - 0.5f * delta_t * k1, delta_x);
+        auto k3 = Interpolate<interpolation>(f, q - detail::three_fourth * delta_t * k2, delta_x);
+        return q - (delta_t * detail::one_nineth) * (2.0f * k1 + 3.0f * k2 + 4.0f * k3);
+    }
+
+    template<std::size_t D>
+    template<InterpolationMethod interpolation, sampled_field Field>
+    float FluidSolverBase<D>::IntegrateRG4(const Field& f, float q, float delta_t, float delta_x)
+    {
+        auto k1 = Interpolate<interpolation>(f, q, delta_x);
+        auto k2 = Interpolate<interpolation>(f, q - 0.5f * delta_t * k1, delta_x);
+        auto k3 = Interpolate<interpolation>(f, q - 0.5f * delta_t * k2, delta_x);
+        auto k4 = Interpolate<interpolation>(f, q - delta_t * k3, delta_x);
+        return q - (delta_t * detail::one_sixth) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+    }
+
+    template<std::size_t D>
+    template<IntegrationMethod integration, InterpolationMethod interpolation, sampled_field Field>
+    float FluidSolverBase<D>::Integrate(const Field& f, float q, float delta_t, float delta_x)
+    {
+        using enum IntegrationMethod;
+        if constexpr (integration == RK2) { return IntegrateRG2<interpolation>(f, q, delta_t, delta_x); }
+        if constexpr (integration == RK3) { return IntegrateRG3<interpolation>(f, q, delta_t, delta_x); }
+        if constexpr (integration == RK4) { return IntegrateRG4<interpolation>(f, q, delta_t, delta_x); }
+    }
+
+    template<std::size_t D>
+    std::array<float, 4> FluidSolverBase<D>::CubicWeights(float s)
+    {
+        auto s2 = s * s;
+        auto s3 = s2 * s;
+        return {(-1.0f / 3.0f) * s + 0.5f * s2 - (detail::one_sixth)*s3, 1.0f - s2 + 0.5f * (s3 - s),
+                s + 0.5f * (s2 - s3), detail::one_sixth * (s3 - s)};
+    }
+
+    template<std::size_t D>
+    template<InterpolationMethod interpolation>
+    float FluidSolverBase<D>::SampleGrid(std::span<const float> q, const Layout& layout, const GridPosition& x)
+    {
+        // tensor product of the 1d stencils, the taps of each dimension are clamped to the grid.
+        constexpr std::size_t taps = interpolation == InterpolationMethod::Linear ? 2 : 4;
+        constexpr std::ptrdiff_t first_tap = interpolation == InterpolationMethod::Linear ? 0 : -1;
+        std::array<std::array<float, taps>, D> weights{};
+        std::array<std::array<std::size_t, taps>, D> offsets{};
+        std::size_t tap_count = 1;
+        for (std::size_t d = 0; d < D; ++d) {
+            auto max_index = static_cast<std::ptrdiff_t>(layout.size(d)) - 1;
+            auto xd = glm::clamp(x[d], 0.0f, static_cast<float>(max_index));
+            auto xi_f = glm::floor(xd);
+            auto s = xd - xi_f;
+            if constexpr (interpolation == InterpolationMethod::Linear) {
+                weights[d] = {1.0f - s, s};
+            } else {
+                weights[d] = CubicWeights(s);
+            }
+            auto xi = static_cast<std::ptrdiff_t>(xi_f);
+            for (std::size_t t = 0; t < taps; ++t) {
+                auto index = std::clamp(xi + first_tap + static_cast<std::ptrdiff_t>(t), std::ptrdiff_t{0}, max_index);
+                offsets[d][t] = static_cast<std::size_t>(index) * layout.stride(d);
+            }
+            tap_count *= taps;
+        }
+
+        float result = 0.0f;
+        for (std::size_t k = 0; k < tap_count; ++k) {
+            float weight = 1.0f;
+            std::size_t index = 0;
+            for (std::size_t d = 0, rest = k; d < D; ++d, rest /= taps) {
+                weight *= weights[d][rest % taps];
+                index += offsets[d][rest % taps];
+            }
+            result += weight * q[index];
+        }
+        return result;
+    }
+
+    template<std::size_t D>
+    template<IntegrationMethod integration, typename Velocity>
+    auto FluidSolverBase<D>::TraceBack(const Velocity& u, const GridPosition& x, float step) -> GridPosition
+    {
+        // returns x - a * k.
+        auto back = [&x](float a, const GridPosition& k) {
+            GridPosition result{};
+            for (std::size_t d = 0; d < D; ++d) { result[d] = x[d] - a * k[d]; }
+            return result;
+        };
+
+        using enum IntegrationMethod;
+        if constexpr (integration == RK2) {
+            return back(step, u(back(0.5f * step, u(x))));
+        } else if constexpr (integration == RK3) {
+            auto k1 = u(x);
+            auto k2 = u(back(0.5f * step, k1));
+            auto k3 = u(back(detail::three_fourth * step, k2));
+            GridPosition k{};
+            for (std::size_t d = 0; d < D; ++d) { k[d] = 2.0f * k1[d] + 3.0f * k2[d] + 4.0f * k3[d]; }
+            return back(step * detail::one_nineth, k);
+        } else {
+            auto k1 = u(x);
+            auto k2 = u(back(0.5f * step, k1));
+            auto k3 = u(back(0.5f * step, k2));
+            auto k4 = u(back(step, k3));
+            GridPosition k{};
+            for (std::size_t d = 0; d < D; ++d) { k[d] = k1[d] + 2.0f * k2[d] + 2.0f * k3[d] + k4[d]; }
+            return back(step * detail::one_sixth, k);
+        }
+    }
 }
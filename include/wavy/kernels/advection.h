@@ -0,0 +1,70 @@
+/**
+ * @file   advection.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.25
+ *
+ * @brief  Batched semi-Lagrangian advection kernels.
+ */
+
+#pragma once
+
+#include "app_constants.h"
+#include "core/cpu_features.h"
+
+#include <cstdint>
+
+namespace wavy::kernels
+{
+    /**
+     *  The fields read by the advection kernels. Both pointers point to element 0 of padded storage with at least
+     *  two ghost cells on each side (see utils::padded_span). The kernels only get plain data and call no inline
+     *  functions of other headers, so everything the vector translation units instantiate has internal linkage and
+     *  the linker never picks a copy built for a wider instruction set.
+     */
+    struct AdvectionFields
+    {
+        const float* velocity = nullptr;
+        std::size_t velocity_size = 0;
+        const float* quantity = nullptr;
+        std::size_t quantity_size = 0;
+        float delta_x = 1.0f;
+        float delta_t = 0.0f;
+        /** Added to every advected value, e.g. gravity times delta_t, so body forces need no pass of their own. */
+        float source = 0.0f;
+    };
+
+    /** The interpolation and integration schemes used for advection, defaulting to the compile time constants. */
+    struct AdvectionSettings
+    {
+        InterpolationMethod interpolation = interpolation_method;
+        IntegrationMethod integration = integration_method;
+    };
+
+    /**
+     *  Advects the quantity to the grid positions first, ..., first + count - 1 by tracing them back through the
+     *  velocity field. Batches of 8 (AVX2) or 16 (AVX-512) positions go through the vector kernel, the rest through
+     *  the scalar one. Positions that leave the domain are clamped to it. The kernels are fully specialized for every
+     *  scheme combination, the combination is selected once at construction.
+     */
+    class SemiLagrangianAdvection
+    {
+    public:
+        using BatchKernel = std::size_t (*)(const AdvectionFields& fields, std::size_t first, std::size_t count,
+                                            float* result);
+
+        /** Uses the widest kernel that is compiled in and supported by the CPU, but at most the requested level. */
+        explicit SemiLagrangianAdvection(const AdvectionSettings& settings = {},
+                                         mysh::core::SimdLevel max_level = mysh::core::simd_level());
+
+        void operator()(const AdvectionFields& fields, std::size_t first, std::size_t count, float* result) const;
+
+        [[nodiscard]] mysh::core::SimdLevel level() const { return m_level; }
+        [[nodiscard]] const AdvectionSettings& settings() const { return m_settings; }
+
+    private:
+        AdvectionSettings m_settings;
+        mysh::core::SimdLevel m_level;
+        BatchKernel m_batch_kernel;
+        BatchKernel m_scalar_kernel;
+    };
+}
@@ -0,0 +1,241 @@
+/**
+ * @file   mac_solver.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.10
+ *
+ * @brief  The stages of the fluid solvers on staggered (MAC) grids, shared by the 2d and 3d solver.
+ */
+
+#pragma once
+
+#include "fluid_base.h"
+#include "kernels/advection.h"
+#include "solver/pcg.h"
+#include "utils/field_ring.h"
+#include "utils/grid_layout.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace wavy
+{
+    /** Visits all cells or faces of a grid, one tile per task. */
+    template<std::size_t D>
+    class TiledIteration
+    {
+    public:
+        using Layout = utils::grid_layout<D>;
+        using Extent = typename Layout::index_type;
+
+        TiledIteration(const Layout& cells, const std::array<Layout, D>& faces, const Extent& tile_extent)
+            : m_cells{cells, tile_extent}
+            , m_faces{[&faces, &tile_extent]<std::size_t... I>(std::index_sequence<I...>) {
+                return std::array<utils::tile_grid<D>, D>{utils::tile_grid<D>{faces[I], tile_extent}...};
+            }(std::make_index_sequence<D>{})}
+        {
+        }
+
+        /** Runs fn(cell) for all cells in parallel. */
+        template<typename Fn>
+        void forEachCell(mysh::core::ThreadPool& pool, Fn fn) const { forEach(pool, m_cells, fn); }
+        /** Runs fn(face) for all faces of component dim in parallel. */
+        template<typename Fn>
+        void forEachFace(mysh::core::ThreadPool& pool, std::size_t dim, Fn fn) const
+        {
+            forEach(pool, m_faces[dim], fn);
+        }
+
+    private:
+        template<typename Fn>
+        static void forEach(mysh::core::ThreadPool& pool, const utils::tile_grid<D>& tiles, Fn& fn)
+        {
+            pool.parallel_for(0, tiles.size(), 1, [&tiles, &fn](std::size_t first, std::size_t last) {
+                for (auto tile = first; tile < last; ++tile) { utils::for_each_cell(tiles.tile(tile), fn); }
+            });
+        }
+
+        utils::tile_grid<D> m_cells;
+        std::array<utils::tile_grid<D>, D> m_faces;
+    };
+
+    /**
+     *  Visits only the active bricks of the cells or faces, one brick per task. No brick is active until the owner
+     *  fills the active lists, it also has to clear whatever lies in the bricks it deactivates.
+     */
+    template<std::size_t D>
+    class ActiveBricks
+    {
+    public:
+        using Layout = utils::grid_layout<D>;
+        using Extent = typename Layout::index_type;
+
+        /** A brick tiling together with the indices of the bricks the stages visit. */
+        struct BrickSet
+        {
+            utils::tile_grid<D> bricks;
+            std::vector<std::size_t> active;
+        };
+
+        ActiveBricks(const Layout& cells, const std::array<Layout, D>& faces, const Extent& brick_extent)
+            : m_cells{{cells, brick_extent}, {}}
+            , m_faces{[&faces, &brick_extent]<std::size_t... I>(std::index_sequence<I...>) {
+                return std::array<BrickSet, D>{BrickSet{{faces[I], brick_extent}, {}}...};
+            }(std::make_index_sequence<D>{})}
+        {
+        }
+
+        /** Runs fn(cell) for all cells of the active bricks in parallel. */
+        template<typename Fn>
+        void forEachCell(mysh::core::ThreadPool& pool, Fn fn) const { forEach(pool, m_cells, fn); }
+        /** Runs fn(face) for all faces of component dim in the active bricks in parallel. */
+        template<typename Fn>
+        void forEachFace(mysh::core::ThreadPool& pool, std::size_t dim, Fn fn) const
+        {
+            forEach(pool, m_faces[dim], fn);
+        }
+
+        [[nodiscard]] BrickSet& cells() { return m_cells; }
+        [[nodiscard]] const BrickSet& cells() const { return m_cells; }
+        [[nodiscard]] BrickSet& faces(std::size_t dim) { return m_faces[dim]; }
+
+    private:
+        template<typename Fn>
+        static void forEach(mysh::core::ThreadPool& pool, const BrickSet& set, Fn& fn)
+        {
+            pool.parallel_for(0, set.active.size(), 1, [&set, &fn](std::size_t first, std::size_t last) {
+                for (auto i = first; i < last; ++i) { utils::for_each_cell(set.bricks.tile(set.active[i]), fn); }
+            });
+        }
+
+        BrickSet m_cells;
+        std::array<BrickSet, D> m_faces;
+    };
+
+    /**
+     *  Pressures live at the cell centers, velocity component d at the centers of the faces orthogonal to axis d.
+     *  Face f of component d lies between the cells f - e_d and f. Gravity acts along y, the domain is closed by
+     *  solid walls at rest. Faces without a fluid cell on either side are never projected, they stay at rest instead
+     *  of accumulating gravity.
+     *
+     *  Every stage visits the cells and faces through the Iteration policy (TiledIteration or ActiveBricks), which
+     *  is the only thing the 2d and 3d solver do differently.
+     */
+    template<std::size_t D, typename Iteration>
+    class MacFluidSolver : public FluidSolverBase<D>
+    {
+        using Base = FluidSolverBase<D>;
+
+    public:
+        /** Replaces the labels of all cells, x running fastest. */
+        void setLabels(std::span<const CellLabel> labels);
+
+        void solveNextStep(float delta_t_frame);
+
+        /** Returns the statistics of the last pressure solve. */
+        [[nodiscard]] const solver::SolverResult& lastPressureSolve() const { return m_pressure_result; }
+        /** Returns the number of substeps the last call of solveNextStep needed. */
+        [[nodiscard]] std::size_t lastSubsteps() const { return m_substeps; }
+        /** Returns the current face velocities of component dim, x running fastest. */
+        [[nodiscard]] std::span<const float> velocity(std::size_t dim) const { return m_velocity[dim].current(); }
+        /** Returns the pressure of the last projection. */
+        [[nodiscard]] std::span<const float> pressure() const { return m_p; }
+        /** Returns the simulated time. */
+        [[nodiscard]] float time() const { return tn0; }
+
+    protected:
+        using typename Base::Label;
+        using typename Base::Layout;
+        using typename Base::Cell;
+        using typename Base::CellOffset;
+        using typename Base::GridPosition;
+        using VelocityBuffers = std::array<std::span<float>, D>;
+        using VelocityView = std::array<std::span<const float>, D>;
+        using Base::grid;
+        using Base::label;
+        using Base::labelGeneration;
+        using Base::labelsChanged;
+        using Base::labels_data;
+        using Base::Neighbor;
+        using Base::threadPool;
+
+        MacFluidSolver(const Cell& grid_size, float delta_x, float g, float density,
+                       const solver::PCGSettings& pressure_settings,
+                       const kernels::AdvectionSettings& advection_settings, const Cell& tile_extent);
+
+        /** Advects the current velocity into the next buffers and adds delta_t * acceleration to the y velocities. */
+        void advect(float delta_t, float acceleration = 0.0f);
+        void bodyForces(float delta_t, std::span<const float> vn0, std::span<float> vn1) const;
+        /** Makes the velocity divergence free in place. */
+        void project(float delta_t, const VelocityBuffers& velocity);
+
+        void presure_gradient_rhs(const VelocityView& velocity, std::span<float> rhs) const;
+        void setup_A(float delta_t);
+        /** The matrix assembled by the last projection or setup_A, it is reused while the labels and delta_t match. */
+        [[nodiscard]] solver::PoissonStencil<D> pressureMatrix() const;
+        /** The rhs assembled by the last projection. */
+        [[nodiscard]] std::span<const float> pressureRhs() const;
+        void pressure_update(float delta_t, const VelocityBuffers& velocity) const;
+
+        [[nodiscard]] Iteration& iteration() { return m_iteration; }
+        [[nodiscard]] const Iteration& iteration() const { return m_iteration; }
+        [[nodiscard]] const Layout& faceLayout(std::size_t dim) const { return m_face_layouts[dim]; }
+        /** The pressure, the rhs, the diagonal and the couplings of the matrix, all laid out like the cells. */
+        [[nodiscard]] std::array<std::span<float>, D + 3> cellFields();
+        /** Both buffers of the velocity component dim. */
+        [[nodiscard]] std::array<std::span<float>, 2> faceFields(std::size_t dim);
+
+    private:
+        using AdvectionKernel = void (MacFluidSolver::*)(float delta_t, float acceleration);
+        static constexpr std::uint64_t no_generation = std::numeric_limits<std::uint64_t>::max();
+
+        /** Assembles the rhs and/or the matrix (diagonal and the coupling per dimension) in one pass over the cells. */
+        template<bool with_rhs, bool with_A>
+        void assemble(float delta_t, const VelocityView& velocity, std::span<float> rhs,
+                      const std::array<std::span<float>, D + 1>& A) const;
+
+        template<InterpolationMethod interpolation, IntegrationMethod integration>
+        void advectWith(float delta_t, float acceleration);
+        [[nodiscard]] static AdvectionKernel selectAdvection(const kernels::AdvectionSettings& settings);
+        /** Returns whether one of the cells next to face of component dim is fluid. */
+        [[nodiscard]] bool bordersFluid(const Cell& face, std::size_t dim) const;
+
+        [[nodiscard]] float estimateAdvectionDeltaT() const;
+        [[nodiscard]] float estimateBodyForcesDeltaT() const;
+        [[nodiscard]] float estimateProjectDeltaT() const;
+
+        // NOLINTBEGIN(cppcoreguidelines-avoid-const-or-ref-data-members)
+        const float m_delta_x;
+        const float m_g;
+        const float m_density;
+        // NOLINTEND(cppcoreguidelines-avoid-const-or-ref-data-members)
+
+        float tn0 = 0.0f;
+        std::size_t m_substeps = 0;
+
+        std::array<Layout, D> m_face_layouts;
+        Iteration m_iteration;
+
+        /** Face velocities of the current and next step, one ring per component. */
+        std::array<utils::field_ring<float, 2>, D> m_velocity;
+        AdvectionKernel m_advection;
+
+        std::vector<float> m_p;
+        std::vector<float> m_rhs;
+        std::vector<float> m_A_diag;
+        std::array<std::vector<float>, D> m_A_plus;
+        /** The label generation and time step the matrix was assembled for, it is reused while both match. */
+        std::uint64_t m_A_generation = no_generation;
+        float m_A_delta_t = 0.0f;
+
+        /** Holds all vectors of the pressure solver in one block. */
+        mysh::core::ScratchArena m_scratch;
+        solver::PCGSolver<D> m_pressure_solver;
+        solver::SolverResult m_pressure_result;
+    };
+
+    extern template class MacFluidSolver<2, TiledIteration<2>>;
+    extern template class MacFluidSolver<3, ActiveBricks<3>>;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file   packed_labels.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.31
+ *
+ * @brief  Cell labels packed into two bits per cell with word parallel queries.
+ */
+
+#pragma once
+
+#include "cell_label.h"
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace wavy
+{
+    /**
+     *  Stores 32 labels per 64 bit word, cell i in bits 2 * (i % 32) of word i / 32. Queries return a bit mask with
+     *  one bit per cell for a window of 32 (or 64) consecutive cells, so stencils test whole neighborhoods with a few
+     *  bitwise operations instead of one load and compare per neighbor. A million cells take 256 KiB.
+     */
+    class PackedLabels
+    {
+    public:
+        using word_type = std::uint64_t;
+        static constexpr std::size_t cells_per_word = 32;
+
+        PackedLabels() = default;
+        explicit PackedLabels(std::size_t size, CellLabel value = CellLabel::FLUID);
+        explicit PackedLabels(std::span<const CellLabel> labels);
+
+        /** Replaces all labels, resizing the store if needed. */
+        void assign(std::span<const CellLabel> labels);
+
+        [[nodiscard]] CellLabel get(std::size_t index) const
+        {
+            return static_cast<CellLabel>((m_words[index / cells_per_word] >> shift(index)) & lane_mask);
+        }
+        void set(std::size_t index, CellLabel label)
+        {
+            auto& word = m_words[index / cells_per_word];
+            word = (word & ~(lane_mask << shift(index))) | (static_cast<word_type>(label) << shift(index));
+        }
+
+        /**
+         *  Returns bit i set if cell first + i has the given label, for i < 32. Cells before 0 or after the end
+         *  have the label outside, e.g. the boundary label of the solver.
+         */
+        [[nodiscard]] std::uint32_t mask(CellLabel label, std::ptrdiff_t first, CellLabel outside) const
+        {
+            return compress(equal_lanes(window(first, outside), label));
+        }
+        /** The same as mask() for 64 cells. */
+        [[nodiscard]] std::uint64_t mask64(CellLabel label, std::ptrdiff_t first, CellLabel outside) const
+        {
+            return mask(label, first, outside)
+                   | (static_cast<std::uint64_t>(mask(label, first + std::ptrdiff_t{cells_per_word}, outside)) << 32);
+        }
+
+        /** Counts the cells with the given label. */
+        [[nodiscard]] std::size_t count(CellLabel label) const;
+        /** Returns the first run [begin, end) of cells with the given label starting at or after from, empty if none. */
+        [[nodiscard]] std::pair<std::size_t, std::size_t> find_run(CellLabel label, std::size_t from) const;
+
+        [[nodiscard]] std::size_t size() const { return m_size; }
+        [[nodiscard]] std::span<const word_type> words() const { return m_words; }
+
+    private:
+        static constexpr word_type lane_mask = 0x3;
+        static constexpr word_type low_bits = 0x5555'5555'5555'5555ULL;
+
+        static std::size_t shift(std::size_t index) { return 2 * (index % cells_per_word); }
+
+        /** Returns the 32 labels starting at first packed like a word, outside the store they read outside. */
+        [[nodiscard]] word_type window(std::ptrdiff_t first, CellLabel outside) const
+        {
+            const auto size = static_cast<std::ptrdiff_t>(m_size);
+            if (first >= 0 && first + std::ptrdiff_t{cells_per_word} <= size) [[likely]] {
+                const auto index = static_cast<std::size_t>(first);
+                const auto word = index / cells_per_word;
+                const auto offset = shift(index);
+                auto result = m_words[word] >> offset;
+                if (offset != 0) { result |= m_words[word + 1] << (64 - offset); }
+                return result;
+            }
+            return window_at_border(first, outside);
+        }
+        [[nodiscard]] word_type window_at_border(std::ptrdiff_t first, CellLabel outside) const;
+
+        /** Returns a word with the low bit of every lane set where the lane equals label. */
+        static word_type equal_lanes(word_type labels, CellLabel label)
+        {
+            const auto difference = labels ^ (low_bits * static_cast<word_type>(label));
+            return ~(difference | (difference >> 1)) & low_bits;
+        }
+        /** Gathers the low bits of the 32 lanes into 32 consecutive bits. */
+        static std::uint32_t compress(word_type x)
+        {
+            x = (x | (x >> 1)) & 0x3333'3333'3333'3333ULL;
+            x = (x | (x >> 2)) & 0x0f0f'0f0f'0f0f'0f0fULL;
+            x = (x | (x >> 4)) & 0x00ff'00ff'00ff'00ffULL;
+            x = (x | (x >> 8)) & 0x0000'ffff'0000'ffffULL;
+            x = (x | (x >> 16)) & 0x0000'0000'ffff'ffffULL;
+            return static_cast<std::uint32_t>(x);
+        }
+
+        std::size_t m_size = 0;
+        /** One extra word, so a window never reads past the end. */
+        std::vector<word_type> m_words;
+    };
+}
@@ -0,0 +1,137 @@
+/**
+ * @file   multigrid.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.23
+ *
+ * @brief  Geometric multigrid solver for the pressure system of 1d fluids.
+ */
+
+#pragma once
+
+#include "cell_label.h"
+#include "solver/pcg.h"
+
+#include <array>
+#include <memory_resource>
+#include <vector>
+
+namespace wavy::solver
+{
+    enum class MultigridCycle
+    {
+        V, F
+    };
+
+    struct MultigridSettings
+    {
+        MultigridCycle cycle = MultigridCycle::V;
+        /** Red-black Gauss-Seidel sweeps before and after the coarse grid correction. */
+        std::size_t pre_smoothing = 2;
+        std::size_t post_smoothing = 2;
+        /** Levels are coarsened until they have at most this many cells. */
+        std::size_t coarsest_size = 4;
+        /** Sweeps used to solve the coarsest level. */
+        std::size_t coarsest_smoothing = 32;
+        /** Convergence threshold for the maximum residual, relative to the maximum of the right-hand side. */
+        float tolerance = 1e-6f;
+        /** Maximum number of cycles of the standalone solver. */
+        std::size_t max_cycles = 50;
+        /** Use one cycle as preconditioner of a conjugate gradient solve instead of iterating cycles. */
+        bool as_preconditioner = false;
+        /** Label of the cells outside of the grid. */
+        CellLabel boundary_label = CellLabel::SOLID;
+    };
+
+    /**
+     *  Geometric multigrid on a cell centered grid. Coarse labels are built from the fine cell labels (a coarse cell is
+     *  empty if any of its children is, fluid if any child is fluid and solid otherwise). If the face between the two
+     *  children is closed (blocked by a solid cell) only one child is attached to the coarse cell, and a coarse face is
+     *  only open when the fine face at the same position is, so solid cells keep separating the fluid regions on all
+     *  levels. The coarse matrices are rediscretized from labels and faces the same way the fluid solver assembles its
+     *  matrix. Relaxation uses red-black Gauss-Seidel, so each half sweep is parallel.
+     */
+    class MultigridSolver
+    {
+    public:
+        MultigridSolver(std::size_t size, const MultigridSettings& settings = {}, const PCGSettings& pcg_settings = {},
+                        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        /** The bytes all levels (and the conjugate gradient vectors) of a solver take from a ScratchArena. */
+        [[nodiscard]] static std::size_t scratch_bytes(std::size_t size, const MultigridSettings& settings);
+
+        /**
+         *  Builds the coarse levels for the given fine cell labels.
+         *  @param labels the labels of the finest level.
+         *  @param scale the off-diagonal magnitude of the finest level (delta_t / (density * delta_x^2)).
+         */
+        void setup(std::span<const CellLabel> labels, float scale);
+
+        /** Solves A p = rhs, where A is the finest level matrix assembled for the labels passed to setup. */
+        SolverResult solve(const PoissonStencil<1>& A, std::span<const float> rhs, std::span<float> p);
+
+        /** Applies a single cycle with zero initial guess, i.e., z = M^-1 r. */
+        void applyCycle(const PoissonStencil<1>& A, std::span<const float> r, std::span<float> z);
+
+        [[nodiscard]] std::size_t levelCount() const { return m_levels.size() + 1; }
+        [[nodiscard]] const MultigridSettings& settings() const { return m_settings; }
+        [[nodiscard]] MultigridSettings& settings() { return m_settings; }
+        /** Runs the level operations (and the conjugate gradient solve) on the given pool instead of the global one. */
+        void setThreadPool(mysh::core::ThreadPool& pool)
+        {
+            m_thread_pool = &pool;
+            m_pcg.setThreadPool(pool);
+        }
+
+    private:
+        struct Level
+        {
+            Level(std::size_t size, std::pmr::memory_resource* resource);
+
+            [[nodiscard]] PoissonStencil<1> stencil() const { return PoissonStencil<1>{diag, {plus}, {1}}; }
+
+            std::pmr::vector<CellLabel> labels;
+            /** Whether the face between cells i - 1 and i is open, i.e., not blocked by a solid cell. */
+            std::pmr::vector<std::uint8_t> open_faces;
+            /** Bit mask of the fine children (bit 0: left, bit 1: right) that are represented by a coarse cell. */
+            std::pmr::vector<std::uint8_t> attached;
+            std::pmr::vector<float> diag;
+            std::pmr::vector<float> plus;
+            std::pmr::vector<float> x;
+            std::pmr::vector<float> b;
+            std::pmr::vector<float> r;
+        };
+
+        /** The coarse cells (at most two) a fine cell interpolates its correction from. */
+        struct Interpolation
+        {
+            std::array<std::size_t, 2> parents{};
+            std::array<float, 2> weights{};
+            std::size_t count = 0;
+        };
+
+        /** Coarse neighbors outside of the grid have the boundary label and never contribute. */
+        [[nodiscard]] static Interpolation interpolation(const Level& coarse, std::span<const CellLabel> labels_fine,
+                                                         std::size_t index, CellLabel boundary_label);
+
+        void cycle(std::size_t level, MultigridCycle type, const PoissonStencil<1>& A, std::span<const float> b,
+                   std::span<float> x);
+        void smooth(const PoissonStencil<1>& A, std::span<const float> b, std::span<float> x, std::size_t sweeps,
+                    bool reverse) const;
+        void residual(const PoissonStencil<1>& A, std::span<const float> b, std::span<const float> x,
+                      std::span<float> r) const;
+        void restrictResidual(std::span<const float> r_fine, std::span<const CellLabel> labels_fine,
+                              Level& coarse) const;
+        void prolongateAdd(const Level& coarse, std::span<const CellLabel> labels_fine, std::span<float> x_fine) const;
+
+        MultigridSettings m_settings;
+        mysh::core::ThreadPool* m_thread_pool = &mysh::core::ThreadPool::global();
+        /** Residual of the finest level. */
+        std::pmr::vector<float> m_r;
+        /** Labels and open faces of the finest level. */
+        std::pmr::vector<CellLabel> m_labels;
+        std::pmr::vector<std::uint8_t> m_open_faces;
+        /** Coarse levels, starting with the one directly below the finest level. */
+        std::pmr::vector<Level> m_levels;
+        PCGSolver<1> m_pcg;
+    };
+}
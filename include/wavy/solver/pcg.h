@@ -0,0 +1,83 @@
+/**
+ * @file   pcg.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.21
+ *
+ * @brief  Matrix free preconditioned conjugate gradient solver for the pressure system.
+ */
+
+#pragma once
+
+#include "core/function_view.h"
+#include "core/scratch_arena.h"
+#include "core/thread_pool.h"
+#include "solver/poisson_stencil.h"
+
+#include <memory_resource>
+#include <vector>
+
+namespace wavy::solver
+{
+    struct PCGSettings
+    {
+        /** Convergence threshold for the maximum residual, relative to the maximum of the right-hand side. */
+        float tolerance = 1e-6f;
+        /** Maximum number of iterations before giving up. */
+        std::size_t max_iterations = 200;
+        /** Tuning constant of the modified incomplete Cholesky preconditioner (0 gives plain IC(0)). */
+        float mic_tuning = 0.97f;
+        /** Safety constant that falls back to IC(0) for rows where MIC(0) would become unstable. */
+        float mic_safety = 0.25f;
+    };
+
+    /**
+     *  Conjugate gradient solver for the compressed Poisson stencil with a MIC(0) preconditioner
+     *  (Bridson, Fluid Simulation for Computer Graphics, ch. 5). All vectors are allocated once at construction from
+     *  the given memory resource, scratch_bytes tells how much a ScratchArena needs for them.
+     */
+    template<std::size_t D>
+    class PCGSolver
+    {
+    public:
+        /** Computes z = M^-1 r for a preconditioner M. */
+        using Preconditioner = mysh::core::function_view<void(std::span<const float> r, std::span<float> z)>;
+
+        explicit PCGSolver(std::size_t size, const PCGSettings& settings = {},
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        /** The bytes the vectors of a solver for size unknowns take from a ScratchArena. */
+        [[nodiscard]] static constexpr std::size_t scratch_bytes(std::size_t size)
+        {
+            return 5 * mysh::core::ScratchArena::footprint<float>(size);
+        }
+
+        /** Solves A p = rhs, using p as storage only (the initial guess is zero). */
+        SolverResult solve(const PoissonStencil<D>& A, std::span<const float> rhs, std::span<float> p);
+        /** Solves A p = rhs with an external (symmetric positive definite) preconditioner instead of MIC(0). */
+        SolverResult solve(const PoissonStencil<D>& A, std::span<const float> rhs, std::span<float> p,
+                           Preconditioner preconditioner);
+
+        [[nodiscard]] const PCGSettings& settings() const { return m_settings; }
+        [[nodiscard]] PCGSettings& settings() { return m_settings; }
+        /** Runs the vector operations on the given pool instead of the global one. */
+        void setThreadPool(mysh::core::ThreadPool& pool) { m_thread_pool = &pool; }
+
+    private:
+        void buildPreconditioner(const PoissonStencil<D>& A);
+        void applyPreconditioner(const PoissonStencil<D>& A, std::span<const float> r, std::span<float> z);
+        void applyA(const PoissonStencil<D>& A, std::span<const float> s, std::span<float> z) const;
+
+        PCGSettings m_settings;
+        mysh::core::ThreadPool* m_thread_pool = &mysh::core::ThreadPool::global();
+
+        std::pmr::vector<float> m_precon;
+        std::pmr::vector<float> m_r;
+        std::pmr::vector<float> m_z;
+        std::pmr::vector<float> m_s;
+        std::pmr::vector<float> m_q;
+    };
+
+    extern template class PCGSolver<1>;
+    extern template class PCGSolver<2>;
+    extern template class PCGSolver<3>;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file   poisson_stencil.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.21
+ *
+ * @brief  Compressed representation of the pressure Poisson matrix.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace wavy::solver
+{
+    /**
+     *  Matrix free view on the symmetric pressure matrix as assembled by the fluid solvers. Only the diagonal and,
+     *  for each dimension, the coefficient coupling a cell to its next neighbor (at index + stride) are stored; the
+     *  coupling to the previous neighbor follows from symmetry. Cells that are not part of the fluid have a zero row.
+     */
+    template<std::size_t D>
+    struct PoissonStencil
+    {
+        std::span<const float> diag;
+        std::array<std::span<const float>, D> plus;
+        std::array<std::size_t, D> strides;
+
+        [[nodiscard]] std::size_t size() const { return diag.size(); }
+
+        /** Computes the product of the matrix with vector s for the row with the given index. */
+        [[nodiscard]] float apply(std::span<const float> s, std::size_t index) const
+        {
+            auto result = diag[index] * s[index];
+            for (std::size_t d = 0; d < D; ++d) {
+                if (index + strides[d] < s.size()) { result += plus[d][index] * s[index + strides[d]]; }
+                if (index >= strides[d]) { result += plus[d][index - strides[d]] * s[index - strides[d]]; }
+            }
+            return result;
+        }
+    };
+
+    /** Result of a linear solve of the pressure system. */
+    struct SolverResult
+    {
+        std::size_t iterations = 0;
+        float residual = 0.0f;
+        bool converged = false;
+    };
+}
@@ -0,0 +1,47 @@
+/**
+ * @file   pressure_solver.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.22
+ *
+ * @brief  Selection of the linear solver used for the pressure projection.
+ */
+
+#pragma once
+
+#include "solver/multigrid.h"
+#include "solver/pcg.h"
+#include "solver/tridiagonal.h"
+
+#include <variant>
+
+namespace wavy::solver
+{
+    enum class PressureSolverMethod
+    {
+        PCG, Tridiagonal, Multigrid
+    };
+
+    struct PressureSolverSettings
+    {
+        PressureSolverMethod method = PressureSolverMethod::Tridiagonal;
+        /** Settings of the conjugate gradient solver, also used when multigrid preconditions it. */
+        PCGSettings pcg;
+        TridiagonalSettings tridiagonal;
+        MultigridSettings multigrid;
+    };
+
+    /** The pressure solvers available to the 1d fluid solver, all providing solve(A, rhs, p). */
+    using PressureSolver1D = std::variant<PCGSolver<1>, TridiagonalSolver, MultigridSolver>;
+
+    /** The bytes the solver selected by the settings takes from a ScratchArena for size unknowns. */
+    [[nodiscard]] inline std::size_t scratch_bytes(std::size_t size, const PressureSolverSettings& settings)
+    {
+        using enum PressureSolverMethod;
+        switch (settings.method) {
+        case PCG: return PCGSolver<1>::scratch_bytes(size);
+        case Tridiagonal: return TridiagonalSolver::scratch_bytes(size, settings.tridiagonal);
+        case Multigrid: return MultigridSolver::scratch_bytes(size, settings.multigrid);
+        }
+        return TridiagonalSolver::scratch_bytes(size, settings.tridiagonal);
+    }
+}
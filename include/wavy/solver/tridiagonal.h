@@ -0,0 +1,68 @@
+/**
+ * @file   tridiagonal.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.22
+ *
+ * @brief  Direct solvers for the tridiagonal pressure system of 1d fluids.
+ */
+
+#pragma once
+
+#include "core/scratch_arena.h"
+#include "core/thread_pool.h"
+#include "solver/poisson_stencil.h"
+
+#include <memory_resource>
+#include <vector>
+
+namespace wavy::solver
+{
+    struct TridiagonalSettings
+    {
+        /** Grid size from which on the parallel cyclic reduction is used instead of the sequential Thomas sweep. */
+        std::size_t cyclic_reduction_threshold = std::size_t{1} << 20;
+    };
+
+    /**
+     *  Solves the 1d pressure system directly. Rows of non-fluid cells (zero diagonal) yield zero pressure. A singular
+     *  system (closed domain without empty cells) is made definite by pinning the pressure of the degenerate row to
+     *  zero, which picks one of the solutions of a consistent system.
+     */
+    class TridiagonalSolver
+    {
+    public:
+        explicit TridiagonalSolver(std::size_t size, const TridiagonalSettings& settings = {},
+                                   std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        /** The bytes the vectors of a solver for size unknowns take from a ScratchArena. */
+        [[nodiscard]] static constexpr std::size_t scratch_bytes(std::size_t size, const TridiagonalSettings& settings)
+        {
+            const std::size_t vectors = size >= settings.cyclic_reduction_threshold ? 5 : 1;
+            return vectors * mysh::core::ScratchArena::footprint<float>(size);
+        }
+
+        /** Solves A p = rhs with the algorithm selected by the grid size. */
+        SolverResult solve(const PoissonStencil<1>& A, std::span<const float> rhs, std::span<float> p);
+        /** Thomas algorithm: one forward elimination and one back substitution sweep. */
+        SolverResult solveThomas(const PoissonStencil<1>& A, std::span<const float> rhs, std::span<float> p);
+        /** Cyclic reduction: O(log n) levels whose equations are reduced in parallel. */
+        SolverResult solveCyclicReduction(const PoissonStencil<1>& A, std::span<const float> rhs, std::span<float> p);
+
+        [[nodiscard]] const TridiagonalSettings& settings() const { return m_settings; }
+        [[nodiscard]] TridiagonalSettings& settings() { return m_settings; }
+        /** Runs the parallel levels of the cyclic reduction on the given pool instead of the global one. */
+        void setThreadPool(mysh::core::ThreadPool& pool) { m_thread_pool = &pool; }
+
+    private:
+        TridiagonalSettings m_settings;
+        mysh::core::ThreadPool* m_thread_pool = &mysh::core::ThreadPool::global();
+
+        /** Modified super diagonal of the Thomas algorithm. */
+        std::pmr::vector<float> m_c_prime;
+        /** Coefficient copies reduced in place by the cyclic reduction (sub-, main, super diagonal and rhs). */
+        std::pmr::vector<float> m_a;
+        std::pmr::vector<float> m_b;
+        std::pmr::vector<float> m_c;
+        std::pmr::vector<float> m_d;
+    };
+}
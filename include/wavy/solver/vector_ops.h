@@ -0,0 +1,83 @@
+/**
+ * @file   vector_ops.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.23
+ *
+ * @brief  Parallel vector operations and reductions shared by the iterative solvers.
+ */
+
+#pragma once
+
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <span>
+
+namespace wavy::solver
+{
+    namespace detail
+    {
+        /** Values handled by one task, large enough that a task outweighs its scheduling. */
+        constexpr std::size_t vector_grain_size = 16384;
+    }
+
+    /** Calls fn(i) for all indices in [first, last) on the pool. */
+    template<typename Fn>
+    void for_each_index(mysh::core::ThreadPool& pool, std::size_t first, std::size_t last, Fn&& fn)
+    {
+        pool.parallel_for(first, last, detail::vector_grain_size,
+                          [&fn](std::size_t chunk_first, std::size_t chunk_last) {
+                              for (auto i = chunk_first; i < chunk_last; ++i) { fn(i); }
+                          });
+    }
+
+    /** Calls fn(i) for the indices first, first + step, ... below last on the pool. */
+    template<typename Fn>
+    void for_each_index(mysh::core::ThreadPool& pool, std::size_t first, std::size_t last, std::size_t step, Fn&& fn)
+    {
+        if (first >= last) { return; }
+        const auto count = (last - first + step - 1) / step;
+        for_each_index(pool, 0, count, [first, step, &fn](std::size_t k) { fn(first + k * step); });
+    }
+
+    inline void fill(mysh::core::ThreadPool& pool, std::span<float> a, float value)
+    {
+        pool.parallel_for(0, a.size(), detail::vector_grain_size, [a, value](std::size_t first, std::size_t last) {
+            std::ranges::fill(a.subspan(first, last - first), value);
+        });
+    }
+
+    inline void copy(mysh::core::ThreadPool& pool, std::span<const float> from, std::span<float> to)
+    {
+        pool.parallel_for(0, from.size(), detail::vector_grain_size, [from, to](std::size_t first, std::size_t last) {
+            std::ranges::copy(from.subspan(first, last - first), to.subspan(first).begin());
+        });
+    }
+
+    inline float dot(mysh::core::ThreadPool& pool, std::span<const float> a, std::span<const float> b)
+    {
+        return pool.parallel_reduce(
+            0, a.size(), detail::vector_grain_size, 0.0f,
+            [a, b](std::size_t first, std::size_t last) {
+                auto a_chunk = a.subspan(first, last - first);
+                return std::transform_reduce(a_chunk.begin(), a_chunk.end(), b.subspan(first).begin(), 0.0f);
+            },
+            std::plus<>{});
+    }
+
+    inline float max_abs(mysh::core::ThreadPool& pool, std::span<const float> a)
+    {
+        auto max = [](float v0, float v1) { return std::max(v0, v1); };
+        return pool.parallel_reduce(
+            0, a.size(), detail::vector_grain_size, 0.0f,
+            [a, max](std::size_t first, std::size_t last) {
+                auto chunk = a.subspan(first, last - first);
+                return std::transform_reduce(chunk.begin(), chunk.end(), 0.0f, max,
+                                             [](float v) { return std::abs(v); });
+            },
+            max);
+    }
+}
@@ -8,19 +8,88 @@
 
 #pragma once
 
-#include <functional>
+#include <concepts>
+#include <cstdint>
 #include <span>
+#include <type_traits>
 
 namespace wavy::utils
 {
-    template<typename T>
+    /**
+     *  Boundary policies extend a span beyond its bounds. They are called with the (read only) content and a signed
+     *  index outside of [0, size) and return the value at that index.
+     */
+    namespace boundary
+    {
+        /** Repeats the first and last value. */
+        struct clamp
+        {
+            template<typename T>
+            [[nodiscard]] constexpr T operator()(std::span<const T> content, std::ptrdiff_t idx) const
+            {
+                return idx < 0 ? content.front() : content.back();
+            }
+        };
+
+        /** Wraps the index around. */
+        struct periodic
+        {
+            template<typename T>
+            [[nodiscard]] constexpr T operator()(std::span<const T> content, std::ptrdiff_t idx) const
+            {
+                const auto size = static_cast<std::ptrdiff_t>(content.size());
+                return content[static_cast<std::size_t>(((idx % size) + size) % size)];
+            }
+        };
+
+        /** Mirrors the content at the outer faces of the first and last element, i.e., -1 maps to 0. */
+        struct reflect
+        {
+            template<typename T>
+            [[nodiscard]] constexpr T operator()(std::span<const T> content, std::ptrdiff_t idx) const
+            {
+                const auto size = static_cast<std::ptrdiff_t>(content.size());
+                const auto period = 2 * size;
+                auto mirrored = ((idx % period) + period) % period;
+                if (mirrored >= size) { mirrored = period - 1 - mirrored; }
+                return content[static_cast<std::size_t>(mirrored)];
+            }
+        };
+
+        /** Returns a fixed value. */
+        template<typename T>
+        struct constant
+        {
+            template<typename U>
+            [[nodiscard]] constexpr T operator()([[maybe_unused]] std::span<const U> content,
+                                                 [[maybe_unused]] std::ptrdiff_t idx) const
+            {
+                return value;
+            }
+
+            T value;
+        };
+    }
+
+    /** Any callable (including the policies above) that extends a span of T beyond its bounds. */
+    template<typename Policy, typename T>
+    concept boundary_policy = std::is_invocable_r_v<std::remove_cv_t<T>, const Policy&,
+                                                    std::span<const std::remove_cv_t<T>>, std::ptrdiff_t>;
+
+    /**
+     *  A span that handles out of bounds reads with a boundary policy. The policy is part of the type, so reads inline
+     *  completely and the span itself never allocates.
+     */
+    template<typename T, typename Policy = boundary::clamp>
+        requires boundary_policy<Policy, T>
     class boundary_span
     {
     public:
+        using value_type = std::remove_cv_t<T>;
         using content_type = std::span<T>;
-        using boundary_fn = std::function<T(const content_type&, std::size_t)>;
+        using policy_type = Policy;
 
-        constexpr boundary_span(content_type content, boundary_fn handle_boundary)
+        constexpr explicit boundary_span(content_type content, Policy handle_boundary = {})
             : m_content{content}
             , m_handle_boundary{std::move(handle_boundary)}
         {
@@ -28,15 +97,23 @@ namespace wavy::utils
 
         [[nodiscard]] constexpr content_type& get_content() { return m_content; }
         [[nodiscard]] constexpr const content_type& get_content() const { return m_content; }
+        [[nodiscard]] constexpr const Policy& get_policy() const { return m_handle_boundary; }
+        [[nodiscard]] constexpr std::size_t size() const { return m_content.size(); }
 
-        [[nodiscard]] constexpr T operator[](std::size_t idx) const
+        [[nodiscard]] constexpr value_type operator[](std::size_t idx) const
         {
-            if (idx < 0 || idx >= m_content.size()) { return m_handle_boundary(m_content, idx); }
+            // indices "below" zero wrapped around, so one comparison catches both sides.
+            if (idx >= m_content.size()) [[unlikely]] {
+                return m_handle_boundary(std::span<const value_type>{m_content}, static_cast<std::ptrdiff_t>(idx));
+            }
             return m_content[idx];
         }
 
     private:
         content_type m_content;
-        boundary_fn m_handle_boundary;
+        [[no_unique_address]] Policy m_handle_boundary;
     };
+
+    template<typename T, std::size_t Extent, typename Policy>
+    boundary_span(std::span<T, Extent>, Policy) -> boundary_span<T, Policy>;
 }
@@ -10,6 +10,7 @@
 
 #include "iterator_helpers.h"
 
+#include <compare>
 #include <tuple>
 
 namespace wavy::utils
@@ -27,7 +28,9 @@ namespace wavy::utils
             using difference_type = std::ptrdiff_t;
             using value_type = std::tuple<counter_type, typename iterator_type::value_type>;
             using reference = std::tuple<counter_type, typename iterator_type::reference>;
-            using iterator_category = std::forward_iterator_tag;
+            using iterator_category = select_iterator_category_for<iterator_type>;
+
+            constexpr static bool is_random_access = std::same_as<iterator_category, std::random_access_iterator_tag>;
 
             iterator() = default;
 
@@ -36,6 +39,12 @@ namespace wavy::utils
             {
             }
 
+            iterator(iterator_type it, counter_type start)
+                : i{start}
+                , iter(std::move(it))
+            {
+            }
+
             bool operator==(const iterator& other) const { return this->iter == other.iter; }
 
             iterator& operator++()
@@ -54,6 +63,45 @@ namespace wavy::utils
 
             auto operator*() const { return reference{i, *iter}; }
             auto& operator->() const { return *iter; }
+
+            iterator& operator--() requires is_random_access
+            {
+                --i;
+                --iter;
+                return *this;
+            }
+
+            iterator operator--(int) requires is_random_access // NOLINT(cert-dcl21-cpp)
+            {
+                auto result = *this;
+                --*this;
+                return result;
+            }
+
+            iterator& operator+=(difference_type n) requires is_random_access
+            {
+                i = static_cast<counter_type>(static_cast<difference_type>(i) + n);
+                iter += n;
+                return *this;
+            }
+
+            iterator& operator-=(difference_type n) requires is_random_access { return *this += -n; }
+
+            auto operator[](difference_type n) const requires is_random_access { return *(*this + n); }
+
+            friend iterator operator+(iterator it, difference_type n) requires is_random_access { return it += n; }
+            friend iterator operator+(difference_type n, iterator it) requires is_random_access { return it += n; }
+            friend iterator operator-(iterator it, difference_type n) requires is_random_access { return it -= n; }
+
+            friend difference_type operator-(const iterator& lhs, const iterator& rhs) requires is_random_access
+            {
+                return static_cast<difference_type>(lhs.iter - rhs.iter);
+            }
+
+            friend std::strong_ordering operator<=>(const iterator& lhs, const iterator& rhs) requires is_random_access
+            {
+                return (lhs - rhs) <=> 0;
+            }
         };
     }
 
@@ -67,7 +115,17 @@ namespace wavy::utils
             using iterator = enum_detail::iterator<select_iterator_for<T>>;
 
             auto begin() { return enum_detail::iterator<select_iterator_for<T>>(std::begin(iterable)); }
-            auto end() { return enum_detail::iterator<select_iterator_for<T>>(std::end(iterable)); }
+            auto end()
+            {
+                if constexpr (iterator::is_random_access) {
+                    return iterator(std::end(iterable),
+                                    static_cast<std::size_t>(std::distance(std::begin(iterable), std::end(iterable))));
+                } else {
+                    return iterator(std::end(iterable));
+                }
+            }
+
+            auto size() requires iterator::is_random_access { return static_cast<std::size_t>(end() - begin()); }
         };
 
         return enumerate_wrapper{std::forward<T>(iterable)};
@@ -0,0 +1,69 @@
+/**
+ * @file   field_ring.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.27
+ *
+ * @brief  A ring of equally sized field buffers that a solver pipeline rotates through.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace wavy::utils
+{
+    /**
+     *  Holds N buffers of the same size. Stages read the current buffer and write the ones ahead of it, rotating
+     *  only advances an index, so no data is copied or reallocated. With N = 2 this is a ping-pong buffer.
+     */
+    template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+    class field_ring
+    {
+        static_assert(N >= 2, "A field ring needs at least two buffers.");
+
+    public:
+        using buffer_type = std::vector<T, Allocator>;
+
+        explicit field_ring(std::size_t size, const T& value = T{}, const Allocator& allocator = Allocator{})
+            : field_ring{allocator}
+        {
+            for (auto& buffer : m_buffers) { buffer.assign(size, value); }
+        }
+        /** Creates buffers with default inserted elements, which allocators may leave uninitialized. */
+        field_ring(std::size_t size, const Allocator& allocator)
+            : field_ring{allocator}
+        {
+            for (auto& buffer : m_buffers) { buffer.resize(size); }
+        }
+
+        [[nodiscard]] buffer_type& current() { return m_buffers[m_current]; }
+        [[nodiscard]] const buffer_type& current() const { return m_buffers[m_current]; }
+        /** The buffer offset positions ahead of the current one. */
+        [[nodiscard]] buffer_type& next(std::size_t offset = 1) { return m_buffers[(m_current + offset) % N]; }
+        [[nodiscard]] const buffer_type& next(std::size_t offset = 1) const
+        {
+            return m_buffers[(m_current + offset) % N];
+        }
+
+        /** Makes the buffer steps positions ahead the current one. */
+        void rotate(std::size_t steps = 1) { m_current = (m_current + steps) % N; }
+
+        [[nodiscard]] std::size_t size() const { return m_buffers[0].size(); }
+        [[nodiscard]] static constexpr std::size_t buffer_count() { return N; }
+
+    private:
+        explicit field_ring(const Allocator& allocator)
+            : m_buffers{[&allocator]<std::size_t... I>(std::index_sequence<I...>) {
+                return std::array<buffer_type, N>{((void)I, buffer_type(allocator))...};
+            }(std::make_index_sequence<N>{})}
+        {
+        }
+
+        std::array<buffer_type, N> m_buffers;
+        std::size_t m_current = 0;
+    };
+}
@@ -0,0 +1,158 @@
+/**
+ * @file   grid_layout.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.28
+ *
+ * @brief  Mapping between grid coordinates and linear indices of dense D dimensional grids.
+ */
+
+#pragma once
+
+#include "utils/index_range.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace wavy::utils
+{
+    /**
+     *  Row major layout of a dense grid, the x coordinate runs fastest. Coordinates are unsigned, neighbors outside
+     *  the grid are reached through signed coordinates and contains().
+     */
+    template<std::size_t D>
+    class grid_layout
+    {
+        static_assert(D >= 1, "A grid needs at least one dimension.");
+
+    public:
+        using index_type = std::array<std::size_t, D>;
+        using offset_type = std::array<std::ptrdiff_t, D>;
+
+        grid_layout() = default;
+        explicit grid_layout(const index_type& sizes)
+            : m_sizes{sizes}
+        {
+            std::size_t stride = 1;
+            for (std::size_t d = 0; d < D; ++d) {
+                m_strides[d] = stride;
+                stride *= m_sizes[d];
+            }
+            m_cell_count = stride;
+        }
+
+        [[nodiscard]] std::size_t linear(const index_type& cell) const
+        {
+            std::size_t result = 0;
+            for (std::size_t d = 0; d < D; ++d) { result += cell[d] * m_strides[d]; }
+            return result;
+        }
+
+        [[nodiscard]] index_type coords(std::size_t linear_index) const
+        {
+            index_type result{};
+            for (std::size_t d = 0; d < D; ++d) {
+                result[d] = linear_index % m_sizes[d];
+                linear_index /= m_sizes[d];
+            }
+            return result;
+        }
+
+        [[nodiscard]] bool contains(const offset_type& cell) const
+        {
+            for (std::size_t d = 0; d < D; ++d) {
+                if (cell[d] < 0 || static_cast<std::size_t>(cell[d]) >= m_sizes[d]) { return false; }
+            }
+            return true;
+        }
+
+        [[nodiscard]] const index_type& sizes() const { return m_sizes; }
+        [[nodiscard]] std::size_t size(std::size_t dim) const { return m_sizes[dim]; }
+        [[nodiscard]] std::size_t stride(std::size_t dim) const { return m_strides[dim]; }
+        [[nodiscard]] const index_type& strides() const { return m_strides; }
+        [[nodiscard]] std::size_t cell_count() const { return m_cell_count; }
+
+    private:
+        index_type m_sizes{};
+        index_type m_strides{};
+        std::size_t m_cell_count = 0;
+    };
+
+    /** The half open box [first, last) of grid coordinates. */
+    template<std::size_t D>
+    struct grid_box
+    {
+        std::array<std::size_t, D> first;
+        std::array<std::size_t, D> last;
+
+        [[nodiscard]] bool empty() const
+        {
+            for (std::size_t d = 0; d < D; ++d) {
+                if (first[d] >= last[d]) { return true; }
+            }
+            return false;
+        }
+    };
+
+    /**
+     *  Splits a grid into tiles of a fixed extent, the tiles at the upper borders may be smaller. Tiles are numbered
+     *  in the same row major order as the cells, so indices() can be handed to the parallel algorithms.
+     */
+    template<std::size_t D>
+    class tile_grid
+    {
+    public:
+        using index_type = typename grid_layout<D>::index_type;
+
+        tile_grid(const grid_layout<D>& grid, const index_type& tile_extent)
+            : m_cells{grid.sizes()}
+            , m_tile_extent{tile_extent}
+        {
+            index_type tile_counts{};
+            for (std::size_t d = 0; d < D; ++d) {
+                tile_counts[d] = (m_cells[d] + m_tile_extent[d] - 1) / m_tile_extent[d];
+            }
+            m_tiles = grid_layout<D>{tile_counts};
+        }
+
+        /** Returns the cells covered by a tile. */
+        [[nodiscard]] grid_box<D> tile(std::size_t tile_index) const
+        {
+            auto tile_coords = m_tiles.coords(tile_index);
+            grid_box<D> result{};
+            for (std::size_t d = 0; d < D; ++d) {
+                result.first[d] = tile_coords[d] * m_tile_extent[d];
+                result.last[d] = std::min(result.first[d] + m_tile_extent[d], m_cells[d]);
+            }
+            return result;
+        }
+
+        [[nodiscard]] const grid_layout<D>& tiles() const { return m_tiles; }
+        [[nodiscard]] const index_type& tile_extent() const { return m_tile_extent; }
+        [[nodiscard]] std::size_t size() const { return m_tiles.cell_count(); }
+        [[nodiscard]] index_range indices() const { return utils::indices(0, size()); }
+
+    private:
+        index_type m_cells;
+        index_type m_tile_extent;
+        grid_layout<D> m_tiles;
+    };
+
+    /** Calls fn(cell) for all cells of a box, x runs fastest. */
+    template<std::size_t D, typename Fn>
+    void for_each_cell(const grid_box<D>& box, Fn&& fn)
+    {
+        if (box.empty()) { return; }
+        auto cell = box.first;
+        while (true) {
+            for (cell[0] = box.first[0]; cell[0] < box.last[0]; ++cell[0]) { fn(std::as_const(cell)); }
+            std::size_t d = 1;
+            for (; d < D; ++d) {
+                if (++cell[d] < box.last[d]) { break; }
+                cell[d] = box.first[d];
+            }
+            if (d >= D) { return; }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/**
+ * @file   index_range.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.22
+ *
+ * @brief  A range of indices usable with parallel algorithms.
+ */
+
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <iterator>
+
+namespace wavy::utils
+{
+    namespace index_detail
+    {
+        /** Random access iterator over an arithmetic progression of indices. */
+        class iterator
+        {
+        public:
+            using difference_type = std::ptrdiff_t;
+            using value_type = std::size_t;
+            using reference = std::size_t;
+            using iterator_category = std::random_access_iterator_tag;
+
+            iterator() = default;
+            iterator(std::size_t index, std::size_t step) // NOLINT(bugprone-easily-swappable-parameters)
+                : m_index{index}
+                , m_step{step}
+            {
+            }
+
+            bool operator==(const iterator& other) const { return m_index == other.m_index; }
+            friend std::strong_ordering operator<=>(const iterator& lhs, const iterator& rhs)
+            {
+                return lhs.m_index <=> rhs.m_index;
+            }
+
+            reference operator*() const { return m_index; }
+            reference operator[](difference_type n) const { return *(*this + n); }
+
+            iterator& operator++()
+            {
+                m_index += m_step;
+                return *this;
+            }
+
+            iterator operator++(int) // NOLINT(cert-dcl21-cpp)
+            {
+                auto result = *this;
+                ++*this;
+                return result;
+            }
+
+            iterator& operator--()
+            {
+                m_index -= m_step;
+                return *this;
+            }
+
+            iterator operator--(int) // NOLINT(cert-dcl21-cpp)
+            {
+                auto result = *this;
+                --*this;
+                return result;
+            }
+
+            iterator& operator+=(difference_type n)
+            {
+                m_index = static_cast<std::size_t>(static_cast<difference_type>(m_index)
+                                                   + n * static_cast<difference_type>(m_step));
+                return *this;
+            }
+
+            iterator& operator-=(difference_type n) { return *this += -n; }
+
+            friend iterator operator+(iterator it, difference_type n) { return it += n; }
+            friend iterator operator+(difference_type n, iterator it) { return it += n; }
+            friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const iterator& lhs, const iterator& rhs)
+            {
+                return (static_cast<difference_type>(lhs.m_index) - static_cast<difference_type>(rhs.m_index))
+                       / static_cast<difference_type>(lhs.m_step);
+            }
+
+        private:
+            std::size_t m_index = 0;
+            std::size_t m_step = 1;
+        };
+    }
+
+    /** The indices first, first + step, ... that are smaller than last. */
+    class index_range
+    {
+    public:
+        using iterator = index_detail::iterator;
+
+        index_range(std::size_t first, std::size_t last, std::size_t step = 1) // NOLINT(bugprone-easily-swappable-parameters)
+            : m_first{first}
+            , m_count{first < last ? (last - first + step - 1) / step : 0}
+            , m_step{step}
+        {
+        }
+
+        [[nodiscard]] iterator begin() const { return iterator{m_first, m_step}; }
+        [[nodiscard]] iterator end() const { return iterator{m_first + m_count * m_step, m_step}; }
+        [[nodiscard]] std::size_t size() const { return m_count; }
+        [[nodiscard]] bool empty() const { return m_count == 0; }
+
+    private:
+        std::size_t m_first;
+        std::size_t m_count;
+        std::size_t m_step;
+    };
+
+    inline index_range indices(std::size_t first, std::size_t last, std::size_t step = 1) // NOLINT(bugprone-easily-swappable-parameters)
+    {
+        return index_range{first, last, step};
+    }
+}
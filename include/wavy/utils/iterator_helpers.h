@@ -8,21 +8,51 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <iterator>
 #include <ranges>
 #include <vector>
 
 namespace wavy::utils
 {
+    namespace helper_detail
+    {
+        template<typename T> struct iterator_for
+        {
+            using type = decltype(std::begin(std::declval<T&>()));
+        };
+
+        template<typename T>
+            requires requires {
+                typename T::iterator;
+                typename T::const_iterator;
+            }
+        struct iterator_for<T>
+        {
+            using type = std::conditional_t<std::is_const_v<T>, typename T::const_iterator, typename T::iterator>;
+        };
+    }
+
     template<typename T>
-    using select_iterator_for =
-        std::conditional_t<std::is_const_v<std::remove_reference_t<T>>, typename std::decay_t<T>::const_iterator,
-                           typename std::decay_t<T>::iterator>;
+    using select_iterator_for = typename helper_detail::iterator_for<std::remove_reference_t<T>>::type;
 
     template<typename Iter>
     using select_access_type_for = std::conditional_t<
         std::is_same_v<Iter, std::vector<bool>::iterator> || std::is_same_v<Iter, std::vector<bool>::const_iterator>,
         typename std::iterator_traits<Iter>::value_type, typename std::iterator_traits<Iter>::reference>;
 
+    /** Checks whether an iterator advertises (at least) random access via its iterator category. */
+    template<typename Iter>
+    concept legacy_random_access_iterator =
+        std::derived_from<typename std::iterator_traits<Iter>::iterator_category, std::random_access_iterator_tag>;
+
+    /** Selects the strongest iterator category a wrapper over all given iterators can offer. */
+    template<typename... Iters>
+    using select_iterator_category_for =
+        std::conditional_t<(legacy_random_access_iterator<Iters> && ...), std::random_access_iterator_tag,
+                           std::forward_iterator_tag>;
+
     /*  The index sequence is only used to deduce the Index sequence in the template
     declaration. It uses a fold expression which is applied to the indexes,
     using each expanded value to compare tuple value at that index. If any of
@@ -42,4 +72,23 @@ namespace wavy::utils
     {
         return any_match_impl(lhs, rhs, std::index_sequence_for<Args...>{});
     }
+
+    /*  Computes the distance between two tuples of iterators. For zipped ranges of different lengths the
+    distances differ only when one of the tuples holds end iterators, so the distance closest to zero is the
+    one of the shortest range. */
+    template<typename... Args, std::size_t... Index>
+    auto min_distance_impl(std::tuple<Args...> const& lhs, std::tuple<Args...> const& rhs,
+                           std::index_sequence<Index...> /*unused*/) -> std::ptrdiff_t
+    {
+        const std::array<std::ptrdiff_t, sizeof...(Args)> distances{
+            static_cast<std::ptrdiff_t>(std::get<Index>(lhs) - std::get<Index>(rhs))...};
+        if (distances[0] >= 0) { return *std::ranges::min_element(distances); }
+        return *std::ranges::max_element(distances);
+    }
+
+    /*  User function for the distance between two tuples of random access iterators. */
+    template<typename... Args> auto min_distance(std::tuple<Args...> const& lhs, std::tuple<Args...> const& rhs) -> std::ptrdiff_t
+    {
+        return min_distance_impl(lhs, rhs, std::index_sequence_for<Args...>{});
+    }
 }
@@ -0,0 +1,82 @@
+/**
+ * @file   padded_span.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.24
+ *
+ * @brief  A span with ghost cells around its content.
+ */
+
+#pragma once
+
+#include "utils/boundary_span.h"
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace wavy::utils
+{
+    /** Number of elements needed to store size elements with the given number of ghost cells on each side. */
+    [[nodiscard]] constexpr std::size_t padded_size(std::size_t size, std::size_t ghost_cells)
+    {
+        return size + 2 * ghost_cells;
+    }
+
+    /**
+     *  A view on storage that holds ghost cells on both sides of the content. Index 0 is the first content element,
+     *  indices in [-ghost_cells, size + ghost_cells) are valid and are read without any branch. The ghost cells are
+     *  written once from a boundary policy before reading.
+     */
+    template<typename T>
+    class padded_span
+    {
+    public:
+        using value_type = std::remove_cv_t<T>;
+        using content_type = std::span<T>;
+
+        constexpr padded_span(content_type storage, std::size_t ghost_cells)
+            : m_storage{storage}
+            , m_ghost_cells{ghost_cells}
+        {
+        }
+
+        /** Converts a mutable view to a read only one. */
+        constexpr operator padded_span<const T>() const // NOLINT(hicpp-explicit-conversions)
+            requires(!std::is_const_v<T>)
+        {
+            return padded_span<const T>{m_storage, m_ghost_cells};
+        }
+
+        [[nodiscard]] constexpr content_type get_storage() const { return m_storage; }
+        [[nodiscard]] constexpr content_type get_content() const
+        {
+            return m_storage.subspan(m_ghost_cells, size());
+        }
+        [[nodiscard]] constexpr std::size_t ghost_cells() const { return m_ghost_cells; }
+        [[nodiscard]] constexpr std::size_t size() const { return m_storage.size() - 2 * m_ghost_cells; }
+
+        [[nodiscard]] constexpr T& operator[](std::size_t idx) const
+        {
+            // indices "below" zero wrapped around and wrap back into the storage here.
+            return m_storage[idx + m_ghost_cells];
+        }
+
+        /** Writes all ghost cells from the content with the given boundary policy. */
+        template<typename Policy = boundary::clamp>
+            requires(!std::is_const_v<T> && boundary_policy<Policy, T>)
+        constexpr void fill_ghost_cells(const Policy& policy = {}) const
+        {
+            const std::span<const T> content = get_content();
+            const auto last = static_cast<std::ptrdiff_t>(size()) - 1;
+            for (std::size_t g = 1; g <= m_ghost_cells; ++g) {
+                const auto offset = static_cast<std::ptrdiff_t>(g);
+                m_storage[m_ghost_cells - g] = policy(content, -offset);
+                m_storage[m_ghost_cells + size() - 1 + g] = policy(content, last + offset);
+            }
+        }
+
+    private:
+        content_type m_storage;
+        std::size_t m_ghost_cells;
+    };
+}
@@ -0,0 +1,282 @@
+/**
+ * @file   soa_fields.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.04
+ *
+ * @brief  Structure of arrays container for fields that share their size.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace wavy::utils
+{
+    /** A channel of a soa_fields container, named by the (usually empty) tag type. */
+    template<typename Tag, typename T = float>
+    struct field_channel
+    {
+        using tag = Tag;
+        using value_type = T;
+    };
+
+    namespace soa_detail
+    {
+        template<typename Tag, typename... Channels>
+        constexpr std::size_t index_of()
+        {
+            constexpr std::array<bool, sizeof...(Channels)> matches{std::is_same_v<Tag, typename Channels::tag>...};
+            static_assert(std::ranges::count(matches, true) == 1, "Every tag has to name exactly one channel.");
+            return static_cast<std::size_t>(std::ranges::find(matches, true) - matches.begin());
+        }
+    }
+
+    /**
+     *  Holds one array per channel, all of the same size, in a single buffer. Every channel starts on its own cache
+     *  line, so kernels can run over several channels with contiguous (vectorizable) loads and stores:
+     *
+     *      auto [p, rhs] = fields.channels<Pressure, Rhs>();
+     *      for (std::size_t i = 0; i < p.size(); ++i) { p[i] += rhs[i]; }
+     *
+     *  fields[i] gives a proxy to all values of one cell. Elements are constructed through the allocator, so an
+     *  allocator that default initializes (like the first touch allocator) leaves the pages untouched.
+     */
+    template<typename Allocator, typename... Channels>
+    class basic_soa_fields
+    {
+        static_assert(sizeof...(Channels) > 0, "A field container needs at least one channel.");
+        static_assert((std::is_trivially_copyable_v<typename Channels::value_type> && ...),
+                      "Channels hold plain values that are copied bytewise on resize.");
+
+        using byte_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::byte>;
+        using byte_traits = std::allocator_traits<byte_allocator>;
+        using channel_list = std::tuple<Channels...>;
+
+        template<std::size_t I>
+        using value_type_at = typename std::tuple_element_t<I, channel_list>::value_type;
+
+    public:
+        using allocator_type = byte_allocator;
+        using size_type = std::size_t;
+
+        static constexpr std::size_t channel_count = sizeof...(Channels);
+        /** Every channel starts at a multiple of this many bytes. */
+        static constexpr std::size_t channel_alignment =
+            std::max({std::size_t{64}, alignof(typename Channels::value_type)...});
+
+        template<typename Tag>
+        static constexpr std::size_t index_of = soa_detail::index_of<Tag, Channels...>();
+        template<typename Tag>
+        using value_type_of = value_type_at<index_of<Tag>>;
+
+        /** The values of all channels at one cell. */
+        template<bool is_const>
+        class cell_proxy
+        {
+            using fields_type = std::conditional_t<is_const, const basic_soa_fields, basic_soa_fields>;
+
+        public:
+            cell_proxy(fields_type& fields, size_type index) noexcept : m_fields{&fields}, m_index{index} {}
+
+            template<typename Tag>
+            [[nodiscard]] auto& get() const noexcept
+            {
+                return m_fields->template channel<Tag>()[m_index];
+            }
+
+        private:
+            fields_type* m_fields;
+            size_type m_index;
+        };
+        using reference = cell_proxy<false>;
+        using const_reference = cell_proxy<true>;
+
+        explicit basic_soa_fields(size_type size = 0, const Allocator& alloc = Allocator{})
+            : m_alloc{alloc}
+        {
+            resize(size);
+        }
+        basic_soa_fields(const basic_soa_fields& rhs)
+            : basic_soa_fields{0, byte_traits::select_on_container_copy_construction(rhs.m_alloc)}
+        {
+            copy_from(rhs);
+        }
+        basic_soa_fields(basic_soa_fields&& rhs) noexcept
+            : m_alloc{std::move(rhs.m_alloc)}
+            , m_buffer{std::exchange(rhs.m_buffer, nullptr)}
+            , m_buffer_size{std::exchange(rhs.m_buffer_size, 0)}
+            , m_offsets{rhs.m_offsets}
+            , m_size{std::exchange(rhs.m_size, 0)}
+        {
+        }
+        basic_soa_fields& operator=(const basic_soa_fields& rhs)
+        {
+            if (this != &rhs) {
+                release();
+                if constexpr (byte_traits::propagate_on_container_copy_assignment::value) { m_alloc = rhs.m_alloc; }
+                copy_from(rhs);
+            }
+            return *this;
+        }
+        basic_soa_fields& operator=(basic_soa_fields&& rhs) noexcept
+        {
+            if (this != &rhs) {
+                release();
+                if constexpr (byte_traits::propagate_on_container_move_assignment::value) {
+                    m_alloc = std::move(rhs.m_alloc);
+                } else {
+                    assert(m_alloc == rhs.m_alloc);
+                }
+                m_buffer = std::exchange(rhs.m_buffer, nullptr);
+                m_buffer_size = std::exchange(rhs.m_buffer_size, 0);
+                m_offsets = rhs.m_offsets;
+                m_size = std::exchange(rhs.m_size, 0);
+            }
+            return *this;
+        }
+        ~basic_soa_fields() { release(); }
+
+        [[nodiscard]] size_type size() const noexcept { return m_size; }
+        [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+        [[nodiscard]] allocator_type get_allocator() const noexcept { return m_alloc; }
+
+        /** Resizes all channels with a single allocation, keeping the values of the first min(size, new_size) cells. */
+        void resize(size_type new_size);
+
+        /** The whole channel named by Tag. */
+        template<typename Tag>
+        [[nodiscard]] std::span<value_type_of<Tag>> channel() noexcept
+        {
+            return {data<index_of<Tag>>(), m_size};
+        }
+        template<typename Tag>
+        [[nodiscard]] std::span<const value_type_of<Tag>> channel() const noexcept
+        {
+            return {data<index_of<Tag>>(), m_size};
+        }
+        /** The channels named by Tags, e.g. for a structured binding. */
+        template<typename... Tags>
+        [[nodiscard]] std::tuple<std::span<value_type_of<Tags>>...> channels() noexcept
+        {
+            return {channel<Tags>()...};
+        }
+        template<typename... Tags>
+        [[nodiscard]] std::tuple<std::span<const value_type_of<Tags>>...> channels() const noexcept
+        {
+            return {channel<Tags>()...};
+        }
+
+        [[nodiscard]] reference operator[](size_type index) noexcept { return reference{*this, index}; }
+        [[nodiscard]] const_reference operator[](size_type index) const noexcept
+        {
+            return const_reference{*this, index};
+        }
+
+    private:
+        using offsets_type = std::array<std::size_t, channel_count>;
+
+        [[nodiscard]] static constexpr std::size_t padded(std::size_t bytes)
+        {
+            return (bytes + channel_alignment - 1) / channel_alignment * channel_alignment;
+        }
+
+        /** The offset of every channel in an aligned buffer and the bytes of that buffer. */
+        [[nodiscard]] static std::pair<offsets_type, std::size_t> layout(size_type size)
+        {
+            offsets_type offsets{};
+            std::size_t bytes = 0;
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                ((offsets[I] = bytes, bytes += padded(size * sizeof(value_type_at<I>))), ...);
+            }(std::make_index_sequence<channel_count>{});
+            return {offsets, bytes};
+        }
+
+        /** The first cache line boundary of the buffer, every channel offset is relative to it. */
+        [[nodiscard]] std::byte* base() const noexcept
+        {
+            const auto address = std::bit_cast<std::uintptr_t>(m_buffer);
+            const auto offset = (channel_alignment - address % channel_alignment) % channel_alignment;
+            return m_buffer + offset; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+
+        template<std::size_t I>
+        [[nodiscard]] value_type_at<I>* data() const noexcept
+        {
+            if (m_buffer == nullptr) { return nullptr; }
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            return std::bit_cast<value_type_at<I>*>(base() + m_offsets[I]);
+        }
+
+        void copy_from(const basic_soa_fields& rhs)
+        {
+            resize(rhs.m_size);
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                (std::ranges::copy(std::span{rhs.data<I>(), rhs.m_size}, data<I>()), ...);
+            }(std::make_index_sequence<channel_count>{});
+        }
+
+        void release() noexcept
+        {
+            // the values are trivially destructible, only the memory is given back.
+            if (m_buffer != nullptr) { byte_traits::deallocate(m_alloc, m_buffer, m_buffer_size); }
+            m_buffer = nullptr;
+            m_buffer_size = 0;
+            m_size = 0;
+        }
+
+        byte_allocator m_alloc;
+        /** The buffer as returned by the allocator, channel_alignment - 1 bytes larger than the channels need. */
+        std::byte* m_buffer = nullptr;
+        std::size_t m_buffer_size = 0;
+        offsets_type m_offsets{};
+        size_type m_size = 0;
+    };
+
+    template<typename Allocator, typename... Channels>
+    inline void basic_soa_fields<Allocator, Channels...>::resize(size_type new_size)
+    {
+        if (new_size == m_size) { return; }
+        auto [offsets, bytes] = layout(new_size);
+        basic_soa_fields resized{0, m_alloc};
+        if (new_size > 0) {
+            resized.m_buffer_size = bytes + channel_alignment - 1;
+            resized.m_buffer = byte_traits::allocate(resized.m_alloc, resized.m_buffer_size);
+            resized.m_offsets = offsets;
+            resized.m_size = new_size;
+        }
+
+        const auto kept = std::min(m_size, new_size);
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            auto fill = [&]<std::size_t J>(std::integral_constant<std::size_t, J>) {
+                using value_type = value_type_at<J>;
+                using value_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+                value_allocator alloc{m_alloc};
+                auto* target = resized.template data<J>();
+                std::ranges::copy(std::span{data<J>(), kept}, target);
+                for (auto i = kept; i < new_size; ++i) {
+                    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                    std::allocator_traits<value_allocator>::construct(alloc, target + i);
+                }
+            };
+            (fill(std::integral_constant<std::size_t, I>{}), ...);
+        }(std::make_index_sequence<channel_count>{});
+
+        std::swap(m_buffer, resized.m_buffer);
+        std::swap(m_buffer_size, resized.m_buffer_size);
+        std::swap(m_offsets, resized.m_offsets);
+        std::swap(m_size, resized.m_size);
+    }
+
+    /** Field channels in memory from the standard allocator, new cells are zero. */
+    template<typename... Channels>
+    using soa_fields = basic_soa_fields<std::allocator<std::byte>, Channels...>;
+}
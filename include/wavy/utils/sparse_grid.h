@@ -0,0 +1,207 @@
+/**
+ * @file   sparse_grid.h
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.30
+ *
+ * @brief  Block allocated sparse storage for grid fields.
+ */
+
+#pragma once
+
+#include "utils/grid_layout.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace wavy::utils
+{
+    /**
+     *  A field over a D dimensional grid that only stores blocks of 2^BlockLog2 cells per dimension that were
+     *  allocated. A dense root table maps every block of the grid to its storage, so a lookup is two shifts, one
+     *  table read and one mask, no matter how sparse the grid is. Cells in unallocated blocks read the background
+     *  value. Memory grows with the allocated blocks plus one index per block of the bounding box.
+     *
+     *  Reading and writing allocated cells is thread safe for distinct cells, allocating and pruning blocks is not.
+     */
+    template<typename T, std::size_t D, std::size_t BlockLog2 = 3>
+    class sparse_grid
+    {
+    public:
+        static constexpr std::size_t block_width = std::size_t{1} << BlockLog2;
+        static constexpr std::size_t block_cells = [] {
+            std::size_t result = 1;
+            for (std::size_t d = 0; d < D; ++d) { result *= block_width; }
+            return result;
+        }();
+
+        using value_type = T;
+        using index_type = typename grid_layout<D>::index_type;
+        using block_type = std::array<T, block_cells>;
+
+        sparse_grid(const index_type& sizes, const T& background)
+            : m_cells{sizes}
+            , m_blocks{block_counts(sizes)}
+            , m_root(m_blocks.cell_count(), no_block)
+            , m_background{background}
+        {
+        }
+
+        /**
+         *  Builds a sparse copy of a dense field in the given layout. A block is allocated if one of its cells
+         *  satisfies keep or lies within halo blocks of such a cell, e.g. everything within a block of the fluid.
+         */
+        template<typename Predicate>
+        static sparse_grid from_dense(const grid_layout<D>& layout, std::span<const T> dense, const T& background,
+                                      Predicate keep, std::size_t halo = 0)
+        {
+            sparse_grid result{layout.sizes(), background};
+            for (std::size_t i = 0; i < dense.size(); ++i) {
+                if (keep(dense[i])) { result.allocate(result.block_of(layout.coords(i))); }
+            }
+            result.dilate(halo);
+            for (std::size_t block = 0; block < result.block_count(); ++block) {
+                auto data = result.block_data(block);
+                for_each_cell(result.block_box(block), [&](const index_type& cell) {
+                    data[result.offset_in_block(cell)] = dense[layout.linear(cell)];
+                });
+            }
+            return result;
+        }
+
+        /** Returns the value of a cell, the background for unallocated ones. */
+        [[nodiscard]] const T& get(const index_type& cell) const
+        {
+            auto block = m_root[block_of(cell)];
+            if (block == no_block) { return m_background; }
+            return (*m_storage[block])[offset_in_block(cell)];
+        }
+
+        /** Returns the storage of a cell or nullptr if its block is not allocated. */
+        [[nodiscard]] T* find(const index_type& cell)
+        {
+            auto block = m_root[block_of(cell)];
+            if (block == no_block) { return nullptr; }
+            return &(*m_storage[block])[offset_in_block(cell)];
+        }
+
+        /** Sets a cell, allocating its block if needed. */
+        void set(const index_type& cell, const T& value)
+        {
+            (*m_storage[allocate(block_of(cell))])[offset_in_block(cell)] = value;
+        }
+
+        /** Allocates the block with the given root index (filled with the background) and returns its storage index. */
+        std::size_t allocate(std::size_t root_index)
+        {
+            if (m_root[root_index] != no_block) { return m_root[root_index]; }
+            auto block = std::make_unique<block_type>();
+            block->fill(m_background);
+            m_root[root_index] = static_cast<std::uint32_t>(m_storage.size());
+            m_storage.push_back(std::move(block));
+            m_block_ids.push_back(root_index);
+            return m_root[root_index];
+        }
+
+        /** Allocates all blocks within distance blocks (in every dimension) of an allocated one. */
+        void dilate(std::size_t distance)
+        {
+            if (distance == 0) { return; }
+            const std::vector<std::size_t> seeds = m_block_ids;
+            for (auto seed : seeds) {
+                auto center = m_blocks.coords(seed);
+                grid_box<D> box{};
+                for (std::size_t d = 0; d < D; ++d) {
+                    box.first[d] = center[d] >= distance ? center[d] - distance : 0;
+                    box.last[d] = std::min(center[d] + distance + 1, m_blocks.size(d));
+                }
+                for_each_cell(box, [this](const index_type& block) { allocate(m_blocks.linear(block)); });
+            }
+        }
+
+        /** Frees all blocks whose cells all equal the background. */
+        void prune()
+        {
+            std::size_t kept = 0;
+            for (std::size_t block = 0; block < m_storage.size(); ++block) {
+                const auto& data = *m_storage[block];
+                const bool empty = std::all_of(std::begin(data), std::end(data),
+                                               [this](const T& value) { return value == m_background; });
+                if (empty) {
+                    m_root[m_block_ids[block]] = no_block;
+                    continue;
+                }
+                m_root[m_block_ids[block]] = static_cast<std::uint32_t>(kept);
+                m_storage[kept] = std::move(m_storage[block]);
+                m_block_ids[kept] = m_block_ids[block];
+                kept += 1;
+            }
+            m_storage.resize(kept);
+            m_block_ids.resize(kept);
+        }
+
+        /** Returns the root index of the block containing a cell. */
+        [[nodiscard]] std::size_t block_of(const index_type& cell) const
+        {
+            std::size_t result = 0;
+            for (std::size_t d = 0; d < D; ++d) { result += (cell[d] >> BlockLog2) * m_blocks.stride(d); }
+            return result;
+        }
+
+        /** Returns the index of a cell inside the storage of its block, x running fastest. */
+        [[nodiscard]] static std::size_t offset_in_block(const index_type& cell)
+        {
+            std::size_t result = 0;
+            for (std::size_t d = D; d-- > 0;) { result = (result << BlockLog2) | (cell[d] & (block_width - 1)); }
+            return result;
+        }
+
+        /** The number of allocated blocks, allocated blocks are numbered 0, ..., block_count() - 1. */
+        [[nodiscard]] std::size_t block_count() const { return m_storage.size(); }
+        [[nodiscard]] std::span<T, block_cells> block_data(std::size_t block) { return *m_storage[block]; }
+        [[nodiscard]] std::span<const T, block_cells> block_data(std::size_t block) const { return *m_storage[block]; }
+        /** Returns the cells of an allocated block that lie inside the grid. */
+        [[nodiscard]] grid_box<D> block_box(std::size_t block) const
+        {
+            auto coords = m_blocks.coords(m_block_ids[block]);
+            grid_box<D> result{};
+            for (std::size_t d = 0; d < D; ++d) {
+                result.first[d] = coords[d] << BlockLog2;
+                result.last[d] = std::min(result.first[d] + block_width, m_cells.size(d));
+            }
+            return result;
+        }
+
+        [[nodiscard]] const grid_layout<D>& cells() const { return m_cells; }
+        [[nodiscard]] const grid_layout<D>& blocks() const { return m_blocks; }
+        [[nodiscard]] const T& background() const { return m_background; }
+        /** Approximate heap memory in bytes, blocks plus the root table. */
+        [[nodiscard]] std::size_t memory_usage() const
+        {
+            return m_storage.size() * (sizeof(block_type) + sizeof(std::size_t))
+                   + m_root.size() * sizeof(std::uint32_t);
+        }
+
+    private:
+        static constexpr std::uint32_t no_block = std::numeric_limits<std::uint32_t>::max();
+
+        static grid_layout<D> block_counts(index_type sizes)
+        {
+            for (auto& size : sizes) { size = (size + block_width - 1) >> BlockLog2; }
+            return grid_layout<D>{sizes};
+        }
+
+        grid_layout<D> m_cells;
+        grid_layout<D> m_blocks;
+        /** Storage index of every block of the grid, no_block if it is not allocated. */
+        std::vector<std::uint32_t> m_root;
+        std::vector<std::unique_ptr<block_type>> m_storage;
+        /** Root index of every allocated block. */
+        std::vector<std::size_t> m_block_ids;
+        T m_background;
+    };
+}
@@ -10,6 +10,7 @@
 
 #include "iterator_helpers.h"
 
+#include <compare>
 #include <tuple>
 
 namespace wavy::utils
@@ -35,7 +36,9 @@ namespace wavy::utils
             using difference_type = std::ptrdiff_t;
             using value_type = std::tuple<select_access_type_for<Iters>...>;
             using reference = std::tuple<typename Iters::reference ...>;
-            using iterator_category = std::forward_iterator_tag;
+            using iterator_category = select_iterator_category_for<Iters...>;
+
+            constexpr static bool is_random_access = std::same_as<iterator_category, std::random_access_iterator_tag>;
 
             zip_iterator() = default;
 
@@ -65,6 +68,54 @@ namespace wavy::utils
                 return std::apply([](auto&&... iterators) { return reference(*iterators...); }, m_iterators);
             }
 
+            zip_iterator& operator--() requires is_random_access
+            {
+                std::apply([](auto&... iterators) { ((--iterators), ...); }, m_iterators);
+                return *this;
+            }
+
+            zip_iterator operator--(int) requires is_random_access // NOLINT(cert-dcl21-cpp)
+            {
+                auto result = *this;
+                --*this;
+                return result;
+            }
+
+            zip_iterator& operator+=(difference_type n) requires is_random_access
+            {
+                std::apply([n](auto&... iterators) { ((iterators += n), ...); }, m_iterators);
+                return *this;
+            }
+
+            zip_iterator& operator-=(difference_type n) requires is_random_access { return *this += -n; }
+
+            reference operator[](difference_type n) const requires is_random_access { return *(*this + n); }
+
+            friend zip_iterator operator+(zip_iterator it, difference_type n) requires is_random_access
+            {
+                return it += n;
+            }
+
+            friend zip_iterator operator+(difference_type n, zip_iterator it) requires is_random_access
+            {
+                return it += n;
+            }
+
+            friend zip_iterator operator-(zip_iterator it, difference_type n) requires is_random_access
+            {
+                return it -= n;
+            }
+
+            friend difference_type operator-(const zip_iterator& lhs, const zip_iterator& rhs) requires is_random_access
+            {
+                return min_distance(lhs.m_iterators, rhs.m_iterators);
+            }
+
+            friend std::strong_ordering operator<=>(const zip_iterator& lhs, const zip_iterator& rhs) requires is_random_access
+            {
+                return (lhs - rhs) <=> 0;
+            }
+
         private:
             iterator_tuple m_iterators;
         };
@@ -93,6 +144,8 @@ namespace wavy::utils
                                   m_iterables);
             }
 
+            auto size() requires iterator::is_random_access { return static_cast<std::size_t>(end() - begin()); }
+
         private:
             std::tuple<Ts...> m_iterables;
         };
@@ -0,0 +1,222 @@
+/**
+ * @file   checkpoint.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.05
+ *
+ * @brief  Binary checkpoints of solver state that are written in the background and loaded by memory mapping.
+ */
+
+#include "core/checkpoint.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mysh::core {
+
+    namespace {
+        constexpr std::array<char, 8> checkpoint_magic{'W', 'A', 'V', 'Y', 'C', 'K', 'P', 'T'};
+        /** Reads differently on machines of the other byte order, the raw blocks are not portable between them. */
+        constexpr std::uint32_t byte_order_mark = 0x01020304;
+        /** The blocks start on a page, so their alignment in the file is their alignment in the mapping. */
+        constexpr std::size_t page_alignment = 4096;
+
+        struct Preamble
+        {
+            std::array<char, 8> magic = checkpoint_magic;
+            std::uint32_t format_version = checkpoint_format_version;
+            std::uint32_t byte_order = byte_order_mark;
+            std::uint64_t header_bytes = 0;
+            std::uint64_t blocks_offset = 0;
+        };
+
+        constexpr std::size_t align(std::size_t bytes, std::size_t alignment)
+        {
+            return (bytes + alignment - 1) / alignment * alignment;
+        }
+
+        std::string serialize_header(const CheckpointHeader& header)
+        {
+            std::ostringstream stream;
+            {
+                cereal::PortableBinaryOutputArchive archive{stream};
+                archive(header);
+            }
+            return std::move(stream).str();
+        }
+
+        template<typename T>
+        void write_bytes(std::ofstream& file, const T* data, std::size_t count)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+        }
+    }
+
+    void Checkpoint::add_block(std::string name, std::span<const std::byte> bytes, std::size_t element_size)
+    {
+        const auto offset = align(m_blocks.size(), detail::checkpoint_block_alignment);
+        m_blocks.resize(offset + bytes.size());
+        std::ranges::copy(bytes, m_blocks.begin() + static_cast<std::ptrdiff_t>(offset));
+        m_header.blocks.push_back({std::move(name), offset, bytes.size(), static_cast<std::uint32_t>(element_size)});
+    }
+
+    void Checkpoint::write(const std::filesystem::path& path) const
+    {
+        const auto header = serialize_header(m_header);
+        Preamble preamble;
+        preamble.header_bytes = header.size();
+        preamble.blocks_offset = align(sizeof(Preamble) + header.size(), page_alignment);
+        const std::vector<char> padding(preamble.blocks_offset - sizeof(Preamble) - header.size(), 0);
+
+        auto temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+            write_bytes(file, &preamble, 1);
+            write_bytes(file, header.data(), header.size());
+            write_bytes(file, padding.data(), padding.size());
+            write_bytes(file, m_blocks.data(), m_blocks.size());
+            file.close();
+            if (!file) { throw CheckpointError{"Could not write checkpoint " + temporary.string() + "."}; }
+        }
+        std::filesystem::rename(temporary, path);
+    }
+
+    std::future<void> Checkpoint::write_async(std::filesystem::path path) &&
+    {
+        return std::async(std::launch::async,
+                          [checkpoint = std::move(*this), path = std::move(path)]() { checkpoint.write(path); });
+    }
+
+    MappedCheckpoint::MappedCheckpoint(const std::filesystem::path& path)
+    {
+        auto fail = [&path](std::string_view reason) {
+            return CheckpointError{"Could not load checkpoint " + path.string() + ": " + std::string{reason}};
+        };
+
+#if defined(_WIN32)
+        auto* file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) { throw fail("cannot open the file."); }
+        LARGE_INTEGER file_size{};
+        GetFileSizeEx(file, &file_size);
+        m_size = static_cast<std::size_t>(file_size.QuadPart);
+        auto* mapping = m_size == 0 ? nullptr : CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping != nullptr) {
+            // the view keeps the mapping alive.
+            m_data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        if (m_data == nullptr) { throw fail("cannot map the file."); }
+#else
+        const auto file = open(path.c_str(), O_RDONLY); // NOLINT(cppcoreguidelines-pro-type-vararg)
+        if (file < 0) { throw fail("cannot open the file."); }
+        struct stat file_stat{};
+        fstat(file, &file_stat);
+        m_size = static_cast<std::size_t>(file_stat.st_size);
+        auto* mapping = m_size == 0 ? MAP_FAILED : mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (mapping == MAP_FAILED) { throw fail("cannot map the file."); } // NOLINT(performance-no-int-to-ptr)
+        m_data = static_cast<const std::byte*>(mapping);
+#endif
+
+        try {
+            Preamble preamble;
+            if (m_size < sizeof(Preamble)) { throw fail("the file is too small."); }
+            std::memcpy(&preamble, m_data, sizeof(Preamble));
+            if (preamble.magic != checkpoint_magic) { throw fail("the file is not a checkpoint."); }
+            if (preamble.format_version != checkpoint_format_version) { throw fail("unsupported format version."); }
+            if (preamble.byte_order != byte_order_mark) { throw fail("the file was written with another byte order."); }
+            if (preamble.blocks_offset > m_size || preamble.blocks_offset < sizeof(Preamble)
+                || preamble.header_bytes > preamble.blocks_offset - sizeof(Preamble)) {
+                throw fail("the file is truncated.");
+            }
+
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            std::ispanstream stream{std::span{reinterpret_cast<const char*>(m_data) + sizeof(Preamble),
+                                              preamble.header_bytes}};
+            try {
+                cereal::PortableBinaryInputArchive archive{stream};
+                archive(m_header);
+            } catch (const cereal::Exception&) {
+                throw fail("the header is corrupt.");
+            }
+
+            m_blocks_offset = preamble.blocks_offset;
+            for (const auto& block : m_header.blocks) {
+                if (block.offset + block.bytes > m_size - m_blocks_offset) { throw fail("the file is truncated."); }
+            }
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    MappedCheckpoint::MappedCheckpoint(MappedCheckpoint&& rhs) noexcept
+        : m_data{std::exchange(rhs.m_data, nullptr)}
+        , m_size{std::exchange(rhs.m_size, 0)}
+        , m_blocks_offset{rhs.m_blocks_offset}
+        , m_header{std::move(rhs.m_header)}
+    {
+    }
+
+    MappedCheckpoint& MappedCheckpoint::operator=(MappedCheckpoint&& rhs) noexcept
+    {
+        if (this != &rhs) {
+            unmap();
+            m_data = std::exchange(rhs.m_data, nullptr);
+            m_size = std::exchange(rhs.m_size, 0);
+            m_blocks_offset = rhs.m_blocks_offset;
+            m_header = std::move(rhs.m_header);
+        }
+        return *this;
+    }
+
+    MappedCheckpoint::~MappedCheckpoint() { unmap(); }
+
+    bool MappedCheckpoint::contains(std::string_view name) const
+    {
+        return std::ranges::find(m_header.blocks, name, &CheckpointBlock::name) != m_header.blocks.end();
+    }
+
+    std::span<const std::byte> MappedCheckpoint::block(std::string_view name, std::size_t element_size) const
+    {
+        auto block = std::ranges::find(m_header.blocks, name, &CheckpointBlock::name);
+        if (block == m_header.blocks.end()) {
+            throw CheckpointError{"The checkpoint has no field " + std::string{name} + "."};
+        }
+        if (block->element_size != element_size) {
+            throw CheckpointError{"The field " + std::string{name} + " holds values of another type."};
+        }
+        auto blocks = std::span{m_data, m_size}.subspan(m_blocks_offset);
+        return blocks.subspan(block->offset, block->bytes);
+    }
+
+    void MappedCheckpoint::unmap() noexcept
+    {
+        if (m_data == nullptr) { return; }
+#if defined(_WIN32)
+        UnmapViewOfFile(m_data);
+#else
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * @file   cpu_features.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.25
+ *
+ * @brief  Runtime detection of the vector instruction sets of the CPU.
+ */
+
+#include "core/cpu_features.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <array>
+#include <intrin.h>
+#endif
+
+namespace mysh::core {
+
+    namespace detail {
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        constexpr int osxsave_bit = 27;
+        constexpr int avx2_bit = 5;
+        constexpr int avx512f_bit = 16;
+        // the OS has to save the ymm (and for AVX-512 also the opmask and zmm) registers on context switches.
+        constexpr unsigned long long ymm_state = 0x6;
+        constexpr unsigned long long zmm_state = 0xe6;
+
+        SimdLevel detect_simd_level()
+        {
+            std::array<int, 4> info{};
+            __cpuid(info.data(), 0);
+            if (info[0] < 7) { return SimdLevel::Scalar; }
+            __cpuid(info.data(), 1);
+            if ((info[2] & (1 << osxsave_bit)) == 0) { return SimdLevel::Scalar; }
+            const auto xcr0 = _xgetbv(0);
+            __cpuidex(info.data(), 7, 0);
+            if ((info[1] & (1 << avx512f_bit)) != 0 && (xcr0 & zmm_state) == zmm_state) { return SimdLevel::AVX512; }
+            if ((info[1] & (1 << avx2_bit)) != 0 && (xcr0 & ymm_state) == ymm_state) { return SimdLevel::AVX2; }
+            return SimdLevel::Scalar;
+        }
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        SimdLevel detect_simd_level()
+        {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) { return SimdLevel::AVX512; }
+            if (__builtin_cpu_supports("avx2")) { return SimdLevel::AVX2; }
+            return SimdLevel::Scalar;
+        }
+#else
+        SimdLevel detect_simd_level() { return SimdLevel::Scalar; }
+#endif
+    }
+
+    SimdLevel simd_level()
+    {
+        static const SimdLevel level = detail::detect_simd_level();
+        return level;
+    }
+}
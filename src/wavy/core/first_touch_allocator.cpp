@@ -0,0 +1,56 @@
+/**
+ * @file   first_touch_allocator.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.02
+ *
+ * @brief  Allocator for fields whose pages are placed by the threads that first write them.
+ */
+
+#include "core/first_touch_allocator.h"
+
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace mysh::core::detail {
+
+    namespace {
+        constexpr std::size_t huge_page_size = std::size_t{2} * 1024 * 1024;
+
+        bool use_huge_pages([[maybe_unused]] std::size_t bytes, [[maybe_unused]] bool huge_pages)
+        {
+#if defined(__linux__)
+            return huge_pages && bytes >= huge_page_size;
+#else
+            // large pages on windows need a privilege the solver usually does not have.
+            return false;
+#endif
+        }
+    }
+
+    void* allocate_pages(std::size_t bytes, std::size_t alignment, [[maybe_unused]] bool huge_pages)
+    {
+#if defined(__linux__)
+        if (use_huge_pages(bytes, huge_pages)) {
+            const auto size = (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+            void* ptr = std::aligned_alloc(huge_page_size, size); // NOLINT(cppcoreguidelines-no-malloc)
+            if (ptr == nullptr) { throw std::bad_alloc{}; }
+            // only a hint, without transparent huge pages the memory is backed by normal pages.
+            madvise(ptr, size, MADV_HUGEPAGE);
+            return ptr;
+        }
+#endif
+        return ::operator new(bytes, std::align_val_t{alignment});
+    }
+
+    void deallocate_pages(void* ptr, std::size_t bytes, std::size_t alignment, bool huge_pages) noexcept
+    {
+        if (use_huge_pages(bytes, huge_pages)) {
+            std::free(ptr); // NOLINT(cppcoreguidelines-no-malloc)
+            return;
+        }
+        ::operator delete(ptr, bytes, std::align_val_t{alignment});
+    }
+}
@@ -0,0 +1,311 @@
+/**
+ * @file   frame_writer.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.06
+ *
+ * @brief  Streams simulation frames to a file from a background thread.
+ */
+
+#include "core/frame_writer.h"
+
+#include <lz4.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace mysh::core {
+
+    namespace {
+        constexpr std::array<char, 8> frame_magic{'W', 'A', 'V', 'Y', 'F', 'R', 'M', 'S'};
+        constexpr std::array<char, 8> index_magic{'W', 'A', 'V', 'Y', 'I', 'N', 'D', 'X'};
+        constexpr std::uint32_t byte_order_mark = 0x01020304;
+
+        enum class Codec : std::uint32_t
+        {
+            Raw,
+            LZ4
+        };
+
+        struct Preamble
+        {
+            std::array<char, 8> magic = frame_magic;
+            std::uint32_t format_version = frame_format_version;
+            std::uint32_t byte_order = byte_order_mark;
+        };
+
+        struct ChunkHeader
+        {
+            double time = 0.0;
+            std::uint64_t field_count = 0;
+        };
+
+        /** Followed by the name and the stored bytes of the field. */
+        struct FieldHeader
+        {
+            std::uint32_t name_length = 0;
+            std::uint32_t element_size = 0;
+            Codec codec = Codec::Raw;
+            std::uint32_t reserved = 0;
+            std::uint64_t bytes = 0;
+            std::uint64_t stored_bytes = 0;
+        };
+
+        struct IndexEntry
+        {
+            std::uint64_t offset = 0;
+            double time = 0.0;
+        };
+
+        /** The last bytes of a file, written when the writer is closed. */
+        struct Trailer
+        {
+            std::uint64_t index_offset = 0;
+            std::uint64_t frame_count = 0;
+            std::array<char, 8> magic = index_magic;
+        };
+
+        /** lz4 works on int sizes, larger fields are stored raw. */
+        constexpr std::size_t max_compressed_field = LZ4_MAX_INPUT_SIZE;
+
+        template<typename T>
+        void write_values(std::ofstream& file, const T* data, std::size_t count)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+        }
+
+        template<typename T>
+        void read_values(std::ifstream& file, T* data, std::size_t count)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            file.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+            if (!file) { throw FrameFileError{"The frame file is truncated."}; }
+        }
+    }
+
+    FrameWriter::FrameWriter(const std::filesystem::path& path, const FrameWriterSettings& settings)
+        : m_settings{settings}
+        , m_file{path, std::ios::binary | std::ios::trunc}
+        , m_free{&m_buffers[0], &m_buffers[1]}
+    {
+        const Preamble preamble;
+        write_values(m_file, &preamble, 1);
+        if (!m_file) { throw FrameFileError{"Could not open frame file " + path.string() + "."}; }
+        m_thread = std::thread{[this]() { run(); }};
+    }
+
+    FrameWriter::~FrameWriter()
+    {
+        try {
+            close();
+        } catch (const std::exception& e) {
+            spdlog::error("Writing frames failed: {}", e.what());
+        }
+    }
+
+    void FrameWriter::write_frame(double time, std::span<const FrameField> fields)
+    {
+        Buffer* buffer = nullptr;
+        {
+            std::unique_lock lock{m_mutex};
+            if (m_error) { std::rethrow_exception(m_error); }
+            if (!m_thread.joinable()) { throw FrameFileError{"The frame writer is closed."}; }
+            m_buffer_freed.wait(lock, [this]() { return !m_free.empty(); });
+            buffer = m_free.front();
+            m_free.pop_front();
+        }
+
+        // the buffers keep their capacity, so after the first frames no memory is allocated here.
+        buffer->time = time;
+        buffer->fields.clear();
+        std::size_t bytes = 0;
+        for (const auto& field : fields) {
+            buffer->fields.push_back({std::string{field.name}, field.element_size, bytes, field.bytes.size()});
+            bytes += field.bytes.size();
+        }
+        buffer->data.resize(bytes);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            std::ranges::copy(fields[i].bytes,
+                              buffer->data.begin() + static_cast<std::ptrdiff_t>(buffer->fields[i].offset));
+        }
+
+        {
+            const std::scoped_lock lock{m_mutex};
+            m_queued.push_back(buffer);
+        }
+        m_buffer_queued.notify_one();
+        m_frame_count += 1;
+    }
+
+    void FrameWriter::close()
+    {
+        if (!m_thread.joinable()) { return; }
+        {
+            const std::scoped_lock lock{m_mutex};
+            m_closing = true;
+        }
+        m_buffer_queued.notify_one();
+        m_thread.join();
+
+        if (!m_error) {
+            try {
+                write_index();
+            } catch (...) {
+                m_error = std::current_exception();
+            }
+        }
+        m_file.close();
+        if (m_error) { std::rethrow_exception(m_error); }
+    }
+
+    void FrameWriter::run()
+    {
+        while (true) {
+            Buffer* buffer = nullptr;
+            bool failed = false;
+            {
+                std::unique_lock lock{m_mutex};
+                m_buffer_queued.wait(lock, [this]() { return !m_queued.empty() || m_closing; });
+                if (m_queued.empty()) { return; }
+                buffer = m_queued.front();
+                failed = static_cast<bool>(m_error);
+            }
+
+            // after an error the frames are dropped, so the simulation is not blocked.
+            if (!failed) {
+                try {
+                    write_buffer(*buffer);
+                } catch (...) {
+                    const std::scoped_lock lock{m_mutex};
+                    m_error = std::current_exception();
+                }
+            }
+
+            {
+                const std::scoped_lock lock{m_mutex};
+                m_queued.pop_front();
+                m_free.push_back(buffer);
+            }
+            m_buffer_freed.notify_one();
+        }
+    }
+
+    void FrameWriter::write_buffer(Buffer& buffer)
+    {
+        m_index.emplace_back(static_cast<std::uint64_t>(m_file.tellp()), buffer.time);
+        const ChunkHeader chunk{buffer.time, buffer.fields.size()};
+        write_values(m_file, &chunk, 1);
+
+        for (const auto& field : buffer.fields) {
+            auto data = std::span{buffer.data}.subspan(field.offset, field.bytes);
+            FieldHeader header{static_cast<std::uint32_t>(field.name.size()), field.element_size, Codec::Raw, 0,
+                               field.bytes, field.bytes};
+
+            if (m_settings.compress && field.bytes > 0 && field.bytes <= max_compressed_field) {
+                const auto source_size = static_cast<int>(field.bytes);
+                buffer.compressed.resize(static_cast<std::size_t>(LZ4_compressBound(source_size)));
+                // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+                const auto compressed_size = LZ4_compress_default(
+                    reinterpret_cast<const char*>(data.data()), reinterpret_cast<char*>(buffer.compressed.data()),
+                    source_size, static_cast<int>(buffer.compressed.size()));
+                // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+                // incompressible fields are stored raw, so reading them costs nothing extra.
+                if (compressed_size > 0 && static_cast<std::size_t>(compressed_size) < field.bytes) {
+                    header.codec = Codec::LZ4;
+                    header.stored_bytes = static_cast<std::size_t>(compressed_size);
+                    data = std::span{buffer.compressed}.first(header.stored_bytes);
+                }
+            }
+
+            write_values(m_file, &header, 1);
+            write_values(m_file, field.name.data(), field.name.size());
+            write_values(m_file, data.data(), data.size());
+        }
+        if (!m_file) { throw FrameFileError{"Could not write a frame."}; }
+    }
+
+    void FrameWriter::write_index()
+    {
+        Trailer trailer;
+        trailer.index_offset = static_cast<std::uint64_t>(m_file.tellp());
+        trailer.frame_count = m_index.size();
+        for (const auto& [offset, time] : m_index) {
+            const IndexEntry entry{offset, time};
+            write_values(m_file, &entry, 1);
+        }
+        write_values(m_file, &trailer, 1);
+        m_file.flush();
+        if (!m_file) { throw FrameFileError{"Could not write the frame index."}; }
+    }
+
+    const std::vector<std::byte>& Frame::field_bytes(std::string_view name, std::size_t element_size) const
+    {
+        auto field = std::ranges::find(names, name);
+        if (field == names.end()) { throw FrameFileError{"The frame has no field " + std::string{name} + "."}; }
+        const auto index = static_cast<std::size_t>(field - names.begin());
+        if (element_sizes[index] != element_size) {
+            throw FrameFileError{"The field " + std::string{name} + " holds values of another type."};
+        }
+        return data[index];
+    }
+
+    FrameReader::FrameReader(const std::filesystem::path& path) : m_file{path, std::ios::binary}
+    {
+        if (!m_file) { throw FrameFileError{"Could not open frame file " + path.string() + "."}; }
+        Preamble preamble;
+        read_values(m_file, &preamble, 1);
+        if (preamble.magic != frame_magic || preamble.format_version != frame_format_version
+            || preamble.byte_order != byte_order_mark) {
+            throw FrameFileError{path.string() + " is not a frame file of this version."};
+        }
+
+        // a file without index was not closed, e.g. because the simulation crashed.
+        Trailer trailer;
+        m_file.seekg(-static_cast<std::streamoff>(sizeof(Trailer)), std::ios::end);
+        read_values(m_file, &trailer, 1);
+        if (trailer.magic != index_magic) { throw FrameFileError{path.string() + " has no frame index."}; }
+
+        std::vector<IndexEntry> entries(trailer.frame_count);
+        m_file.seekg(static_cast<std::streamoff>(trailer.index_offset));
+        read_values(m_file, entries.data(), entries.size());
+        m_index.reserve(entries.size());
+        for (const auto& entry : entries) { m_index.emplace_back(entry.offset, entry.time); }
+    }
+
+    Frame FrameReader::read_frame(std::size_t frame)
+    {
+        m_file.seekg(static_cast<std::streamoff>(m_index.at(frame).first));
+        ChunkHeader chunk;
+        read_values(m_file, &chunk, 1);
+
+        Frame result;
+        result.time = chunk.time;
+        std::vector<std::byte> compressed;
+        for (std::uint64_t i = 0; i < chunk.field_count; ++i) {
+            FieldHeader header;
+            read_values(m_file, &header, 1);
+            auto& name = result.names.emplace_back(header.name_length, '\0');
+            read_values(m_file, name.data(), name.size());
+            result.element_sizes.push_back(header.element_size);
+            auto& data = result.data.emplace_back(header.bytes);
+
+            if (header.codec == Codec::Raw) {
+                read_values(m_file, data.data(), data.size());
+                continue;
+            }
+            compressed.resize(header.stored_bytes);
+            read_values(m_file, compressed.data(), compressed.size());
+            // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+            const auto size = LZ4_decompress_safe(reinterpret_cast<const char*>(compressed.data()),
+                                                  reinterpret_cast<char*>(data.data()),
+                                                  static_cast<int>(compressed.size()), static_cast<int>(data.size()));
+            // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+            if (size < 0 || static_cast<std::size_t>(size) != data.size()) {
+                throw FrameFileError{"The field " + name + " is corrupt."};
+            }
+        }
+        return result;
+    }
+}
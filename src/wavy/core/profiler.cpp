@@ -0,0 +1,67 @@
+/**
+ * @file   profiler.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.08
+ *
+ * @brief  Scoped timers for the stages of a solver with statistics per frame.
+ */
+
+#include "core/profiler.h"
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+
+namespace mysh::core {
+
+    Profiler::Profiler(std::vector<std::string_view> stage_names)
+        : m_samples(stage_names.size())
+        , m_statistics(stage_names.size())
+    {
+        for (std::size_t stage = 0; stage < stage_names.size(); ++stage) {
+            m_statistics[stage].name = stage_names[stage];
+        }
+    }
+
+    std::span<const StageStatistics> Profiler::endFrame()
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::nanoseconds;
+        for (std::size_t stage = 0; stage < m_samples.size(); ++stage) {
+            auto& samples = m_samples[stage];
+            auto& statistics = m_statistics[stage];
+            statistics = {statistics.name};
+            if (samples.empty()) { continue; }
+
+            statistics.count = samples.size();
+            statistics.total = duration_cast<nanoseconds>(std::accumulate(samples.begin(), samples.end(),
+                                                                          clock::duration::zero()));
+            statistics.min = duration_cast<nanoseconds>(*std::ranges::min_element(samples));
+            statistics.mean = statistics.total / static_cast<std::int64_t>(samples.size());
+            // nearest rank, the samples are cleared afterwards so they can be reordered.
+            const auto rank = (samples.size() * 99 + 99) / 100 - 1;
+            std::ranges::nth_element(samples, samples.begin() + static_cast<std::ptrdiff_t>(rank));
+            statistics.p99 = duration_cast<nanoseconds>(samples[rank]);
+            samples.clear();
+        }
+        return m_statistics;
+    }
+
+    std::string format_stage_statistics(std::span<const StageStatistics> statistics)
+    {
+        using microseconds = std::chrono::duration<double, std::micro>;
+        std::string result = fmt::format("{:<24} {:>8} {:>12} {:>12} {:>12} {:>12}", "stage", "count", "total [us]",
+                                         "min [us]", "mean [us]", "p99 [us]");
+        for (const auto& stage : statistics) {
+            if (stage.count == 0) { continue; }
+            fmt::format_to(std::back_inserter(result), "\n{:<24} {:>8} {:>12.1%Q} {:>12.1%Q} {:>12.1%Q} {:>12.1%Q}",
+                           stage.name, stage.count, microseconds{stage.total}, microseconds{stage.min},
+                           microseconds{stage.mean}, microseconds{stage.p99});
+        }
+        return result;
+    }
+}
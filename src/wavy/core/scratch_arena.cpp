@@ -0,0 +1,78 @@
+/**
+ * @file   scratch_arena.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.03
+ *
+ * @brief  Memory resource that carves the scratch fields of a solver from one aligned block.
+ */
+
+#include "core/scratch_arena.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace mysh::core {
+
+    ScratchArena::ScratchArena(std::size_t capacity, std::size_t alignment, std::pmr::memory_resource* upstream)
+        : m_upstream{upstream}
+        , m_capacity{footprint(capacity, alignment)}
+        , m_alignment{alignment}
+        , m_block{m_capacity == 0 ? nullptr : static_cast<std::byte*>(upstream->allocate(m_capacity, alignment))}
+    {
+    }
+
+    ScratchArena::~ScratchArena()
+    {
+        for (const auto& overflow : m_overflow) {
+            m_upstream->deallocate(overflow.ptr, overflow.bytes, overflow.alignment);
+        }
+        if (m_block != nullptr) { m_upstream->deallocate(m_block, m_capacity, m_alignment); }
+    }
+
+    void ScratchArena::rewind(Marker marker)
+    {
+        assert(marker <= m_offset);
+        m_offset = marker;
+    }
+
+    void ScratchArena::reset()
+    {
+        // the upstream blocks may still be owned by containers, they are only given back by do_deallocate.
+        m_offset = 0;
+    }
+
+    void* ScratchArena::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        alignment = std::max(alignment, m_alignment);
+        // the block itself is aligned to m_alignment, larger alignments are rare enough to round the offset.
+        const auto first = footprint(m_offset, alignment);
+        if (first + bytes <= m_capacity && m_block != nullptr) {
+            m_offset = footprint(first + bytes, m_alignment);
+            return m_block + first;
+        }
+
+        auto* ptr = m_upstream->allocate(bytes, alignment);
+        m_overflow.push_back({ptr, bytes, alignment});
+        m_overflow_bytes += bytes;
+        return ptr;
+    }
+
+    void ScratchArena::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+    {
+        auto* data = static_cast<std::byte*>(ptr);
+        if (m_block != nullptr && data >= m_block && data < m_block + m_capacity) {
+            // only the last allocation can be given back, everything else waits for rewind or reset.
+            const auto first = static_cast<std::size_t>(data - m_block);
+            if (footprint(first + bytes, m_alignment) == m_offset) { m_offset = first; }
+            return;
+        }
+
+        auto overflow = std::ranges::find(m_overflow, ptr, &Overflow::ptr);
+        assert(overflow != m_overflow.end());
+        m_upstream->deallocate(ptr, bytes, std::max(alignment, m_alignment));
+        m_overflow_bytes -= overflow->bytes;
+        m_overflow.erase(overflow);
+    }
+
+    bool ScratchArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept { return this == &other; }
+}
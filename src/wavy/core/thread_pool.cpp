@@ -0,0 +1,205 @@
+/**
+ * @file   thread_pool.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.01
+ *
+ * @brief  Persistent worker threads with work stealing parallel loops.
+ */
+
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace mysh::core {
+
+    namespace detail {
+
+        /** Set while a thread runs a loop body, nested loops then run inline. */
+        thread_local bool inside_loop = false; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+        /** Marks the thread as running a loop body until the scope ends, also when the body throws. */
+        class LoopScope
+        {
+        public:
+            LoopScope() : m_nested{std::exchange(inside_loop, true)} {}
+            LoopScope(const LoopScope&) = delete;
+            LoopScope& operator=(const LoopScope&) = delete;
+            LoopScope(LoopScope&&) = delete;
+            LoopScope& operator=(LoopScope&&) = delete;
+            ~LoopScope() { inside_loop = m_nested; }
+
+        private:
+            bool m_nested;
+        };
+
+        std::size_t hardware_threads() { return std::max(std::size_t{1}, std::size_t{std::thread::hardware_concurrency()}); }
+
+        void pin_thread(std::thread& thread, std::size_t cpu)
+        {
+#if defined(_WIN32)
+            SetThreadAffinityMask(thread.native_handle(), DWORD_PTR{1} << (cpu % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu % CPU_SETSIZE, &cpus);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+#else
+            static_cast<void>(thread);
+            static_cast<void>(cpu);
+#endif
+        }
+    }
+
+    ThreadPool::ThreadPool(const ThreadPoolSettings& settings)
+    {
+        const auto threads = settings.threads == 0 ? detail::hardware_threads() : settings.threads;
+        m_queues = std::make_unique<ChunkQueue[]>(threads); // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        m_workers.reserve(threads - 1);
+        for (std::size_t worker = 0; worker + 1 < threads; ++worker) {
+            m_workers.emplace_back([this, worker] { workerLoop(worker + 1); });
+            if (settings.pin_threads) {
+                detail::pin_thread(m_workers.back(), (settings.first_cpu + worker + 1) % detail::hardware_threads());
+            }
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            const std::scoped_lock lock{m_wake_mutex};
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& worker : m_workers) { worker.join(); }
+    }
+
+    ThreadPool& ThreadPool::global()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ThreadPool::run(std::size_t first, std::size_t last, std::size_t grain_size, RangeFunction fn)
+    {
+        if (first >= last) { return; }
+        grain_size = std::max(grain_size, std::size_t{1});
+        const auto chunks = (last - first + grain_size - 1) / grain_size;
+        if (chunks == 1 || m_workers.empty() || detail::inside_loop) {
+            const detail::LoopScope scope;
+            for (auto chunk_first = first; chunk_first < last; chunk_first += grain_size) {
+                fn(chunk_first, std::min(chunk_first + grain_size, last));
+            }
+            return;
+        }
+
+        const std::scoped_lock run_lock{m_run_mutex};
+        // every thread starts with a contiguous share of the chunks, so neighboring chunks stay on one core.
+        const auto participants = thread_count();
+        for (std::size_t participant = 0; participant < participants; ++participant) {
+            const std::scoped_lock lock{m_queues[participant].mutex};
+            m_queues[participant].begin = chunks * participant / participants;
+            m_queues[participant].end = chunks * (participant + 1) / participants;
+        }
+        m_fn = fn;
+        m_first = first;
+        m_last = last;
+        m_grain_size = grain_size;
+        m_busy_workers.store(m_workers.size());
+        {
+            const std::scoped_lock lock{m_wake_mutex};
+            m_generation += 1;
+        }
+        m_wake.notify_all();
+
+        work(0);
+        // the workers may still run their last chunk, the loop data has to stay valid until they are done.
+        for (auto busy = m_busy_workers.load(); busy != 0; busy = m_busy_workers.load()) { m_busy_workers.wait(busy); }
+        if (m_exception) { std::rethrow_exception(std::exchange(m_exception, nullptr)); }
+    }
+
+    void ThreadPool::workerLoop(std::size_t worker)
+    {
+        std::uint64_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock{m_wake_mutex};
+                m_wake.wait(lock, [this, seen_generation] { return m_stop || m_generation != seen_generation; });
+                if (m_stop) { return; }
+                seen_generation = m_generation;
+            }
+            work(worker);
+            if (m_busy_workers.fetch_sub(1) == 1) { m_busy_workers.notify_all(); }
+        }
+    }
+
+    void ThreadPool::work(std::size_t participant)
+    {
+        const detail::LoopScope scope;
+        std::size_t chunk = 0;
+        while (popChunk(participant, chunk) || stealChunks(participant, chunk)) {
+            const auto chunk_first = m_first + chunk * m_grain_size;
+            try {
+                m_fn(chunk_first, std::min(chunk_first + m_grain_size, m_last));
+            } catch (...) {
+                cancel(std::current_exception());
+                return;
+            }
+        }
+    }
+
+    void ThreadPool::cancel(std::exception_ptr exception)
+    {
+        {
+            const std::scoped_lock lock{m_exception_mutex};
+            if (!m_exception) { m_exception = std::move(exception); }
+        }
+        for (std::size_t participant = 0; participant < thread_count(); ++participant) {
+            const std::scoped_lock lock{m_queues[participant].mutex};
+            m_queues[participant].begin = m_queues[participant].end;
+        }
+    }
+
+    bool ThreadPool::popChunk(std::size_t participant, std::size_t& chunk)
+    {
+        auto& queue = m_queues[participant];
+        const std::scoped_lock lock{queue.mutex};
+        if (queue.begin == queue.end) { return false; }
+        chunk = queue.begin++;
+        return true;
+    }
+
+    bool ThreadPool::stealChunks(std::size_t participant, std::size_t& chunk)
+    {
+        const auto participants = thread_count();
+        for (std::size_t offset = 1; offset < participants; ++offset) {
+            auto& victim = m_queues[(participant + offset) % participants];
+            std::size_t stolen_begin = 0;
+            std::size_t stolen_end = 0;
+            {
+                const std::scoped_lock lock{victim.mutex};
+                if (victim.begin == victim.end) { continue; }
+                // take the upper half, the victim keeps working on the chunks next to its current one.
+                stolen_begin = victim.begin + (victim.end - victim.begin) / 2;
+                stolen_end = victim.end;
+                victim.end = stolen_begin;
+            }
+            chunk = stolen_begin;
+            auto& own = m_queues[participant];
+            const std::scoped_lock lock{own.mutex};
+            own.begin = stolen_begin + 1;
+            own.end = stolen_end;
+            return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * @file   ensemble.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.07
+ *
+ * @brief  Runs many independent 1d simulations, e.g. parameter sweeps, in parallel.
+ */
+
+#include "ensemble.h"
+
+#include <cassert>
+
+namespace wavy
+{
+    Ensemble::Ensemble(const EnsembleSettings& settings, std::vector<EnsembleMember> members,
+                       mysh::core::ThreadPool& pool)
+        : m_settings{settings}
+        , m_members{std::move(members)}
+        , m_pool{&pool}
+    {
+        assert(m_settings.labels.empty() || m_settings.labels.size() == m_settings.grid_size);
+    }
+
+    std::vector<EnsembleResult> Ensemble::run(std::size_t frame_count, float delta_t_frame, FrameObserver observer)
+    {
+        std::vector<EnsembleResult> results(m_members.size());
+        // a grain of one member, the loop body is the whole simulation of a member.
+        m_pool->parallel_for(0, m_members.size(), 1, [&](std::size_t first, std::size_t last) {
+            for (auto index = first; index < last; ++index) {
+                const auto& member = m_members[index];
+                // constructed inside the loop body, so the first touch of the fields runs inline on this worker.
+                FluidSolver1D solver{m_settings.grid_size, member.delta_x, member.g, member.density,
+                                     m_settings.pressure, m_settings.advection, m_settings.memory};
+                // the solver forwards the pool to its pressure solver, all their loops run inline on this worker.
+                solver.setThreadPool(*m_pool);
+                if (!m_settings.labels.empty()) { solver.setLabels(m_settings.labels); }
+
+                auto& result = results[index];
+                for (std::size_t frame = 0; frame < frame_count; ++frame) {
+                    solver.solveNextStep(delta_t_frame);
+                    result.substeps += solver.lastSubsteps();
+                    if (observer) { observer(index, frame, solver); }
+                }
+                result.time = solver.time();
+                result.last_pressure_solve = solver.lastPressureSolve();
+            }
+        });
+        return results;
+    }
+}
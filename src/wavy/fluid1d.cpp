@@ -7,13 +7,14 @@
  */
 
 #include "fluid1d.h"
-#include "utils/enumerate.h"
-#include "utils/zip.h"
+#include "solver/vector_ops.h"
 
 #include <glm/glm.hpp>
 #include <glm/ext/scalar_common.hpp>
+#include <spdlog/spdlog.h>
+#include <cassert>
+#include <cmath>
 #include <numeric>
-#include <execution>
 #include <ranges>
 
 namespace wavy
@@ -44,171 +45,389 @@ namespace wavy
             T val;
             T increase;
         };
+
+        /** Ghost cells on each side of padded fields, enough for the cubic interpolation stencil. */
+        constexpr std::size_t ghost_cells = 2;
+
+        /** Positions advected by one task, a multiple of all vector widths. */
+        constexpr std::size_t advection_batch_size = 4096;
+
+        /** Cells handled by one task of the cheap per cell stages, a multiple of the cells in a label word. */
+        constexpr std::size_t grain_size = 4096;
+
+        /** The stages timed by the profiler of the solver. */
+        enum ProfileStage : std::size_t
+        {
+            stage_solve_next_step,
+            stage_estimate_advection_delta_t,
+            stage_estimate_body_forces_delta_t,
+            stage_estimate_project_delta_t,
+            stage_advect,
+            stage_body_forces,
+            stage_project,
+            stage_assemble,
+            stage_setup_A,
+            stage_pressure_solve,
+            stage_pressure_update
+        };
+
+        std::vector<std::string_view> profile_stage_names()
+        {
+            return {"solveNextStep",  "estimateAdvectionDeltaT", "estimateBodyForcesDeltaT", "estimateProjectDeltaT",
+                    "advect",         "bodyForces",              "project",                  "assemble",
+                    "setup_A",        "pressure solve",          "pressure_update"};
+        }
+
+        /** Names the solver in its checkpoints. */
+        constexpr std::string_view checkpoint_kind = "wavy::FluidSolver1D";
+
+        /** Views storage of padded_size(n, ghost_cells) elements as a padded field of n elements. */
+        utils::padded_span<float> padded(std::span<float> storage)
+        {
+            return utils::padded_span<float>{storage, ghost_cells};
+        }
+
+        std::span<const float> content(std::span<const float> storage)
+        {
+            return utils::padded_span<const float>{storage, ghost_cells}.get_content();
+        }
+
+        solver::PressureSolver1D make_pressure_solver(std::size_t grid_size, const solver::PressureSolverSettings& settings,
+                                                      std::pmr::memory_resource* scratch)
+        {
+            using enum solver::PressureSolverMethod;
+            switch (settings.method) {
+            case PCG: return solver::PCGSolver<1>{grid_size, settings.pcg, scratch};
+            case Tridiagonal: return solver::TridiagonalSolver{grid_size, settings.tridiagonal, scratch};
+            case Multigrid: return solver::MultigridSolver{grid_size, settings.multigrid, settings.pcg, scratch};
+            }
+            return solver::TridiagonalSolver{grid_size, settings.tridiagonal, scratch};
+        }
     }
 
-    FluidSolver1D::FluidSolver1D(std::size_t grid_size, float delta_x, float g, float density) // NOLINT(bugprone-easily-swappable-parameters)
-        : FluidSolverBase{grid_size,
-                          [](const std::span<Label>&, [[maybe_unused]] std::size_t idx) {
-                              return Label::SOLID;
-                          }}
+    FluidSolver1D::FluidSolver1D(std::size_t grid_size, float delta_x, float g, float density, // NOLINT(bugprone-easily-swappable-parameters)
+                                 const solver::PressureSolverSettings& pressure_settings,
+                                 const kernels::AdvectionSettings& advection_settings,
+                                 const mysh::core::FirstTouchSettings& memory_settings)
+        : FluidSolverBase{{grid_size}, Label::SOLID}
         , m_delta_x{delta_x}
         , m_g{g}
         , m_density{density}
         , m_position(grid_size, 0.0f)
-        , m_p(grid_size, 0.0f)
-        , m_u_n0(grid_size + 1, 0.0f)
-        , m_u_A(grid_size + 1, 0.0f)
-        , m_u_B(grid_size + 1, 0.0f)
-        , m_u_n1(grid_size + 1, 0.0f)
-        , m_rhs(grid_size, 0.0f)
-        , m_A_diag(grid_size, 0.0f)
-        , m_A_x(grid_size, 0.0f)
+        , m_cells(grid_size, CellFields::allocator_type{memory_settings.huge_pages})
+        , m_u(utils::padded_size(grid_size + 1, detail::ghost_cells), Field::allocator_type{memory_settings.huge_pages})
+        , m_advection{advection_settings}
+        , m_scratch{solver::scratch_bytes(grid_size, pressure_settings)}
+        , m_pressure_solver{detail::make_pressure_solver(grid_size, pressure_settings, &m_scratch)}
+        , m_profiler{detail::profile_stage_names()}
     {
         std::iota(std::begin(m_position), std::end(m_position), detail::iota_step<float>(0.0f, m_delta_x));
+        // the fields are still untouched, they are written with the chunks of the stages that use them.
+        auto [p, rhs, A_diag, A_x] = m_cells.channels<Pressure, Rhs, ADiag, AX>();
+        for (auto field : {p, rhs, A_diag, A_x}) {
+            mysh::core::first_touch(threadPool(), field, 0.0f, detail::grain_size, memory_settings);
+        }
+        for (std::size_t buffer = 0; buffer < m_u.buffer_count(); ++buffer) {
+            mysh::core::first_touch(threadPool(), std::span<float>{m_u.next(buffer)}, 0.0f, detail::advection_batch_size,
+                                    memory_settings);
+        }
+    }
+
+    FluidSolver1D::FluidSolver1D(const mysh::core::MappedCheckpoint& checkpoint,
+                                 const solver::PressureSolverSettings& pressure_settings,
+                                 const kernels::AdvectionSettings& advection_settings,
+                                 const mysh::core::FirstTouchSettings& memory_settings)
+        : FluidSolver1D{checkpointParameters(checkpoint), checkpoint, pressure_settings, advection_settings,
+                        memory_settings}
+    {
+    }
+
+    FluidSolver1D::FluidSolver1D(const CheckpointParameters& parameters, const mysh::core::MappedCheckpoint& checkpoint,
+                                 const solver::PressureSolverSettings& pressure_settings,
+                                 const kernels::AdvectionSettings& advection_settings,
+                                 const mysh::core::FirstTouchSettings& memory_settings)
+        : FluidSolver1D{parameters.grid_size, parameters.delta_x, parameters.g, parameters.density, pressure_settings,
+                        advection_settings, memory_settings}
+    {
+        auto labels = checkpoint.field<Label>("labels");
+        auto u_checkpoint = checkpoint.field<float>("velocity");
+        auto p_checkpoint = checkpoint.field<float>("pressure");
+        auto u = detail::padded(m_u.current()).get_content();
+        auto p = m_cells.channel<Pressure>();
+        if (labels.size() != labels_data().size() || u_checkpoint.size() != u.size()
+            || p_checkpoint.size() != p.size()) {
+            throw mysh::core::CheckpointError{"The checkpoint fields do not match the grid size."};
+        }
+
+        tn0 = parameters.time;
+        std::ranges::copy(labels, labels_data().begin());
+        labelsChanged();
+        // the mapped pages are read by the threads that first touched the fields.
+        auto copy_chunks = [&pool = threadPool()](std::span<const float> source, std::span<float> target) {
+            auto copy_chunk = [source, target](std::size_t first, std::size_t last) {
+                std::ranges::copy(source.subspan(first, last - first), target.subspan(first).begin());
+            };
+            pool.parallel_for(0, target.size(), detail::grain_size, copy_chunk);
+        };
+        copy_chunks(u_checkpoint, u);
+        copy_chunks(p_checkpoint, p);
+    }
+
+    FluidSolver1D::CheckpointParameters
+    FluidSolver1D::checkpointParameters(const mysh::core::MappedCheckpoint& checkpoint)
+    {
+        if (checkpoint.kind() != detail::checkpoint_kind) {
+            throw mysh::core::CheckpointError{"The checkpoint was written by " + checkpoint.kind() + "."};
+        }
+        return checkpoint.parameters<CheckpointParameters>();
+    }
+
+    mysh::core::Checkpoint FluidSolver1D::checkpoint() const
+    {
+        mysh::core::Checkpoint checkpoint{std::string{detail::checkpoint_kind}};
+        checkpoint.set_parameters(CheckpointParameters{labels_data().size(), m_delta_x, m_g, m_density, tn0});
+        checkpoint.add_field("labels", std::span<const Label>{labels_data()});
+        checkpoint.add_field("velocity", velocity());
+        checkpoint.add_field("pressure", m_cells.channel<Pressure>());
+        return checkpoint;
+    }
+
+    void FluidSolver1D::writeFrame(mysh::core::FrameWriter& writer) const
+    {
+        writer.write_frame(tn0, {mysh::core::frame_field("labels", std::span<const Label>{labels_data()}),
+                                 mysh::core::frame_field("velocity", velocity()),
+                                 mysh::core::frame_field("pressure", m_cells.channel<Pressure>())});
+    }
+
+    void FluidSolver1D::setLabels(std::span<const CellLabel> labels)
+    {
+        assert(labels.size() == labels_data().size());
+        std::copy(std::begin(labels), std::end(labels), std::begin(labels_data()));
+        labelsChanged();
     }
 
     void FluidSolver1D::solveNextStep(float delta_t_frame)
     {
-        bool continue_simulation = true;
-        while (continue_simulation) {
-            // determine deltaT
-            auto delta_t = glm::min(estimateAdvectionDeltaT(), estimateBodyForcesDeltaT(), estimateProjectDeltaT());
-            delta_t = std::max(delta_t, delta_t_frame / 3.0f);
-            if (delta_t > delta_t_frame) {
-                delta_t = delta_t_frame;
-                continue_simulation = false;
-            }
+        auto solid_velocity = []([[maybe_unused]] std::size_t idx) { return 0.0f; };
+        m_substeps = 0;
+        if (!std::isfinite(delta_t_frame) || delta_t_frame <= 0.0f) { return; }
 
-            advect(delta_t, m_u_n0, m_u_A);
-            bodyForces(delta_t, m_u_A, m_u_B);
-            // project(deltaT, m_u_B, m_un1);
+        std::size_t pressure_iterations = 0;
+        {
+            WAVY_PROFILE_SCOPE(m_profiler, detail::stage_solve_next_step);
+            float t = 0.0f;
+            bool frame_finished = false;
+            while (!frame_finished) {
+                const auto substep = next_substep(
+                    t, glm::min(estimateAdvectionDeltaT(), estimateBodyForcesDeltaT(), estimateProjectDeltaT()),
+                    delta_t_frame);
+                const auto delta_t = substep.delta_t;
+                frame_finished = substep.last;
 
-            // auto enumerator = utils::enumerate(m_indices_data);
-            // std::for_each(std::execution::par, std::begin(enumerator), std::end(enumerator), []([[maybe_unused]] const auto& v) {});
-            // auto zipper = utils::zip(m_indices_data, m_p, m_u_A);
-            // auto zipper2 = zipper;
-            // std::for_each(std::execution::par, std::begin(zipper), std::end(zipper),
-            //               []([[maybe_unused]] const auto& v) {});
+                auto u_n1 = detail::padded(m_u.next()).get_content();
+                advect(delta_t, detail::padded(m_u.current()), u_n1, m_g);
+                project(delta_t, u_n1, u_n1, mysh::core::function_view<float(std::size_t)>{solid_velocity});
+                // the new state becomes the current one, only the buffer index changes.
+                m_u.rotate();
+
+                t += delta_t;
+                tn0 += delta_t;
+                m_substeps += 1;
+                pressure_iterations += m_pressure_result.iterations;
+            }
+        }
+
+        if constexpr (mysh::core::profiling_enabled) {
+            spdlog::info("Frame at t = {:.4f} s: {} substeps, {} pressure solver iterations.\n{}", tn0, m_substeps,
+                         pressure_iterations, mysh::core::format_stage_statistics(m_profiler.endFrame()));
         }
     }
 
-    void FluidSolver1D::advect(float delta_t, const std::vector<float>& qn0, std::vector<float>& qn1) const
+    void FluidSolver1D::advect(float delta_t, utils::padded_span<float> qn0, std::span<float> qn1, float acceleration)
     {
-        auto zipped_data = utils::zip(m_position, qn1);
-        std::for_each(std::execution::par, std::begin(zipped_data), std::end(zipped_data),
-                      [this, &qn0, delta_t](auto zipped_element) {
-                          auto xG = std::get<0>(zipped_element);
-                          auto xP = integrate(
-                              utils::boundary_span<const float>{m_u_n0,
-                                                                [](const std::span<const float>& u, std::size_t idx) {
-                                                                    return u[glm::clamp(idx, 0ULL, u.size())];
-                                                                }},
-                              xG, delta_t);
-                          std::get<1>(zipped_element) = interpolate(
-                              utils::boundary_span<const float>{qn0,
-                                                                [](std::span<const float> q, std::size_t idx) {
-                                                                    return q[glm::clamp(idx, 0ULL, q.size())];
-                                                                }},
-                              xP);
-                      });
+        WAVY_PROFILE_SCOPE(m_profiler, detail::stage_advect);
+        // only the ghost cells are written, the fields are read in place.
+        auto velocity = detail::padded(m_u.current());
+        velocity.fill_ghost_cells(utils::boundary::clamp{});
+        if (qn0.get_storage().data() != velocity.get_storage().data()) { qn0.fill_ghost_cells(utils::boundary::clamp{}); }
+        const kernels::AdvectionFields fields{&velocity[0], velocity.size(), &qn0[0], qn0.size(),
+                                              m_delta_x,    delta_t,         delta_t * acceleration};
+
+        threadPool().parallel_for(0, qn1.size(), detail::advection_batch_size,
+                                  [this, &fields, qn1](std::size_t first, std::size_t last) {
+                                      m_advection(fields, first, last - first, &qn1[first]);
+                                  });
     }
 
-    void FluidSolver1D::bodyForces(float delta_t, const std::vector<float>& qn0, std::vector<float>& qn1) const // NOLINT(readability-convert-member-functions-to-static)
+    void FluidSolver1D::bodyForces(float delta_t, std::span<const float> qn0, std::span<float> qn1) const
     {
-        auto zipped_data = utils::zip(qn0, qn1);
-        std::for_each(std::execution::par, std::begin(zipped_data), std::end(zipped_data),
-                      [delta_t](auto zipped_element) {
-                          constexpr float gravityOfEarth = 9.81f;
-                          std::get<1>(zipped_element) = std::get<0>(zipped_element) + delta_t * gravityOfEarth;
-                      });
+        WAVY_PROFILE_SCOPE(m_profiler, detail::stage_body_forces);
+        threadPool().parallel_for(0, qn1.size(), detail::grain_size,
+                                  [this, delta_t, qn0, qn1](std::size_t first, std::size_t last) {
+                                      for (auto i = first; i < last; ++i) { qn1[i] = qn0[i] + delta_t * m_g; }
+                                  });
     }
 
-    void FluidSolver1D::project([[maybe_unused]] float delta_t, const std::vector<float>& qn0,
-                                [[maybe_unused]] std::vector<float>& qn1,
+    void FluidSolver1D::project(float delta_t, std::span<const float> qn0, std::span<float> qn1,
                                 mysh::core::function_view<float(std::size_t idx)> u_solid)
     {
-        presure_gradient_rhs(qn0, m_rhs, u_solid);
+        WAVY_PROFILE_SCOPE(m_profiler, detail::stage_project);
+        auto [p, rhs, A_diag, A_x] = m_cells.channels<Pressure, Rhs, ADiag, AX>();
+        std::visit([this](auto& pressure_solver) { pressure_solver.setThreadPool(threadPool()); }, m_pressure_solver);
+        if (m_A_generation == labelGeneration() && m_A_delta_t == delta_t) {
+            WAVY_PROFILE_SCOPE(m_profiler, detail::stage_assemble);
+            assemble<true, false>(delta_t, qn0, rhs, {}, {}, u_solid);
+        } else {
+            WAVY_PROFILE_SCOPE(m_profiler, detail::stage_assemble);
+            assemble<true, true>(delta_t, qn0, rhs, A_diag, A_x, u_solid);
+            if (auto* multigrid = std::get_if<solver::MultigridSolver>(&m_pressure_solver)) {
+                multigrid->setup(labels_data(), delta_t / (m_density * m_delta_x * m_delta_x));
+            }
+            m_A_generation = labelGeneration();
+            m_A_delta_t = delta_t;
+        }
+        const auto A = pressureMatrix();
+        {
+            WAVY_PROFILE_SCOPE(m_profiler, detail::stage_pressure_solve);
+            m_pressure_result = std::visit(
+                [&A, rhs, p](auto& pressure_solver) { return pressure_solver.solve(A, rhs, p); }, m_pressure_solver);
+        }
+        pressure_update(delta_t, qn0, qn1, u_solid);
+    }
+
+    std::span<const float> FluidSolver1D::velocity() const
+    {
+        return detail::content(m_u.current());
     }
 
     float FluidSolver1D::estimateAdvectionDeltaT() const
     {
+        WAVY_PROFILE_SCOPE(m_profiler, detail::stage_estimate_advection_delta_t);
         constexpr float estimation_factor = 5.0f;
-        auto maxu = std::reduce(std::execution::par, std::begin(m_u_n0), std::end(m_u_n0), 0.0f,
-                                [](float v0, float v1) { return std::max(v0, v1); });
-        auto umax = maxu + glm::sqrt(estimation_factor * m_delta_x * m_g);
+        auto umax = solver::max_abs(threadPool(), velocity()) + glm::sqrt(estimation_factor * m_delta_x * glm::abs(m_g));
         return (estimation_factor * m_delta_x) / umax;
     }
 
     float FluidSolver1D::estimateBodyForcesDeltaT() const // NOLINT(readability-convert-member-functions-to-static)
     {
+        WAVY_PROFILE_SCOPE(m_profiler, detail::stage_estimate_body_forces_delta_t);
         return 1.0f;
     }
 
     float FluidSolver1D::estimateProjectDeltaT() const // NOLINT(readability-convert-member-functions-to-static)
     {
+        WAVY_PROFILE_SCOPE(m_profiler, detail::stage_estimate_project_delta_t);
         return 1.0f;
     }
 
-    void FluidSolver1D::presure_gradient_rhs(const std::vector<float>& u, std::vector<float>& rhs,
+    void FluidSolver1D::presure_gradient_rhs(std::span<const float> u, std::span<float> rhs,
                                              mysh::core::function_view<float(std::size_t idx)> u_solid) const
     {
-        auto enumerated_data = utils::enumerate(rhs);
-        auto scale = 1.0f / m_delta_x;
-        std::for_each(std::execution::par, std::begin(enumerated_data), std::end(enumerated_data),
-                      [this, &u, &u_solid, scale](auto enum_element) {
-                          auto index = std::get<0>(enum_element);
-                          auto& result = std::get<1>(enum_element);
-                          if (labels()[index] != FluidSolverBase::Label::FLUID) { return; }
-                          result = -scale * (u[index + 1] - u[index]);
-                          if (labels()[index - 1] == FluidSolverBase::Label::SOLID) {
-                              result -= scale * (u[index] - u_solid(index));
-                          }
-                          if (labels()[index + 1] == FluidSolverBase::Label::SOLID) {
-                              result += scale * (u[index + 1] - u_solid(index + 1));
-                          }
-                      });
+        assemble<true, false>(0.0f, u, rhs, {}, {}, u_solid);
     }
 
     void FluidSolver1D::setup_A(float delta_t)
     {
-        auto zipped_data = utils::zip(utils::enumerate(m_A_diag), m_A_x);
-
-        auto scale = delta_t / (m_density * m_delta_x * m_delta_x);
-        std::for_each(std::execution::par, std::begin(zipped_data), std::end(zipped_data),
-                      [this, scale](auto zipped_element) {
-                          auto index = std::get<0>(std::get<0>(zipped_element));
-                          auto& A_diag = std::get<1>(std::get<0>(zipped_element));
-                          auto& A_x = std::get<1>(zipped_element);
-                          A_diag = 0.0f;
-                          A_x = 0.0f;
-                          if (labels()[index] != FluidSolverBase::Label::FLUID) { return; }
-                          if (labels()[index - 1] == FluidSolverBase::Label::FLUID) { A_diag += scale; }
-                          if (labels()[index + 1] == FluidSolverBase::Label::FLUID) {
-                              A_diag += scale;
-                              A_x = -scale;
-                          } else if (labels()[index + 1] == FluidSolverBase::Label::EMPTY) {
-                              A_diag += scale;
-                          }
-                      });
+        WAVY_PROFILE_SCOPE(m_profiler, detail::stage_setup_A);
+        auto [A_diag, A_x] = m_cells.channels<ADiag, AX>();
+        assemble<false, true>(delta_t, {}, {}, A_diag, A_x, {});
+        // the multigrid hierarchy was not set up for this matrix.
+        m_A_generation = no_generation;
     }
 
-    float FluidSolver1D::toPosition(std::size_t index) const
+    solver::PoissonStencil<1> FluidSolver1D::pressureMatrix() const
     {
-        return m_delta_x * static_cast<float>(index);
+        auto [A_diag, A_x] = m_cells.channels<ADiag, AX>();
+        return {A_diag, {A_x}, {1}};
     }
 
-    std::size_t FluidSolver1D::toGrid(float position) const
+    std::span<const float> FluidSolver1D::pressureRhs() const
     {
-        return static_cast<std::size_t>(position / m_delta_x);
+        return m_cells.channel<Rhs>();
     }
 
-    float FluidSolver1D::interpolate(const utils::boundary_span<const float>& q, float x_P) const
+    template<bool with_rhs, bool with_A>
+    void FluidSolver1D::assemble(float delta_t, std::span<const float> u, std::span<float> rhs,
+                                 std::span<float> A_diag, std::span<float> A_x,
+                                 mysh::core::function_view<float(std::size_t idx)> u_solid) const
     {
-        return FluidSolverBase::Interpolate(q, x_P, m_delta_x);
+        // the labels of 32 cells and their neighbors are loaded once for both outputs, each cell then only tests bits.
+        const auto cell_count = packed_labels().size();
+        auto rhs_scale = 1.0f / m_delta_x;
+        auto A_scale = delta_t / (m_density * m_delta_x * m_delta_x);
+        auto assemble_word = [this, u, rhs, A_diag, A_x, &u_solid, cell_count, rhs_scale, A_scale](std::size_t first) {
+            const auto& labels = packed_labels();
+            const auto cell = static_cast<std::ptrdiff_t>(first);
+            const auto fluid = labels.mask(Label::FLUID, cell, boundaryLabel());
+            const auto solid_left = labels.mask(Label::SOLID, cell - 1, boundaryLabel());
+            const auto fluid_right = labels.mask(Label::FLUID, cell + 1, boundaryLabel());
+            const auto empty_right = labels.mask(Label::EMPTY, cell + 1, boundaryLabel());
+            // there are only three labels, so a neighbor that is neither fluid nor empty is solid.
+            const auto solid_right = ~(fluid_right | empty_right);
+            const auto count = std::min(PackedLabels::cells_per_word, cell_count - first);
+            for (std::size_t lane = 0; lane < count; ++lane) {
+                const auto index = first + lane;
+                auto bit = [lane](std::uint32_t mask) { return (mask >> lane) & 1U; };
+                if constexpr (with_A) {
+                    // branch free: every open neighbor adds to the diagonal, fluid neighbors couple.
+                    const auto fluid_scale = static_cast<float>(bit(fluid)) * A_scale;
+                    A_diag[index] = fluid_scale * static_cast<float>(2U - bit(solid_left) - bit(solid_right));
+                    A_x[index] = -fluid_scale * static_cast<float>(bit(fluid_right));
+                }
+                if constexpr (with_rhs) {
+                    auto& result = rhs[index];
+                    result = 0.0f;
+                    if (bit(fluid) == 0) { continue; }
+                    result = -rhs_scale * (u[index + 1] - u[index]);
+                    if (bit(solid_left) != 0) { result -= rhs_scale * (u[index] - u_solid(index)); }
+                    if (bit(solid_right) != 0) { result += rhs_scale * (u[index + 1] - u_solid(index + 1)); }
+                }
+            }
+        };
+        threadPool().parallel_for(0, cell_count, detail::grain_size,
+                                  [&assemble_word](std::size_t first, std::size_t last) {
+                                      for (auto word = first; word < last; word += PackedLabels::cells_per_word) {
+                                          assemble_word(word);
+                                      }
+                                  });
     }
 
-    float FluidSolver1D::integrate(const utils::boundary_span<const float>& f, float q, float delta_t) const
+    void FluidSolver1D::pressure_update(float delta_t, std::span<const float> qn0, std::span<float> qn1,
+                                        mysh::core::function_view<float(std::size_t idx)> u_solid) const
     {
-        return FluidSolverBase::Integrate(f, q, delta_t, m_delta_x);
+        WAVY_PROFILE_SCOPE(m_profiler, detail::stage_pressure_update);
+        // face i lies between the cells i - 1 and i.
+        auto scale = delta_t / (m_density * m_delta_x);
+        auto p = m_cells.channel<Pressure>();
+        auto update_faces = [this, qn0, qn1, p, &u_solid, scale](std::size_t first, std::size_t last) {
+            for (auto index = first; index < last; ++index) {
+                auto& result = qn1[index];
+                auto label_left = labels()[index - 1];
+                auto label_right = labels()[index];
+                result = qn0[index];
+                if (label_left != FluidSolverBase::Label::FLUID && label_right != FluidSolverBase::Label::FLUID) {
+                    continue;
+                }
+                if (label_left == FluidSolverBase::Label::SOLID || label_right == FluidSolverBase::Label::SOLID) {
+                    result = u_solid(index);
+                    continue;
+                }
+                // pressure in empty cells is zero.
+                auto p_left = label_left == FluidSolverBase::Label::FLUID ? p[index - 1] : 0.0f;
+                auto p_right = label_right == FluidSolverBase::Label::FLUID ? p[index] : 0.0f;
+                result -= scale * (p_right - p_left);
+            }
+        };
+        threadPool().parallel_for(0, qn1.size(), detail::grain_size, update_faces);
+    }
+
+    float FluidSolver1D::toPosition(std::size_t index) const
+    {
+        return m_delta_x * static_cast<float>(index);
+    }
+
+    std::size_t FluidSolver1D::toGrid(float position) const
+    {
+        return static_cast<std::size_t>(position / m_delta_x);
     }
 }
@@ -0,0 +1,26 @@
+/**
+ * @file   fluid2d.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.28
+ *
+ * @brief  Fluid solver for 2d fluids on a staggered (MAC) grid.
+ */
+
+#include "fluid2d.h"
+
+namespace wavy
+{
+    namespace detail
+    {
+        /** Cells handled by one task: a few rows of 128 cells, so the stencils of a task stay in the L1/L2 cache. */
+        constexpr std::array<std::size_t, 2> tile_extent = {128, 16};
+    }
+
+    FluidSolver2D::FluidSolver2D(std::size_t size_x, std::size_t size_y, float delta_x, float g, float density, // NOLINT(bugprone-easily-swappable-parameters)
+                                 const solver::PCGSettings& pressure_settings,
+                                 const kernels::AdvectionSettings& advection_settings)
+        : MacFluidSolver{{size_x, size_y}, delta_x, g, density, pressure_settings, advection_settings,
+                         detail::tile_extent}
+    {
+    }
+}
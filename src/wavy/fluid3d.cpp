@@ -0,0 +1,77 @@
+/**
+ * @file   fluid3d.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.29
+ *
+ * @brief  Fluid solver for 3d fluids on a staggered (MAC) grid.
+ */
+
+#include "fluid3d.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace wavy
+{
+    namespace detail
+    {
+        /** Cells and faces handled by one task, 8^3 floats are 2 KiB per field, so a brick stays in the L1 cache. */
+        constexpr std::array<std::size_t, 3> brick_extent = {8, 8, 8};
+    }
+
+    FluidSolver3D::FluidSolver3D(std::size_t size_x, std::size_t size_y, std::size_t size_z, float delta_x, float g, // NOLINT(bugprone-easily-swappable-parameters)
+                                 float density, const solver::PCGSettings& pressure_settings,
+                                 const kernels::AdvectionSettings& advection_settings)
+        : MacFluidSolver{{size_x, size_y, size_z}, delta_x, g, density, pressure_settings, advection_settings,
+                         detail::brick_extent}
+    {
+        updateActiveBricks();
+    }
+
+    void FluidSolver3D::setLabels(std::span<const CellLabel> labels)
+    {
+        MacFluidSolver::setLabels(labels);
+        updateActiveBricks();
+    }
+
+    void FluidSolver3D::updateActiveBricks()
+    {
+        auto update = [this](BrickSet& set, const Layout& layout, std::size_t dim,
+                             std::span<const std::span<float>> fields) {
+            std::vector<std::uint8_t> is_active(set.bricks.size(), 0);
+            threadPool().parallel_for(0, set.bricks.size(), 1, [this, &set, &layout, dim, fields, &is_active](
+                                                                   std::size_t first, std::size_t last) {
+                for (auto brick = first; brick < last; ++brick) {
+                    auto box = set.bricks.tile(brick);
+                    is_active[brick] = containsFluid(box, dim) ? 1 : 0;
+                    if (is_active[brick] != 0) { continue; }
+                    // the stages never write skipped bricks, so they are cleared once here.
+                    utils::for_each_cell(box, [&layout, fields](const Cell& cell) {
+                        auto index = layout.linear(cell);
+                        for (auto field : fields) { field[index] = 0.0f; }
+                    });
+                }
+            });
+            set.active.clear();
+            for (std::size_t brick = 0; brick < is_active.size(); ++brick) {
+                if (is_active[brick] != 0) { set.active.push_back(brick); }
+            }
+        };
+
+        update(cellBricks(), grid(), 3, cellFields());
+        for (std::size_t d = 0; d < 3; ++d) { update(faceBricks(d), faceLayout(d), d, faceFields(d)); }
+    }
+
+    bool FluidSolver3D::containsFluid(utils::grid_box<3> box, std::size_t dim) const
+    {
+        // a face brick also borders the cells below its first layer of faces.
+        if (dim < 3 && box.first[dim] > 0) { box.first[dim] -= 1; }
+        for (std::size_t d = 0; d < 3; ++d) { box.last[d] = std::min(box.last[d], grid().size(d)); }
+
+        bool result = false;
+        utils::for_each_cell(box, [this, &result](const Cell& cell) {
+            result = result || labels_data()[grid().linear(cell)] == Label::FLUID;
+        });
+        return result;
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * @file   advection.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.25
+ *
+ * @brief  Scalar advection kernel and selection of the vector kernels.
+ */
+
+#include "kernels/advection.h"
+#include "kernels/advection_kernel.inl"
+
+#include <algorithm>
+#include <cmath>
+
+namespace wavy::kernels
+{
+    namespace detail
+    {
+#ifdef WAVY_SIMD_KERNELS_X86
+        SemiLagrangianAdvection::BatchKernel avx2_kernel(const AdvectionSettings& settings);
+        SemiLagrangianAdvection::BatchKernel avx512_kernel(const AdvectionSettings& settings);
+#endif
+
+        namespace
+        {
+            struct scalar
+            {
+                static constexpr std::size_t width = 1;
+                using vec = float;
+
+                static float broadcast(float value) { return value; }
+                static float lanes() { return 0.0f; }
+                static float min(float lhs, float rhs) { return std::min(lhs, rhs); }
+                static float max(float lhs, float rhs) { return std::max(lhs, rhs); }
+                static float floor(float x) { return std::floor(x); }
+                static std::ptrdiff_t to_index(float x) { return static_cast<std::ptrdiff_t>(x); }
+                static float gather(const float* q, std::ptrdiff_t index, std::ptrdiff_t offset)
+                {
+                    return q[index + offset]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                }
+                static void store(float* result, float x) { *result = x; }
+            };
+        }
+
+        SemiLagrangianAdvection::BatchKernel batch_kernel(const AdvectionSettings& settings, mysh::core::SimdLevel level)
+        {
+            using enum mysh::core::SimdLevel;
+#ifdef WAVY_SIMD_KERNELS_X86
+            if (level == AVX512) { return avx512_kernel(settings); }
+            if (level == AVX2) { return avx2_kernel(settings); }
+#endif
+            return select_kernel<scalar>(settings);
+        }
+
+        mysh::core::SimdLevel available_level(mysh::core::SimdLevel max_level)
+        {
+#ifdef WAVY_SIMD_KERNELS_X86
+            return std::min(max_level, mysh::core::simd_level());
+#else
+            return mysh::core::SimdLevel::Scalar;
+#endif
+        }
+    }
+
+    SemiLagrangianAdvection::SemiLagrangianAdvection(const AdvectionSettings& settings, mysh::core::SimdLevel max_level)
+        : m_settings{settings}
+        , m_level{detail::available_level(max_level)}
+        , m_batch_kernel{detail::batch_kernel(m_settings, m_level)}
+        , m_scalar_kernel{detail::select_kernel<detail::scalar>(m_settings)}
+    {
+    }
+
+    void SemiLagrangianAdvection::operator()(const AdvectionFields& fields, std::size_t first, std::size_t count,
+                                             float* result) const
+    {
+        auto done = m_batch_kernel(fields, first, count, result);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        m_scalar_kernel(fields, first + done, count - done, result + done);
+    }
+}
@@ -0,0 +1,52 @@
+/**
+ * @file   advection_avx2.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.25
+ *
+ * @brief  AVX2 advection kernel processing 8 positions per iteration (compiled with AVX2 enabled).
+ */
+
+#if defined(__AVX2__)
+
+#include "kernels/advection_kernel.inl"
+
+#include <immintrin.h>
+
+namespace wavy::kernels::detail
+{
+    namespace
+    {
+        struct avx2
+        {
+            static constexpr std::size_t width = 8;
+
+            struct vec
+            {
+                __m256 v;
+
+                friend vec operator+(vec lhs, vec rhs) { return {_mm256_add_ps(lhs.v, rhs.v)}; }
+                friend vec operator-(vec lhs, vec rhs) { return {_mm256_sub_ps(lhs.v, rhs.v)}; }
+                friend vec operator*(vec lhs, vec rhs) { return {_mm256_mul_ps(lhs.v, rhs.v)}; }
+            };
+
+            static vec broadcast(float value) { return {_mm256_set1_ps(value)}; }
+            static vec lanes() { return {_mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)}; }
+            static vec min(vec lhs, vec rhs) { return {_mm256_min_ps(lhs.v, rhs.v)}; }
+            static vec max(vec lhs, vec rhs) { return {_mm256_max_ps(lhs.v, rhs.v)}; }
+            static vec floor(vec x) { return {_mm256_floor_ps(x.v)}; }
+            static __m256i to_index(vec x) { return _mm256_cvttps_epi32(x.v); }
+            static vec gather(const float* q, __m256i index, int offset)
+            {
+                return {_mm256_i32gather_ps(q + offset, index, sizeof(float))}; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            }
+            static void store(float* result, vec x) { _mm256_storeu_ps(result, x.v); }
+        };
+    }
+
+    SemiLagrangianAdvection::BatchKernel avx2_kernel(const AdvectionSettings& settings)
+    {
+        return select_kernel<avx2>(settings);
+    }
+}
+
+#endif
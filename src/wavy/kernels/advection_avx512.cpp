@@ -0,0 +1,61 @@
+/**
+ * @file   advection_avx512.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.25
+ *
+ * @brief  AVX-512 advection kernel processing 16 positions per iteration (compiled with AVX-512F enabled).
+ */
+
+#if defined(__AVX512F__)
+
+#include "kernels/advection_kernel.inl"
+
+#include <immintrin.h>
+
+// GCC 12 warns about the intentionally undefined pass-through operands inside the AVX-512 intrinsics (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace wavy::kernels::detail
+{
+    namespace
+    {
+        struct avx512
+        {
+            static constexpr std::size_t width = 16;
+
+            struct vec
+            {
+                __m512 v;
+
+                friend vec operator+(vec lhs, vec rhs) { return {_mm512_add_ps(lhs.v, rhs.v)}; }
+                friend vec operator-(vec lhs, vec rhs) { return {_mm512_sub_ps(lhs.v, rhs.v)}; }
+                friend vec operator*(vec lhs, vec rhs) { return {_mm512_mul_ps(lhs.v, rhs.v)}; }
+            };
+
+            static vec broadcast(float value) { return {_mm512_set1_ps(value)}; }
+            static vec lanes()
+            {
+                return {_mm512_set_ps(15.0f, 14.0f, 13.0f, 12.0f, 11.0f, 10.0f, 9.0f, 8.0f, 7.0f, 6.0f, 5.0f, 4.0f, 3.0f,
+                                      2.0f, 1.0f, 0.0f)};
+            }
+            static vec min(vec lhs, vec rhs) { return {_mm512_min_ps(lhs.v, rhs.v)}; }
+            static vec max(vec lhs, vec rhs) { return {_mm512_max_ps(lhs.v, rhs.v)}; }
+            static vec floor(vec x) { return {_mm512_roundscale_ps(x.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)}; }
+            static __m512i to_index(vec x) { return _mm512_cvttps_epi32(x.v); }
+            static vec gather(const float* q, __m512i index, int offset)
+            {
+                return {_mm512_i32gather_ps(index, q + offset, sizeof(float))}; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            }
+            static void store(float* result, vec x) { _mm512_storeu_ps(result, x.v); }
+        };
+    }
+
+    SemiLagrangianAdvection::BatchKernel avx512_kernel(const AdvectionSettings& settings)
+    {
+        return select_kernel<avx512>(settings);
+    }
+}
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file   advection_kernel.inl
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.25
+ *
+ * @brief  Semi-Lagrangian advection written once against a vector abstraction.
+ *
+ * Included by the per instruction set translation units. Each of them defines its own vector type in an anonymous
+ * namespace, so the instantiations never collide between units compiled with different flags. The vector type
+ * provides width, vec (with +, -, *), broadcast, lanes, min, max, floor, to_index, gather and store.
+ */
+
+#pragma once
+
+#include "app_constants.h"
+#include "kernels/advection.h"
+
+#include <cstddef>
+
+namespace wavy::kernels::detail
+{
+    // some constants used for Runge Kutta integration and cubic interpolation.
+    constexpr float rk_one_sixth = 1.0f / 6.0f;
+    constexpr float rk_one_nineth = 1.0f / 9.0f;
+    constexpr float rk_three_fourth = 0.75f;
+
+    /**
+     *  Coordinates are relative to the first position of a batch, so they stay exact floats and 32 bit offsets on
+     *  any grid size. Positions traced back further than this are clamped, far beyond any stable time step.
+     */
+    constexpr std::ptrdiff_t max_trace_cells = std::ptrdiff_t{1} << 24;
+
+    namespace
+    {
+        /** Used instead of std::min, whose out of line copies would be shared with units built for other CPUs. */
+        constexpr std::ptrdiff_t min_offset(std::ptrdiff_t lhs, std::ptrdiff_t rhs) { return lhs < rhs ? lhs : rhs; }
+    }
+
+    /** The clamping range [min, max] of a field of size values seen from the position base. */
+    template<typename Simd>
+    struct relative_range
+    {
+        relative_range(std::size_t size, std::size_t base)
+            : min{Simd::broadcast(-static_cast<float>(min_offset(static_cast<std::ptrdiff_t>(base), max_trace_cells)))}
+            , max{Simd::broadcast(static_cast<float>(
+                  min_offset(static_cast<std::ptrdiff_t>(size - 1) - static_cast<std::ptrdiff_t>(base), max_trace_cells)))}
+        {
+        }
+
+        typename Simd::vec min;
+        typename Simd::vec max;
+    };
+
+    /** Samples q at coordinates x relative to q, clamped to the range of the field. */
+    template<typename Simd, InterpolationMethod interpolation>
+    inline typename Simd::vec sample(const float* q, const relative_range<Simd>& range, typename Simd::vec x)
+    {
+        using vec = typename Simd::vec;
+        x = Simd::min(Simd::max(x, range.min), range.max);
+        const vec xi_f = Simd::floor(x);
+        const vec s = x - xi_f;
+        const auto xi = Simd::to_index(xi_f);
+        if constexpr (interpolation == InterpolationMethod::Linear) {
+            const vec q0 = Simd::gather(q, xi, 0);
+            const vec q1 = Simd::gather(q, xi, 1);
+            return q0 + s * (q1 - q0);
+        } else {
+            const vec half = Simd::broadcast(0.5f);
+            const vec s2 = s * s;
+            const vec s3 = s2 * s;
+            const vec w_1 = Simd::broadcast(-1.0f / 3.0f) * s + half * s2 - Simd::broadcast(rk_one_sixth) * s3;
+            const vec w0 = Simd::broadcast(1.0f) - s2 + half * (s3 - s);
+            const vec w1 = s + half * (s2 - s3);
+            const vec w2 = Simd::broadcast(rk_one_sixth) * (s3 - s);
+            return w_1 * Simd::gather(q, xi, -1) + w0 * Simd::gather(q, xi, 0) + w1 * Simd::gather(q, xi, 1)
+                   + w2 * Simd::gather(q, xi, 2);
+        }
+    }
+
+    /** Traces grid coordinates x back by one time step, step = delta_t / delta_x. */
+    template<typename Simd, IntegrationMethod integration, typename Velocity>
+    inline typename Simd::vec trace_back(const Velocity& u, typename Simd::vec x, typename Simd::vec step)
+    {
+        using vec = typename Simd::vec;
+        const vec half = Simd::broadcast(0.5f);
+        if constexpr (integration == IntegrationMethod::RK2) {
+            const vec mid = x - half * step * u(x);
+            return x - step * u(mid);
+        } else if constexpr (integration == IntegrationMethod::RK3) {
+            const vec k1 = u(x);
+            const vec k2 = u(x - half * step * k1);
+            const vec k3 = u(x - Simd::broadcast(rk_three_fourth) * step * k2);
+            return x - step * Simd::broadcast(rk_one_nineth)
+                           * (Simd::broadcast(2.0f) * k1 + Simd::broadcast(3.0f) * k2 + Simd::broadcast(4.0f) * k3);
+        } else {
+            const vec k1 = u(x);
+            const vec k2 = u(x - half * step * k1);
+            const vec k3 = u(x - half * step * k2);
+            const vec k4 = u(x - step * k3);
+            const vec two = Simd::broadcast(2.0f);
+            return x - step * Simd::broadcast(rk_one_sixth) * (k1 + two * k2 + two * k3 + k4);
+        }
+    }
+
+    /** Advects all full batches of count positions and returns how many positions were written. */
+    template<typename Simd, InterpolationMethod interpolation, IntegrationMethod integration>
+    std::size_t advect(const AdvectionFields& fields, std::size_t first, std::size_t count, float* result)
+    {
+        using vec = typename Simd::vec;
+        // the velocity is sampled in grid coordinates, so the step is in cells per velocity unit.
+        const vec step = Simd::broadcast(fields.delta_t / fields.delta_x);
+        const vec source = Simd::broadcast(fields.source);
+
+        const std::size_t batched = count - count % Simd::width;
+        for (std::size_t i = 0; i < batched; i += Simd::width) {
+            // only the displacement is traced in floats, the batch start stays an integer offset of the fields.
+            const auto base = first + i;
+            const relative_range<Simd> velocity_range{fields.velocity_size, base};
+            const relative_range<Simd> quantity_range{fields.quantity_size, base};
+            // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            const float* velocity_base = fields.velocity + base;
+            auto velocity = [velocity_base, &velocity_range](vec x) {
+                return sample<Simd, interpolation>(velocity_base, velocity_range, x);
+            };
+            const vec x = trace_back<Simd, integration>(velocity, Simd::lanes(), step);
+            Simd::store(result + i,
+                        sample<Simd, interpolation>(fields.quantity + base, quantity_range, x) + source);
+            // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        return batched;
+    }
+
+    template<typename Simd, InterpolationMethod interpolation>
+    SemiLagrangianAdvection::BatchKernel select_kernel(IntegrationMethod integration)
+    {
+        using enum IntegrationMethod;
+        switch (integration) {
+        case RK2: return &advect<Simd, interpolation, RK2>;
+        case RK3: return &advect<Simd, interpolation, RK3>;
+        case RK4: return &advect<Simd, interpolation, RK4>;
+        }
+        return &advect<Simd, interpolation, RK2>;
+    }
+
+    /** Returns the kernel specialized for the given schemes. */
+    template<typename Simd>
+    SemiLagrangianAdvection::BatchKernel select_kernel(const AdvectionSettings& settings)
+    {
+        using enum InterpolationMethod;
+        switch (settings.interpolation) {
+        case Linear: return select_kernel<Simd, Linear>(settings.integration);
+        case Cubic: return select_kernel<Simd, Cubic>(settings.integration);
+        }
+        return select_kernel<Simd, Linear>(settings.integration);
+    }
+}
@@ -0,0 +1,337 @@
+/**
+ * @file   mac_solver.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.10
+ *
+ * @brief  The stages of the fluid solvers on staggered (MAC) grids, shared by the 2d and 3d solver.
+ */
+
+#include "mac_solver.h"
+#include "solver/vector_ops.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/scalar_common.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace wavy
+{
+    namespace detail
+    {
+        /** Values handled by one task of the per element stages. */
+        constexpr std::size_t mac_grain_size = 4096;
+
+        /** The layouts of the faces orthogonal to each axis, one face more than cells along that axis. */
+        template<std::size_t D>
+        std::array<utils::grid_layout<D>, D> face_layouts(const std::array<std::size_t, D>& cells)
+        {
+            return [&cells]<std::size_t... I>(std::index_sequence<I...>) {
+                auto grown = [&cells](std::size_t dim) {
+                    auto sizes = cells;
+                    sizes[dim] += 1;
+                    return sizes;
+                };
+                return std::array<utils::grid_layout<D>, D>{utils::grid_layout<D>{grown(I)}...};
+            }(std::make_index_sequence<D>{});
+        }
+    }
+
+    template<std::size_t D, typename Iteration>
+    MacFluidSolver<D, Iteration>::MacFluidSolver(const Cell& grid_size, float delta_x, float g, float density, // NOLINT(bugprone-easily-swappable-parameters)
+                                                 const solver::PCGSettings& pressure_settings,
+                                                 const kernels::AdvectionSettings& advection_settings,
+                                                 const Cell& tile_extent)
+        : Base{grid_size, Label::SOLID}
+        , m_delta_x{delta_x}
+        , m_g{g}
+        , m_density{density}
+        , m_face_layouts{detail::face_layouts<D>(grid_size)}
+        , m_iteration{grid(), m_face_layouts, tile_extent}
+        , m_velocity{[this]<std::size_t... I>(std::index_sequence<I...>) {
+            return std::array<utils::field_ring<float, 2>, D>{
+                utils::field_ring<float, 2>{m_face_layouts[I].cell_count(), 0.0f}...};
+        }(std::make_index_sequence<D>{})}
+        , m_advection{selectAdvection(advection_settings)}
+        , m_p(grid().cell_count(), 0.0f)
+        , m_rhs(grid().cell_count(), 0.0f)
+        , m_A_diag(grid().cell_count(), 0.0f)
+        , m_scratch{solver::PCGSolver<D>::scratch_bytes(grid().cell_count())}
+        , m_pressure_solver{grid().cell_count(), pressure_settings, &m_scratch}
+    {
+        for (auto& coupling : m_A_plus) { coupling.assign(grid().cell_count(), 0.0f); }
+    }
+
+    template<std::size_t D, typename Iteration>
+    void MacFluidSolver<D, Iteration>::setLabels(std::span<const CellLabel> labels)
+    {
+        assert(labels.size() == labels_data().size());
+        std::copy(std::begin(labels), std::end(labels), std::begin(labels_data()));
+        labelsChanged();
+    }
+
+    template<std::size_t D, typename Iteration>
+    void MacFluidSolver<D, Iteration>::solveNextStep(float delta_t_frame)
+    {
+        m_substeps = 0;
+        if (!std::isfinite(delta_t_frame) || delta_t_frame <= 0.0f) { return; }
+
+        float t = 0.0f;
+        bool frame_finished = false;
+        while (!frame_finished) {
+            const auto substep = next_substep(
+                t, glm::min(estimateAdvectionDeltaT(), estimateBodyForcesDeltaT(), estimateProjectDeltaT()),
+                delta_t_frame);
+            const auto delta_t = substep.delta_t;
+            frame_finished = substep.last;
+
+            advect(delta_t, m_g);
+            VelocityBuffers next{};
+            for (std::size_t d = 0; d < D; ++d) { next[d] = m_velocity[d].next(); }
+            project(delta_t, next);
+            for (auto& component : m_velocity) { component.rotate(); }
+
+            t += delta_t;
+            tn0 += delta_t;
+            m_substeps += 1;
+        }
+    }
+
+    template<std::size_t D, typename Iteration>
+    std::array<std::span<float>, D + 3> MacFluidSolver<D, Iteration>::cellFields()
+    {
+        std::array<std::span<float>, D + 3> fields{m_p, m_rhs, m_A_diag};
+        for (std::size_t d = 0; d < D; ++d) { fields[d + 3] = m_A_plus[d]; }
+        return fields;
+    }
+
+    template<std::size_t D, typename Iteration>
+    std::array<std::span<float>, 2> MacFluidSolver<D, Iteration>::faceFields(std::size_t dim)
+    {
+        return {m_velocity[dim].current(), m_velocity[dim].next()};
+    }
+
+    template<std::size_t D, typename Iteration>
+    bool MacFluidSolver<D, Iteration>::bordersFluid(const Cell& face, std::size_t dim) const
+    {
+        return label(Neighbor(face, dim, -1)) == Label::FLUID || label(Neighbor(face, dim, 0)) == Label::FLUID;
+    }
+
+    template<std::size_t D, typename Iteration>
+    void MacFluidSolver<D, Iteration>::advect(float delta_t, float acceleration)
+    {
+        (this->*m_advection)(delta_t, acceleration);
+    }
+
+    template<std::size_t D, typename Iteration>
+    template<InterpolationMethod interpolation, IntegrationMethod integration>
+    void MacFluidSolver<D, Iteration>::advectWith(float delta_t, float acceleration)
+    {
+        // positions are in cells, cell c covers [c, c + 1). Component d is sampled in the coordinates of its faces.
+        VelocityView q0{};
+        for (std::size_t d = 0; d < D; ++d) { q0[d] = m_velocity[d].current(); }
+        auto to_faces = [](GridPosition x, std::size_t dim) {
+            for (std::size_t d = 0; d < D; ++d) {
+                if (d != dim) { x[d] -= 0.5f; }
+            }
+            return x;
+        };
+        auto velocity = [this, &q0, &to_faces](const GridPosition& x) {
+            GridPosition result{};
+            for (std::size_t d = 0; d < D; ++d) {
+                result[d] = Base::template SampleGrid<interpolation>(q0[d], m_face_layouts[d], to_faces(x, d));
+            }
+            return result;
+        };
+        const auto step = delta_t / m_delta_x;
+
+        for (std::size_t dim = 0; dim < D; ++dim) {
+            const std::span<float> q1 = m_velocity[dim].next();
+            const auto source = dim == 1 ? delta_t * acceleration : 0.0f;
+            m_iteration.forEachFace(threadPool(), dim, [this, &q0, q1, dim, step, source, &velocity,
+                                                        &to_faces](const Cell& face) {
+                auto& result = q1[m_face_layouts[dim].linear(face)];
+                if (!bordersFluid(face, dim)) {
+                    result = 0.0f;
+                    return;
+                }
+                GridPosition x{};
+                for (std::size_t d = 0; d < D; ++d) {
+                    x[d] = static_cast<float>(face[d]) + (d == dim ? 0.0f : 0.5f);
+                }
+                auto x_back = to_faces(Base::template TraceBack<integration>(velocity, x, step), dim);
+                result = Base::template SampleGrid<interpolation>(q0[dim], m_face_layouts[dim], x_back) + source;
+            });
+        }
+    }
+
+    template<std::size_t D, typename Iteration>
+    auto MacFluidSolver<D, Iteration>::selectAdvection(const kernels::AdvectionSettings& settings) -> AdvectionKernel
+    {
+        using enum InterpolationMethod;
+        using enum IntegrationMethod;
+        const bool cubic = settings.interpolation == Cubic;
+        switch (settings.integration) {
+        case RK2: return cubic ? &MacFluidSolver::advectWith<Cubic, RK2> : &MacFluidSolver::advectWith<Linear, RK2>;
+        case RK3: return cubic ? &MacFluidSolver::advectWith<Cubic, RK3> : &MacFluidSolver::advectWith<Linear, RK3>;
+        case RK4: return cubic ? &MacFluidSolver::advectWith<Cubic, RK4> : &MacFluidSolver::advectWith<Linear, RK4>;
+        }
+        return &MacFluidSolver::advectWith<Linear, RK2>;
+    }
+
+    template<std::size_t D, typename Iteration>
+    void MacFluidSolver<D, Iteration>::bodyForces(float delta_t, std::span<const float> vn0,
+                                                  std::span<float> vn1) const
+    {
+        threadPool().parallel_for(0, vn1.size(), detail::mac_grain_size,
+                                  [this, delta_t, vn0, vn1](std::size_t first, std::size_t last) {
+                                      for (auto i = first; i < last; ++i) { vn1[i] = vn0[i] + delta_t * m_g; }
+                                  });
+    }
+
+    template<std::size_t D, typename Iteration>
+    void MacFluidSolver<D, Iteration>::project(float delta_t, const VelocityBuffers& velocity)
+    {
+        VelocityView velocity_n0{};
+        std::array<std::span<float>, D + 1> A{m_A_diag};
+        for (std::size_t d = 0; d < D; ++d) {
+            velocity_n0[d] = velocity[d];
+            A[d + 1] = m_A_plus[d];
+        }
+        if (m_A_generation == labelGeneration() && m_A_delta_t == delta_t) {
+            assemble<true, false>(delta_t, velocity_n0, m_rhs, {});
+        } else {
+            assemble<true, true>(delta_t, velocity_n0, m_rhs, A);
+            m_A_generation = labelGeneration();
+            m_A_delta_t = delta_t;
+        }
+        m_pressure_solver.setThreadPool(threadPool());
+        m_pressure_result = m_pressure_solver.solve(pressureMatrix(), m_rhs, m_p);
+        pressure_update(delta_t, velocity);
+    }
+
+    template<std::size_t D, typename Iteration>
+    float MacFluidSolver<D, Iteration>::estimateAdvectionDeltaT() const
+    {
+        // CFL condition with the gravity wave speed added, so a fluid at rest still gets a finite step.
+        constexpr float estimation_factor = 5.0f;
+        auto& pool = threadPool();
+        float umax = 0.0f;
+        for (std::size_t d = 0; d < D; ++d) { umax = glm::max(umax, solver::max_abs(pool, velocity(d))); }
+        umax += glm::sqrt(estimation_factor * m_delta_x * glm::abs(m_g));
+        return (estimation_factor * m_delta_x) / umax;
+    }
+
+    template<std::size_t D, typename Iteration>
+    float MacFluidSolver<D, Iteration>::estimateBodyForcesDeltaT() const // NOLINT(readability-convert-member-functions-to-static)
+    {
+        return 1.0f;
+    }
+
+    template<std::size_t D, typename Iteration>
+    float MacFluidSolver<D, Iteration>::estimateProjectDeltaT() const // NOLINT(readability-convert-member-functions-to-static)
+    {
+        return 1.0f;
+    }
+
+    template<std::size_t D, typename Iteration>
+    void MacFluidSolver<D, Iteration>::presure_gradient_rhs(const VelocityView& velocity, std::span<float> rhs) const
+    {
+        assemble<true, false>(0.0f, velocity, rhs, {});
+    }
+
+    template<std::size_t D, typename Iteration>
+    void MacFluidSolver<D, Iteration>::setup_A(float delta_t)
+    {
+        std::array<std::span<float>, D + 1> A{m_A_diag};
+        for (std::size_t d = 0; d < D; ++d) { A[d + 1] = m_A_plus[d]; }
+        assemble<false, true>(delta_t, {}, {}, A);
+        m_A_generation = no_generation;
+    }
+
+    template<std::size_t D, typename Iteration>
+    solver::PoissonStencil<D> MacFluidSolver<D, Iteration>::pressureMatrix() const
+    {
+        std::array<std::span<const float>, D> plus{};
+        for (std::size_t d = 0; d < D; ++d) { plus[d] = m_A_plus[d]; }
+        return {m_A_diag, plus, grid().strides()};
+    }
+
+    template<std::size_t D, typename Iteration>
+    std::span<const float> MacFluidSolver<D, Iteration>::pressureRhs() const
+    {
+        return m_rhs;
+    }
+
+    template<std::size_t D, typename Iteration>
+    template<bool with_rhs, bool with_A>
+    void MacFluidSolver<D, Iteration>::assemble(float delta_t, const VelocityView& velocity, std::span<float> rhs,
+                                                const std::array<std::span<float>, D + 1>& A) const
+    {
+        // A holds the diagonal followed by the coupling to the next cell in every dimension. The walls are at rest,
+        // so their velocity does not show up in the rhs corrections.
+        auto rhs_scale = 1.0f / m_delta_x;
+        auto A_scale = delta_t / (m_density * m_delta_x * m_delta_x);
+        m_iteration.forEachCell(threadPool(), [this, &velocity, rhs, &A, rhs_scale, A_scale](const Cell& cell) {
+            auto index = grid().linear(cell);
+            if constexpr (with_rhs) { rhs[index] = 0.0f; }
+            if constexpr (with_A) {
+                for (auto coefficients : A) { coefficients[index] = 0.0f; }
+            }
+            if (label(Neighbor(cell, 0, 0)) != Label::FLUID) { return; }
+            // the neighbor labels are read once for both outputs.
+            for (std::size_t d = 0; d < D; ++d) {
+                auto label_lower = label(Neighbor(cell, d, -1));
+                auto label_upper = label(Neighbor(cell, d, 1));
+                if constexpr (with_A) {
+                    if (label_lower != Label::SOLID) { A[0][index] += A_scale; }
+                    if (label_upper != Label::SOLID) { A[0][index] += A_scale; }
+                    if (label_upper == Label::FLUID) { A[d + 1][index] = -A_scale; }
+                }
+                if constexpr (with_rhs) {
+                    const auto& layout = m_face_layouts[d];
+                    auto upper_face = cell;
+                    upper_face[d] += 1;
+                    auto q_lower = velocity[d][layout.linear(cell)];
+                    auto q_upper = velocity[d][layout.linear(upper_face)];
+                    rhs[index] -= rhs_scale * (q_upper - q_lower);
+                    if (label_lower == Label::SOLID) { rhs[index] -= rhs_scale * q_lower; }
+                    if (label_upper == Label::SOLID) { rhs[index] += rhs_scale * q_upper; }
+                }
+            }
+        });
+    }
+
+    template<std::size_t D, typename Iteration>
+    void MacFluidSolver<D, Iteration>::pressure_update(float delta_t, const VelocityBuffers& velocity) const
+    {
+        auto scale = delta_t / (m_density * m_delta_x);
+        // pressure in empty cells is zero.
+        auto pressure = [this](const CellOffset& cell, Label cell_label) {
+            if (cell_label != Label::FLUID) { return 0.0f; }
+            Cell index{};
+            for (std::size_t d = 0; d < D; ++d) { index[d] = static_cast<std::size_t>(cell[d]); }
+            return m_p[grid().linear(index)];
+        };
+        for (std::size_t dim = 0; dim < D; ++dim) {
+            const std::span<float> q = velocity[dim];
+            m_iteration.forEachFace(threadPool(), dim, [this, q, dim, scale, &pressure](const Cell& face) {
+                // face f lies between the lower cell f - e_dim and the upper cell f.
+                auto lower = Neighbor(face, dim, -1);
+                auto upper = Neighbor(face, dim, 0);
+                auto label_lower = label(lower);
+                auto label_upper = label(upper);
+                auto& result = q[m_face_layouts[dim].linear(face)];
+                if (label_lower != Label::FLUID && label_upper != Label::FLUID) { return; }
+                if (label_lower == Label::SOLID || label_upper == Label::SOLID) {
+                    result = 0.0f;
+                    return;
+                }
+                result -= scale * (pressure(upper, label_upper) - pressure(lower, label_lower));
+            });
+        }
+    }
+
+    template class MacFluidSolver<2, TiledIteration<2>>;
+    template class MacFluidSolver<3, ActiveBricks<3>>;
+}
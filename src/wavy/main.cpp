@@ -3,23 +3,238 @@
  * @author Sebastian Maisch <Sebastian Maisch_EMAIL>
  * @date   2023.10.06
  *
- * @brief  Implements the applications entry point for windows.
+ * @brief  Implements the applications entry point, a headless batch run of a scenario.
  */
 
 #include "main.h"
 #include "app_constants.h"
+#include "core/profiler.h"
 #include "core/spdlog/sinks/filesink.h"
+#include "fluid1d.h"
 
+#include <docopt/docopt.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/async.h>
 #include <spdlog/sinks/msvc_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <optional>
 
+namespace {
+    constexpr std::string_view usage = R"(wavy, a playground for fluid simulations.
 
-int main(int /* argc */, const char** /* argv */) // NOLINT(bugprone-exception-escape)
+Runs a 1d fluid simulation without any window and reports its performance.
+
+Usage:
+  wavy [options]
+  wavy (-h | --help)
+  wavy --version
+
+Options:
+  -h --help                    Show this screen.
+  --version                    Show the version.
+  --config=<file>              Reads options from a file, one per line (e.g. --frames=100). Options given on the
+                               command line override the ones in the file.
+  --grid-size=<cells>          Number of cells [default: 1000].
+  --delta-x=<meters>           Size of a cell [default: 0.01].
+  --gravity=<acceleration>     Acceleration along the grid, any sign, negative pulls towards cell 0 [default: 9.81].
+  --density=<density>          Density of the fluid [default: 1000].
+  --interpolation=<scheme>     Interpolation of the advection: linear or cubic [default: linear].
+  --integration=<scheme>       Integration of the advection: rk2, rk3 or rk4 [default: rk2].
+  --pressure-solver=<solver>   Pressure solver: pcg, tridiagonal or multigrid [default: tridiagonal].
+  --frames=<count>             Number of frames to simulate [default: 600].
+  --fps=<rate>                 Frames per simulated second [default: 60].
+  --threads=<count>            Threads of the solver, 0 uses all hardware threads [default: 0].
+  --output=<file>              Writes every frame to the file.
+  --compress                   Compresses the written frames.
+)";
+
+    /** Everything a headless run is configured with. */
+    struct Scenario
+    {
+        std::size_t grid_size = 0;
+        float delta_x = 0.0f;
+        float gravity = 0.0f;
+        float density = 0.0f;
+        wavy::kernels::AdvectionSettings advection;
+        wavy::solver::PressureSolverSettings pressure;
+        std::size_t frames = 0;
+        float fps = 0.0f;
+        std::size_t threads = 0;
+        std::string output;
+        bool compress = false;
+    };
+
+    using namespace std::string_view_literals;
+    constexpr std::array interpolation_names{std::pair{"linear"sv, wavy::InterpolationMethod::Linear},
+                                             std::pair{"cubic"sv, wavy::InterpolationMethod::Cubic}};
+    constexpr std::array integration_names{std::pair{"rk2"sv, wavy::IntegrationMethod::RK2},
+                                           std::pair{"rk3"sv, wavy::IntegrationMethod::RK3},
+                                           std::pair{"rk4"sv, wavy::IntegrationMethod::RK4}};
+    using PressureSolverMethod = wavy::solver::PressureSolverMethod;
+    constexpr std::array pressure_solver_names{std::pair{"pcg"sv, PressureSolverMethod::PCG},
+                                               std::pair{"tridiagonal"sv, PressureSolverMethod::Tridiagonal},
+                                               std::pair{"multigrid"sv, PressureSolverMethod::Multigrid}};
+
+    template<typename Enum, std::size_t N>
+    Enum parseChoice(const docopt::value& value, std::string_view option,
+                     const std::array<std::pair<std::string_view, Enum>, N>& choices)
+    {
+        const auto& name = value.asString();
+        for (const auto& [choice_name, choice] : choices) {
+            if (name == choice_name) { return choice; }
+        }
+        throw std::invalid_argument{fmt::format("Unknown {} '{}'.", option, name)};
+    }
+
+    /** Parses a whole non-negative number, signs and values not fitting into std::size_t are errors. */
+    std::size_t parseCount(const docopt::value& value, std::string_view option)
+    {
+        const auto& text = value.asString();
+        std::size_t result = 0;
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+        if (error != std::errc{} || end != text.data() + text.size()) {
+            throw std::invalid_argument{fmt::format("The {} '{}' is not a non-negative integer.", option, text)};
+        }
+        return result;
+    }
+
+    /** Parses a whole finite number of any sign. */
+    float parseFinite(const docopt::value& value, std::string_view option)
+    {
+        const auto& text = value.asString();
+        float result = 0.0f;
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+        if (error != std::errc{} || end != text.data() + text.size() || !std::isfinite(result)) {
+            throw std::invalid_argument{fmt::format("The {} '{}' is not a finite number.", option, text)};
+        }
+        return result;
+    }
+
+    /** Parses a whole finite number larger than zero. */
+    float parsePositive(const docopt::value& value, std::string_view option)
+    {
+        const auto result = parseFinite(value, option);
+        if (result <= 0.0f) {
+            throw std::invalid_argument{
+                fmt::format("The {} '{}' is not a finite positive number.", option, value.asString())};
+        }
+        return result;
+    }
+
+    Scenario parseScenario(const std::map<std::string, docopt::value>& arguments)
+    {
+        Scenario scenario;
+        scenario.grid_size = parseCount(arguments.at("--grid-size"), "grid size");
+        scenario.delta_x = parsePositive(arguments.at("--delta-x"), "cell size");
+        scenario.gravity = parseFinite(arguments.at("--gravity"), "gravity");
+        scenario.density = parsePositive(arguments.at("--density"), "density");
+        scenario.advection.interpolation =
+            parseChoice(arguments.at("--interpolation"), "interpolation", interpolation_names);
+        scenario.advection.integration = parseChoice(arguments.at("--integration"), "integration", integration_names);
+        scenario.pressure.method =
+            parseChoice(arguments.at("--pressure-solver"), "pressure solver", pressure_solver_names);
+        scenario.frames = parseCount(arguments.at("--frames"), "frame count");
+        scenario.fps = parsePositive(arguments.at("--fps"), "frame rate");
+        scenario.threads = parseCount(arguments.at("--threads"), "thread count");
+        if (const auto& output = arguments.at("--output")) { scenario.output = output.asString(); }
+        scenario.compress = arguments.at("--compress").asBool();
+
+        // a frame rate this high leaves no frame time, the solver would never finish a frame.
+        if (scenario.grid_size == 0 || !std::isnormal(1.0f / scenario.fps)) {
+            throw std::invalid_argument{"Grid size and frame time have to be positive."};
+        }
+        return scenario;
+    }
+
+    /** The name of a command line option, i.e. "--frames" for "--frames=100". */
+    std::string_view optionName(std::string_view argument) { return argument.substr(0, argument.find('=')); }
+
+    /** The arguments from the config file followed by the command line ones, which replace the same options. */
+    std::vector<std::string> readArguments(int argc, const char** argv)
+    {
+        const std::vector<std::string> command_line{std::next(argv), std::next(argv, argc)};
+        auto config = std::ranges::find_if(command_line, [](std::string_view argument) {
+            return optionName(argument) == "--config";
+        });
+        if (config == command_line.end()) { return command_line; }
+
+        // the path is either part of the option or the next argument, a missing one is reported by docopt.
+        std::string config_path;
+        if (config->find('=') != std::string::npos) {
+            config_path = config->substr(config->find('=') + 1);
+        } else if (std::next(config) != command_line.end()) {
+            config_path = *std::next(config);
+        }
+        std::ifstream file{config_path};
+        if (!file) { throw std::invalid_argument{fmt::format("Cannot read config file '{}'.", config_path)}; }
+
+        std::vector<std::string> arguments;
+        for (std::string line; std::getline(file, line);) {
+            auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') { continue; }
+            auto argument = line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+            auto overridden = std::ranges::any_of(command_line, [&argument](std::string_view given) {
+                return optionName(given) == optionName(argument);
+            });
+            if (!overridden) { arguments.push_back(std::move(argument)); }
+        }
+        arguments.insert(arguments.end(), command_line.begin(), command_line.end());
+        return arguments;
+    }
+
+    /** Runs the scenario to completion and reports the performance to stdout. */
+    void runScenario(const Scenario& scenario)
+    {
+        mysh::core::ThreadPool pool{mysh::core::ThreadPoolSettings{scenario.threads}};
+        wavy::FluidSolver1D solver{scenario.grid_size, scenario.delta_x, scenario.gravity, scenario.density,
+                                   scenario.pressure, scenario.advection};
+        solver.setThreadPool(pool);
+        std::optional<mysh::core::FrameWriter> frames;
+        if (!scenario.output.empty()) {
+            frames.emplace(scenario.output, mysh::core::FrameWriterSettings{scenario.compress});
+        }
+
+        std::size_t substeps = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t frame = 0; frame < scenario.frames; ++frame) {
+            solver.solveNextStep(1.0f / scenario.fps);
+            substeps += solver.lastSubsteps();
+            // the frames are written by a background thread while the next ones are simulated.
+            if (frames) { solver.writeFrame(*frames); }
+        }
+        if (frames) { frames->close(); }
+        const std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+
+        const auto cell_steps = static_cast<double>(scenario.grid_size) * static_cast<double>(substeps);
+        fmt::print("frames:         {}\n", scenario.frames);
+        fmt::print("simulated time: {:.3f} s\n", solver.time());
+        fmt::print("substeps:       {}\n", substeps);
+        fmt::print("wall time:      {:.3f} s\n", wall_time.count());
+        fmt::print("throughput:     {:.4g} cell steps/s\n", cell_steps / wall_time.count());
+        spdlog::info("Simulated {} frames with {} substeps in {:.3f} s.", scenario.frames, substeps, wall_time.count());
+    }
+}
+
+int main(int argc, const char** argv) // NOLINT(bugprone-exception-escape)
 {
+    Scenario scenario;
+    try {
+        // docopt prints the usage and exits on --help, --version or unknown options.
+        auto arguments = docopt::docopt(std::string{usage}, readArguments(argc, argv), true,
+                                        fmt::format("{} {}.{}.{}", wavy::applicationName, wavy::applicationVersionMajor,
+                                                    wavy::applicationVersionMinor, wavy::applicationVersionPatch));
+        scenario = parseScenario(arguments);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
     try {
         constexpr std::string_view directory; // = "";
         constexpr std::string_view name = wavy::logFileName;
@@ -51,6 +266,9 @@ int main(int /* argc */, const char** /* argv */) // NOLINT(bugprone-exception-e
 
         if constexpr (wavy::debug_build) {
             spdlog::set_level(spdlog::level::trace);
+        } else if constexpr (mysh::core::profiling_enabled) {
+            // the solvers log their per frame profile at info, the console sink still only shows warnings.
+            spdlog::set_level(spdlog::level::info);
         } else {
             spdlog::set_level(spdlog::level::err);
         }
@@ -64,7 +282,12 @@ int main(int /* argc */, const char** /* argv */) // NOLINT(bugprone-exception-e
 
 
     spdlog::debug("Starting main loop.");
-
+    try {
+        runScenario(scenario);
+    } catch (const std::exception& ex) {
+        spdlog::critical("Simulation failed: {}", ex.what());
+        return 1;
+    }
     spdlog::debug("Main loop ended.");
 
     return 0;
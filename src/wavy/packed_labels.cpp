@@ -0,0 +1,77 @@
+/**
+ * @file   packed_labels.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.31
+ *
+ * @brief  Cell labels packed into two bits per cell with word parallel queries.
+ */
+
+#include "packed_labels.h"
+
+#include <bit>
+
+namespace wavy
+{
+    PackedLabels::PackedLabels(std::size_t size, CellLabel value)
+        : m_size{size}
+        , m_words(size / cells_per_word + 1, low_bits * static_cast<word_type>(value))
+    {
+    }
+
+    PackedLabels::PackedLabels(std::span<const CellLabel> labels)
+    {
+        assign(labels);
+    }
+
+    void PackedLabels::assign(std::span<const CellLabel> labels)
+    {
+        m_size = labels.size();
+        m_words.assign(m_size / cells_per_word + 1, 0);
+        for (std::size_t i = 0; i < m_size; ++i) { set(i, labels[i]); }
+    }
+
+    std::size_t PackedLabels::count(CellLabel label) const
+    {
+        std::size_t result = 0;
+        const auto full_words = m_size / cells_per_word;
+        for (std::size_t word = 0; word < full_words; ++word) {
+            result += static_cast<std::size_t>(std::popcount(equal_lanes(m_words[word], label)));
+        }
+        // the lanes after the last cell hold arbitrary labels.
+        const auto tail = m_size % cells_per_word;
+        if (tail != 0) {
+            const auto valid = (word_type{1} << (2 * tail)) - 1;
+            result += static_cast<std::size_t>(std::popcount(equal_lanes(m_words[full_words], label) & valid));
+        }
+        return result;
+    }
+
+    std::pair<std::size_t, std::size_t> PackedLabels::find_run(CellLabel label, std::size_t from) const
+    {
+        // skip to the first cell with the label, then to the first one without it, 32 cells at a time.
+        auto find = [this, label](std::size_t index, bool with_label) {
+            while (index < m_size) {
+                auto bits = mask(label, static_cast<std::ptrdiff_t>(index), label);
+                if (!with_label) { bits = ~bits; }
+                if (bits != 0) { return std::min(index + static_cast<std::size_t>(std::countr_zero(bits)), m_size); }
+                index += cells_per_word;
+            }
+            return m_size;
+        };
+        auto begin = find(from, true);
+        return {begin, find(begin, false)};
+    }
+
+    PackedLabels::word_type PackedLabels::window_at_border(std::ptrdiff_t first, CellLabel outside) const
+    {
+        word_type result = 0;
+        for (std::size_t lane = 0; lane < cells_per_word; ++lane) {
+            const auto index = first + static_cast<std::ptrdiff_t>(lane);
+            const auto label = index < 0 || index >= static_cast<std::ptrdiff_t>(m_size)
+                                   ? outside
+                                   : get(static_cast<std::size_t>(index));
+            result |= static_cast<word_type>(label) << (2 * lane);
+        }
+        return result;
+    }
+}
@@ -0,0 +1,328 @@
+/**
+ * @file   multigrid.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.23
+ *
+ * @brief  Geometric multigrid solver for the pressure system of 1d fluids.
+ */
+
+#include "solver/multigrid.h"
+#include "solver/vector_ops.h"
+
+#include <algorithm>
+
+namespace wavy::solver
+{
+    namespace detail
+    {
+        /** Linear interpolation weights of the parent and its closest neighbor on a cell centered grid. */
+        constexpr float prolongation_near_weight = 0.75f;
+        constexpr float prolongation_far_weight = 0.25f;
+        /** Restriction is the transposed interpolation scaled by the ratio of fine to coarse cell size. */
+        constexpr float restriction_scale = 0.5f;
+
+        CellLabel label_at(std::span<const CellLabel> labels, std::size_t index, std::ptrdiff_t offset,
+                           CellLabel boundary_label)
+        {
+            auto neighbor = static_cast<std::ptrdiff_t>(index) + offset;
+            if (neighbor < 0 || neighbor >= static_cast<std::ptrdiff_t>(labels.size())) { return boundary_label; }
+            return labels[static_cast<std::size_t>(neighbor)];
+        }
+
+        /** Returns the sizes of the coarse levels, starting with the one directly below the finest level. */
+        std::vector<std::size_t> coarse_sizes(std::size_t size, const MultigridSettings& settings)
+        {
+            std::vector<std::size_t> sizes;
+            for (auto level_size = size; level_size > std::max<std::size_t>(settings.coarsest_size, 1);) {
+                level_size = (level_size + 1) / 2;
+                sizes.push_back(level_size);
+            }
+            return sizes;
+        }
+
+        /** The bytes the labels, faces and vectors of a level with size cells take from a ScratchArena. */
+        std::size_t level_bytes(std::size_t size)
+        {
+            using mysh::core::ScratchArena;
+            return ScratchArena::footprint<CellLabel>(size) + ScratchArena::footprint<std::uint8_t>(size + 1)
+                   + ScratchArena::footprint<std::uint8_t>(size) + 5 * ScratchArena::footprint<float>(size);
+        }
+    }
+
+    MultigridSolver::Level::Level(std::size_t size, std::pmr::memory_resource* resource)
+        : labels(size, CellLabel::SOLID, resource)
+        , open_faces(size + 1, 0, resource)
+        , attached(size, 0, resource)
+        , diag(size, 0.0f, resource)
+        , plus(size, 0.0f, resource)
+        , x(size, 0.0f, resource)
+        , b(size, 0.0f, resource)
+        , r(size, 0.0f, resource)
+    {
+    }
+
+    MultigridSolver::MultigridSolver(std::size_t size, const MultigridSettings& settings,
+                                     const PCGSettings& pcg_settings, std::pmr::memory_resource* resource)
+        : m_settings{settings}
+        , m_r(size, 0.0f, resource)
+        , m_labels(size, CellLabel::SOLID, resource)
+        , m_open_faces(size + 1, 0, resource)
+        , m_levels(resource)
+        , m_pcg{settings.as_preconditioner ? size : 0, pcg_settings, resource}
+    {
+        const auto sizes = detail::coarse_sizes(size, m_settings);
+        m_levels.reserve(sizes.size());
+        for (auto level_size : sizes) { m_levels.emplace_back(level_size, resource); }
+    }
+
+    std::size_t MultigridSolver::scratch_bytes(std::size_t size, const MultigridSettings& settings)
+    {
+        using mysh::core::ScratchArena;
+        const auto sizes = detail::coarse_sizes(size, settings);
+        auto bytes = ScratchArena::footprint<float>(size) + ScratchArena::footprint<CellLabel>(size)
+                     + ScratchArena::footprint<std::uint8_t>(size + 1) + ScratchArena::footprint<Level>(sizes.size());
+        for (auto level_size : sizes) { bytes += detail::level_bytes(level_size); }
+        return bytes + PCGSolver<1>::scratch_bytes(settings.as_preconditioner ? size : 0);
+    }
+
+    void MultigridSolver::setup(std::span<const CellLabel> labels, float scale)
+    {
+        auto& pool = *m_thread_pool;
+        std::ranges::copy(labels, m_labels.begin());
+        for_each_index(pool, 0, m_open_faces.size(), [this](std::size_t index) {
+            auto left = detail::label_at(m_labels, index, -1, m_settings.boundary_label);
+            auto right = detail::label_at(m_labels, index, 0, m_settings.boundary_label);
+            m_open_faces[index] = left != CellLabel::SOLID && right != CellLabel::SOLID ? 1 : 0;
+        });
+
+        std::span<const CellLabel> fine_labels = m_labels;
+        std::span<const std::uint8_t> fine_faces = m_open_faces;
+        // distance from the outer faces to the points where an empty boundary holds zero pressure, in cells of the
+        // level. The fine level has them at the centers of the outside cells.
+        auto boundary_distance = 0.5f;
+        for (auto& level : m_levels) {
+            scale *= 0.25f;
+            boundary_distance *= 0.5f;
+            // on coarse levels the zero pressure points are closer than one cell, the open outer faces couple stronger.
+            const auto boundary_scale = m_settings.boundary_label == CellLabel::EMPTY
+                                            ? scale / (0.5f + boundary_distance)
+                                            : scale;
+
+            for_each_index(pool, 0, level.labels.size(),
+                           [&level, fine_labels, fine_faces, boundary = m_settings.boundary_label](std::size_t index) {
+                               const auto left = 2 * index;
+                               const auto right = left + 1;
+                               auto attached = std::uint8_t{1};
+                               if (right < fine_labels.size()) {
+                                   if (fine_faces[right] != 0) {
+                                       attached = 3;
+                                   } else if (fine_labels[left] != CellLabel::FLUID
+                                              && (fine_labels[right] == CellLabel::FLUID
+                                                  || fine_labels[left] == CellLabel::SOLID)) {
+                                       attached = 2;
+                                   }
+                               }
+                               level.attached[index] = attached;
+
+                               // dirichlet conditions take precedence, otherwise coarse corrections overshoot.
+                               auto label = CellLabel::SOLID;
+                               // the missing child of the last cell of an odd level lies outside and is boundary.
+                               auto has_empty = right >= fine_labels.size() && boundary == CellLabel::EMPTY;
+                               for (std::size_t child = 0; child < 2; ++child) {
+                                   if ((attached & (1U << child)) == 0) { continue; }
+                                   if (fine_labels[left + child] == CellLabel::FLUID) { label = CellLabel::FLUID; }
+                                   has_empty = has_empty || fine_labels[left + child] == CellLabel::EMPTY;
+                               }
+                               level.labels[index] = has_empty ? CellLabel::EMPTY : label;
+                           });
+
+            // coarse face k coincides with fine face 2k (the last one with the last fine face) and additionally
+            // needs the fine cells on both of its sides to be attached.
+            for_each_index(pool, 0, level.open_faces.size(),
+                           [this, &level, fine_faces](std::size_t index) {
+                               auto& result = level.open_faces[index];
+                               auto left = detail::label_at(level.labels, index, -1, m_settings.boundary_label);
+                               auto right = detail::label_at(level.labels, index, 0, m_settings.boundary_label);
+                               auto is_open = fine_faces[std::min(2 * index, fine_faces.size() - 1)] != 0;
+                               if (index > 0) {
+                                   auto last_child = 2 * (index - 1) + 1 < fine_faces.size() - 1 ? 2U : 1U;
+                                   is_open = is_open && (level.attached[index - 1] & last_child) != 0;
+                               }
+                               if (index < level.attached.size()) {
+                                   is_open = is_open && (level.attached[index] & 1U) != 0;
+                               }
+                               result = is_open && left != CellLabel::SOLID && right != CellLabel::SOLID ? 1 : 0;
+                           });
+
+            // same discretization as the fluid solver's setup_A, with closed faces acting as solid neighbors.
+            for_each_index(pool, 0, level.diag.size(),
+                           [&level, scale, boundary_scale](std::size_t i) {
+                               const auto last = level.labels.size() - 1;
+                               level.diag[i] = 0.0f;
+                               level.plus[i] = 0.0f;
+                               if (level.labels[i] != CellLabel::FLUID) { return; }
+                               if (level.open_faces[i] != 0) { level.diag[i] += i == 0 ? boundary_scale : scale; }
+                               if (level.open_faces[i + 1] != 0) {
+                                   level.diag[i] += i == last ? boundary_scale : scale;
+                                   if (i + 1 < level.labels.size() && level.labels[i + 1] == CellLabel::FLUID) {
+                                       level.plus[i] = -scale;
+                                   }
+                               }
+                           });
+
+            fine_labels = level.labels;
+            fine_faces = level.open_faces;
+        }
+    }
+
+    SolverResult MultigridSolver::solve(const PoissonStencil<1>& A, std::span<const float> rhs, std::span<float> p)
+    {
+        if (m_settings.as_preconditioner) {
+            auto preconditioner = [this, &A](std::span<const float> r, std::span<float> z) { applyCycle(A, r, z); };
+            return m_pcg.solve(A, rhs, p, PCGSolver<1>::Preconditioner{preconditioner});
+        }
+
+        SolverResult result;
+        auto& pool = *m_thread_pool;
+        fill(pool, p, 0.0f);
+        const auto tolerance = m_settings.tolerance * max_abs(pool, rhs);
+        result.residual = max_abs(pool, rhs);
+        if (result.residual <= 0.0f) {
+            result.converged = true;
+            return result;
+        }
+
+        while (result.iterations < m_settings.max_cycles) {
+            cycle(0, m_settings.cycle, A, rhs, p);
+            result.iterations += 1;
+
+            residual(A, rhs, p, m_r);
+            result.residual = max_abs(pool, m_r);
+            if (result.residual <= tolerance) {
+                result.converged = true;
+                break;
+            }
+        }
+        return result;
+    }
+
+    void MultigridSolver::applyCycle(const PoissonStencil<1>& A, std::span<const float> r, std::span<float> z)
+    {
+        fill(*m_thread_pool, z, 0.0f);
+        cycle(0, m_settings.cycle, A, r, z);
+    }
+
+    void MultigridSolver::cycle(std::size_t level, MultigridCycle type, const PoissonStencil<1>& A,
+                                std::span<const float> b, std::span<float> x)
+    {
+        if (level == m_levels.size()) {
+            smooth(A, b, x, m_settings.coarsest_smoothing, false);
+            smooth(A, b, x, m_settings.coarsest_smoothing, true);
+            return;
+        }
+
+        std::span<float> r = level == 0 ? std::span<float>{m_r} : std::span<float>{m_levels[level - 1].r};
+        std::span<const CellLabel> labels =
+            level == 0 ? std::span<const CellLabel>{m_labels} : std::span<const CellLabel>{m_levels[level - 1].labels};
+        auto& coarse = m_levels[level];
+
+        smooth(A, b, x, m_settings.pre_smoothing, false);
+        residual(A, b, x, r);
+        restrictResidual(r, labels, coarse);
+        fill(*m_thread_pool, coarse.x, 0.0f);
+
+        const auto coarse_A = coarse.stencil();
+        cycle(level + 1, type, coarse_A, coarse.b, coarse.x);
+        if (type == MultigridCycle::F) { cycle(level + 1, MultigridCycle::V, coarse_A, coarse.b, coarse.x); }
+
+        prolongateAdd(coarse, labels, x);
+        // reversed color order keeps the cycle symmetric, which is required when it preconditions PCG.
+        smooth(A, b, x, m_settings.post_smoothing, true);
+    }
+
+    void MultigridSolver::smooth(const PoissonStencil<1>& A, std::span<const float> b, std::span<float> x,
+                                 std::size_t sweeps, bool reverse) const
+    {
+        for (std::size_t sweep = 0; sweep < sweeps; ++sweep) {
+            for (std::size_t half = 0; half < 2; ++half) {
+                auto color = reverse ? 1 - half : half;
+                for_each_index(*m_thread_pool, color, x.size(), 2, [&A, b, x](std::size_t i) {
+                    if (A.diag[i] == 0.0f) { return; }
+                    auto t = b[i];
+                    if (i > 0) { t -= A.plus[0][i - 1] * x[i - 1]; }
+                    if (i + 1 < x.size()) { t -= A.plus[0][i] * x[i + 1]; }
+                    x[i] = t / A.diag[i];
+                });
+            }
+        }
+    }
+
+    void MultigridSolver::residual(const PoissonStencil<1>& A, std::span<const float> b, std::span<const float> x,
+                                   std::span<float> r) const
+    {
+        for_each_index(*m_thread_pool, 0, r.size(), [&A, b, x, r](std::size_t index) {
+            r[index] = A.diag[index] == 0.0f ? 0.0f : b[index] - A.apply(x, index);
+        });
+    }
+
+    MultigridSolver::Interpolation MultigridSolver::interpolation(const Level& coarse,
+                                                                  std::span<const CellLabel> labels_fine,
+                                                                  std::size_t index, CellLabel boundary_label)
+    {
+        // linear interpolation between the parent and its closest coarse neighbor, the correction vanishes towards
+        // empty cells and has zero gradient towards closed faces.
+        Interpolation result;
+        auto parent = index / 2;
+        auto is_right = index % 2 != 0;
+        if (labels_fine[index] != CellLabel::FLUID || coarse.labels[parent] != CellLabel::FLUID) { return result; }
+        if ((coarse.attached[parent] & (is_right ? 2U : 1U)) == 0) { return result; }
+
+        result.parents[0] = parent;
+        result.weights[0] = 1.0f;
+        result.count = 1;
+        if (coarse.open_faces[is_right ? parent + 1 : parent] == 0) { return result; }
+
+        result.weights[0] = detail::prolongation_near_weight;
+        // the open boundary faces of an empty boundary lead out of the grid, the neighbor there is no coarse cell.
+        const auto offset = is_right ? std::ptrdiff_t{1} : std::ptrdiff_t{-1};
+        const auto in_grid = is_right ? parent + 1 < coarse.labels.size() : parent > 0;
+        if (in_grid && detail::label_at(coarse.labels, parent, offset, boundary_label) == CellLabel::FLUID) {
+            result.parents[1] = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(parent) + offset);
+            result.weights[1] = detail::prolongation_far_weight;
+            result.count = 2;
+        }
+        return result;
+    }
+
+    void MultigridSolver::restrictResidual(std::span<const float> r_fine, std::span<const CellLabel> labels_fine,
+                                           Level& coarse) const
+    {
+        // scaled transpose of the interpolation, which keeps the cycle symmetric. The fine cells 2I - 1 to 2I + 2
+        // may interpolate from coarse cell I.
+        const auto n_fine = r_fine.size();
+        for_each_index(*m_thread_pool, 0, coarse.b.size(),
+                       [&coarse, r_fine, labels_fine, n_fine, boundary = m_settings.boundary_label](std::size_t index) {
+                           auto& result = coarse.b[index];
+                           result = 0.0f;
+                           if (coarse.labels[index] != CellLabel::FLUID) { return; }
+                           for (auto i = std::max<std::size_t>(2 * index, 1) - 1; i < std::min(2 * index + 3, n_fine); ++i) {
+                               auto P_i = interpolation(coarse, labels_fine, i, boundary);
+                               for (std::size_t k = 0; k < P_i.count; ++k) {
+                                   if (P_i.parents[k] == index) { result += detail::restriction_scale * P_i.weights[k] * r_fine[i]; }
+                               }
+                           }
+                       });
+    }
+
+    void MultigridSolver::prolongateAdd(const Level& coarse, std::span<const CellLabel> labels_fine,
+                                        std::span<float> x_fine) const
+    {
+        for_each_index(*m_thread_pool, 0, x_fine.size(),
+                       [&coarse, labels_fine, x_fine, boundary = m_settings.boundary_label](std::size_t index) {
+                           auto P_i = interpolation(coarse, labels_fine, index, boundary);
+                           for (std::size_t k = 0; k < P_i.count; ++k) {
+                               x_fine[index] += P_i.weights[k] * coarse.x[P_i.parents[k]];
+                           }
+                       });
+    }
+}
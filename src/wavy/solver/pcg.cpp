@@ -0,0 +1,154 @@
+/**
+ * @file   pcg.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.21
+ *
+ * @brief  Matrix free preconditioned conjugate gradient solver for the pressure system.
+ */
+
+#include "solver/pcg.h"
+#include "solver/vector_ops.h"
+
+#include <cmath>
+
+namespace wavy::solver
+{
+    template<std::size_t D>
+    PCGSolver<D>::PCGSolver(std::size_t size, const PCGSettings& settings, std::pmr::memory_resource* resource)
+        : m_settings{settings}
+        , m_precon(size, 0.0f, resource)
+        , m_r(size, 0.0f, resource)
+        , m_z(size, 0.0f, resource)
+        , m_s(size, 0.0f, resource)
+        , m_q(size, 0.0f, resource)
+    {
+    }
+
+    template<std::size_t D>
+    SolverResult PCGSolver<D>::solve(const PoissonStencil<D>& A, std::span<const float> rhs, std::span<float> p)
+    {
+        buildPreconditioner(A);
+        auto mic0 = [this, &A](std::span<const float> r, std::span<float> z) { applyPreconditioner(A, r, z); };
+        return solve(A, rhs, p, Preconditioner{mic0});
+    }
+
+    template<std::size_t D>
+    SolverResult PCGSolver<D>::solve(const PoissonStencil<D>& A, std::span<const float> rhs, std::span<float> p,
+                                     Preconditioner preconditioner)
+    {
+        SolverResult result;
+        auto& pool = *m_thread_pool;
+        fill(pool, p, 0.0f);
+        copy(pool, rhs, m_r);
+
+        const auto tolerance = m_settings.tolerance * max_abs(pool, m_r);
+        result.residual = max_abs(pool, m_r);
+        if (result.residual <= 0.0f) {
+            result.converged = true;
+            return result;
+        }
+
+        preconditioner(m_r, m_z);
+        copy(pool, m_z, m_s);
+        auto sigma = dot(pool, m_z, m_r);
+
+        for (; result.iterations < m_settings.max_iterations; ++result.iterations) {
+            applyA(A, m_s, m_z);
+            auto zs = dot(pool, m_z, m_s);
+            if (zs == 0.0f) { break; }
+            auto alpha = sigma / zs;
+
+            for_each_index(pool, 0, p.size(), [this, p, alpha](std::size_t i) {
+                p[i] += alpha * m_s[i];
+                m_r[i] -= alpha * m_z[i];
+            });
+
+            result.residual = max_abs(pool, m_r);
+            if (result.residual <= tolerance) {
+                result.iterations += 1;
+                result.converged = true;
+                return result;
+            }
+
+            preconditioner(m_r, m_z);
+            auto sigma_new = dot(pool, m_z, m_r);
+            auto beta = sigma_new / sigma;
+            for_each_index(pool, 0, m_s.size(), [this, beta](std::size_t i) { m_s[i] = m_z[i] + beta * m_s[i]; });
+            sigma = sigma_new;
+        }
+        return result;
+    }
+
+    template<std::size_t D>
+    void PCGSolver<D>::buildPreconditioner(const PoissonStencil<D>& A)
+    {
+        // the incomplete factorization is inherently sequential.
+        for (std::size_t i = 0; i < A.size(); ++i) {
+            if (A.diag[i] == 0.0f) {
+                m_precon[i] = 0.0f;
+                continue;
+            }
+
+            auto e = A.diag[i];
+            for (std::size_t d = 0; d < D; ++d) {
+                if (i < A.strides[d]) { continue; }
+                const auto j = i - A.strides[d];
+                const auto a_precon = A.plus[d][j] * m_precon[j];
+                e -= a_precon * a_precon;
+
+                auto off_axis = 0.0f;
+                for (std::size_t d2 = 0; d2 < D; ++d2) {
+                    if (d2 != d) { off_axis += A.plus[d2][j]; }
+                }
+                e -= m_settings.mic_tuning * A.plus[d][j] * off_axis * m_precon[j] * m_precon[j];
+            }
+
+            if (e < m_settings.mic_safety * A.diag[i]) { e = A.diag[i]; }
+            m_precon[i] = 1.0f / std::sqrt(e);
+        }
+    }
+
+    template<std::size_t D>
+    void PCGSolver<D>::applyPreconditioner(const PoissonStencil<D>& A, std::span<const float> r, std::span<float> z)
+    {
+        // forward substitution L q = r.
+        for (std::size_t i = 0; i < A.size(); ++i) {
+            if (A.diag[i] == 0.0f) {
+                m_q[i] = 0.0f;
+                continue;
+            }
+            auto t = r[i];
+            for (std::size_t d = 0; d < D; ++d) {
+                if (i < A.strides[d]) { continue; }
+                const auto j = i - A.strides[d];
+                t -= A.plus[d][j] * m_precon[j] * m_q[j];
+            }
+            m_q[i] = t * m_precon[i];
+        }
+
+        // backward substitution L^T z = q.
+        for (std::size_t i = A.size(); i-- > 0;) {
+            if (A.diag[i] == 0.0f) {
+                z[i] = 0.0f;
+                continue;
+            }
+            auto t = m_q[i];
+            for (std::size_t d = 0; d < D; ++d) {
+                const auto j = i + A.strides[d];
+                if (j >= A.size()) { continue; }
+                t -= A.plus[d][i] * m_precon[i] * z[j];
+            }
+            z[i] = t * m_precon[i];
+        }
+    }
+
+    template<std::size_t D>
+    void PCGSolver<D>::applyA(const PoissonStencil<D>& A, std::span<const float> s, std::span<float> z) const
+    {
+        for_each_index(*m_thread_pool, 0, z.size(), [&A, s, z](std::size_t i) { z[i] = A.apply(s, i); });
+    }
+
+    template class PCGSolver<1>;
+    template class PCGSolver<2>;
+    template class PCGSolver<3>;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file   tridiagonal.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.22
+ *
+ * @brief  Direct solvers for the tridiagonal pressure system of 1d fluids.
+ */
+
+#include "solver/tridiagonal.h"
+#include "solver/vector_ops.h"
+
+#include <cmath>
+#include <limits>
+
+namespace wavy::solver
+{
+    namespace detail
+    {
+        /** Pivots below this fraction of the original diagonal are treated as zero. */
+        constexpr float singular_pivot_factor = 4.0f * std::numeric_limits<float>::epsilon();
+    }
+
+    TridiagonalSolver::TridiagonalSolver(std::size_t size, const TridiagonalSettings& settings,
+                                         std::pmr::memory_resource* resource)
+        : m_settings{settings}
+        , m_c_prime(size, 0.0f, resource)
+        , m_a(resource)
+        , m_b(resource)
+        , m_c(resource)
+        , m_d(resource)
+    {
+        if (size >= m_settings.cyclic_reduction_threshold) {
+            m_a.resize(size, 0.0f);
+            m_b.resize(size, 0.0f);
+            m_c.resize(size, 0.0f);
+            m_d.resize(size, 0.0f);
+        }
+    }
+
+    SolverResult TridiagonalSolver::solve(const PoissonStencil<1>& A, std::span<const float> rhs, std::span<float> p)
+    {
+        if (A.size() >= m_settings.cyclic_reduction_threshold) { return solveCyclicReduction(A, rhs, p); }
+        return solveThomas(A, rhs, p);
+    }
+
+    SolverResult TridiagonalSolver::solveThomas(const PoissonStencil<1>& A, std::span<const float> rhs,
+                                                std::span<float> p)
+    {
+        const auto n = A.size();
+        if (n == 0) { return SolverResult{.iterations = 0, .residual = 0.0f, .converged = true}; }
+        const auto& diag = A.diag;
+        const auto& plus = A.plus[0];
+
+        // forward elimination, the modified right-hand side is stored in p.
+        auto c_prev = 0.0f;
+        auto d_prev = 0.0f;
+        for (std::size_t i = 0; i < n; ++i) {
+            auto a = i > 0 ? plus[i - 1] : 0.0f;
+            auto pivot = diag[i] - a * c_prev;
+            if (diag[i] == 0.0f || std::abs(pivot) <= detail::singular_pivot_factor * diag[i]) {
+                m_c_prime[i] = 0.0f;
+                p[i] = 0.0f;
+            } else {
+                m_c_prime[i] = plus[i] / pivot;
+                p[i] = (rhs[i] - a * d_prev) / pivot;
+            }
+            c_prev = m_c_prime[i];
+            d_prev = p[i];
+        }
+
+        // back substitution.
+        for (std::size_t i = n - 1; i-- > 0;) { p[i] -= m_c_prime[i] * p[i + 1]; }
+
+        return SolverResult{.iterations = 1, .residual = 0.0f, .converged = true};
+    }
+
+    SolverResult TridiagonalSolver::solveCyclicReduction(const PoissonStencil<1>& A, std::span<const float> rhs,
+                                                         std::span<float> p)
+    {
+        const auto n = A.size();
+        m_a.resize(n);
+        m_b.resize(n);
+        m_c.resize(n);
+        m_d.resize(n);
+
+        // non-fluid rows become identity rows so no pivot vanishes on their account.
+        auto& pool = *m_thread_pool;
+        for_each_index(pool, 0, n, [this, &A, rhs](std::size_t i) {
+            const auto is_fluid = A.diag[i] != 0.0f;
+            m_a[i] = i > 0 && is_fluid ? A.plus[0][i - 1] : 0.0f;
+            m_b[i] = is_fluid ? A.diag[i] : 1.0f;
+            m_c[i] = is_fluid ? A.plus[0][i] : 0.0f;
+            m_d[i] = is_fluid ? rhs[i] : 0.0f;
+        });
+
+        auto top_stride = std::size_t{1};
+        while (2 * top_stride <= n) { top_stride *= 2; }
+
+        // forward reduction: at stride s every equation i with (i + 1) % 2s == 0 eliminates its neighbors i +- s.
+        for (std::size_t s = 1; s < top_stride; s *= 2) {
+            for_each_index(pool, 2 * s - 1, n, 2 * s, [this, s, n](std::size_t i) {
+                const auto alpha = m_b[i - s] != 0.0f ? -m_a[i] / m_b[i - s] : 0.0f;
+                auto gamma = 0.0f;
+                if (i + s < n && m_b[i + s] != 0.0f) { gamma = -m_c[i] / m_b[i + s]; }
+
+                m_b[i] += alpha * m_c[i - s];
+                m_d[i] += alpha * m_d[i - s];
+                m_a[i] = alpha * m_a[i - s];
+                if (i + s < n) {
+                    m_b[i] += gamma * m_a[i + s];
+                    m_d[i] += gamma * m_d[i + s];
+                    m_c[i] = gamma * m_c[i + s];
+                } else {
+                    m_c[i] = 0.0f;
+                }
+            });
+        }
+
+        // back substitution: at stride s the equations i with (i + 1) % 2s == s only depend on already known values.
+        for (std::size_t s = top_stride; s > 0; s /= 2) {
+            for_each_index(pool, s - 1, n, 2 * s, [this, &A, p, s, n](std::size_t i) {
+                auto t = m_d[i];
+                if (i >= s) { t -= m_a[i] * p[i - s]; }
+                if (i + s < n) { t -= m_c[i] * p[i + s]; }
+                const auto scale = A.diag[i] != 0.0f ? A.diag[i] : 1.0f;
+                p[i] = std::abs(m_b[i]) <= detail::singular_pivot_factor * scale ? 0.0f : t / m_b[i];
+            });
+        }
+
+        return SolverResult{.iterations = 1, .residual = 0.0f, .converged = true};
+    }
+}
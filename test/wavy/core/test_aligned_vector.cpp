@@ -7,16 +7,136 @@
  */
 
 #include "core/aligned_vector.h"
+#include "core/scratch_arena.h"
 
+#include <algorithm>
 #include <catch.hpp>
+#include <memory_resource>
+#include <numeric>
+#include <ranges>
+#include <string>
+#include <vector>
 
 namespace mysh::core
 {
+    static_assert(std::random_access_iterator<aligned_vector<float>::iterator>);
+    static_assert(std::random_access_iterator<aligned_vector<float>::const_iterator>);
+    static_assert(std::ranges::random_access_range<aligned_vector<float>>);
+
     TEST_CASE("mysh::core::aligned_vector.general", "")
     {
         constexpr std::size_t alignment = 8;
         constexpr std::size_t element_count = 20;
         aligned_vector av(alignment, element_count, 1.0f);
-        REQUIRE((&av[1] - av.data()) * sizeof(float) == alignment);
+        REQUIRE(static_cast<std::size_t>(&av[1] - av.data()) * sizeof(float) == alignment);
+    }
+
+    TEST_CASE("mysh::core::aligned_vector.alignment", "[aligned_vector]")
+    {
+        auto aligned_size = GENERATE(sizeof(float), 4 * sizeof(float), 16 * sizeof(float));
+        aligned_vector<float, 64> av(aligned_size);
+        for (std::size_t i = 0; i < 100; ++i) {
+            av.push_back(static_cast<float>(i));
+            // the base address stays aligned whenever the buffer moves.
+            REQUIRE(std::bit_cast<std::uintptr_t>(av.data()) % 64 == 0);
+        }
+        for (std::size_t i = 0; i < av.size(); ++i) {
+            REQUIRE(std::bit_cast<std::uintptr_t>(&av[i]) - std::bit_cast<std::uintptr_t>(av.data()) == i * aligned_size);
+            REQUIRE(av[i] == static_cast<float>(i));
+        }
+        REQUIRE(av.is_contiguous() == (aligned_size == sizeof(float)));
+        if (av.is_contiguous()) { REQUIRE(av.as_span().size() == av.size()); }
+    }
+
+    TEST_CASE("mysh::core::aligned_vector.iterators", "[aligned_vector]")
+    {
+        aligned_vector<int> av(16, {5, 3, 4, 1, 2});
+        REQUIRE(std::ranges::equal(av, std::vector{5, 3, 4, 1, 2}));
+        REQUIRE(av.end() - av.begin() == 5);
+        REQUIRE(av.begin()[2] == 4);
+
+        std::ranges::sort(av);
+        REQUIRE(std::ranges::equal(av, std::vector{1, 2, 3, 4, 5}));
+        REQUIRE(std::ranges::equal(av | std::views::reverse, std::vector{5, 4, 3, 2, 1}));
+        REQUIRE(std::accumulate(av.cbegin(), av.cend(), 0) == 15);
+
+        const aligned_vector<int>::const_iterator it = av.begin() + 1;
+        REQUIRE(*it == 2);
+        REQUIRE(it > av.cbegin());
+    }
+
+    TEST_CASE("mysh::core::aligned_vector.modifiers", "[aligned_vector]")
+    {
+        aligned_vector<std::string> av(2 * sizeof(std::string), 2, std::string{"a"});
+        av.resize(4, "b");
+        REQUIRE(std::ranges::equal(av, std::vector<std::string>{"a", "a", "b", "b"}));
+
+        av.pop_back();
+        av.emplace_back(std::size_t{3}, 'c');
+        REQUIRE(av.back() == "ccc");
+
+        av.insert(av.begin() + 1, 2, "d");
+        REQUIRE(std::ranges::equal(av, std::vector<std::string>{"a", "d", "d", "a", "b", "ccc"}));
+        av.insert(av.end(), {"e", "f"});
+        av.emplace(av.begin(), "g");
+        REQUIRE(std::ranges::equal(av, std::vector<std::string>{"g", "a", "d", "d", "a", "b", "ccc", "e", "f"}));
+        // inserting an element of the vector itself.
+        av.insert(av.begin(), av.back());
+        REQUIRE(av.front() == "f");
+
+        av.erase(av.begin() + 1, av.begin() + 4);
+        av.erase(av.end() - 1);
+        REQUIRE(std::ranges::equal(av, std::vector<std::string>{"f", "d", "a", "b", "ccc", "e"}));
+
+        av.resize(2);
+        REQUIRE(std::ranges::equal(av, std::vector<std::string>{"f", "d"}));
+        av.shrink_to_fit();
+        REQUIRE(av.capacity() == 2);
+        REQUIRE_THROWS_AS(av.at(2), std::out_of_range);
+
+        av.assign(3, "x");
+        REQUIRE(std::ranges::equal(av, std::vector<std::string>{"x", "x", "x"}));
+        av.clear();
+        REQUIRE(av.empty());
+    }
+
+    TEST_CASE("mysh::core::aligned_vector.copy_move", "[aligned_vector]")
+    {
+        aligned_vector<float, 32> av(8, {1.0f, 2.0f, 3.0f});
+        auto copy = av;
+        REQUIRE(copy == av);
+        REQUIRE(copy.GetAlignedSize() == 8);
+        REQUIRE(copy.data() != av.data());
+
+        const auto* data = av.data();
+        auto moved = std::move(av);
+        REQUIRE(moved.data() == data);
+        REQUIRE(moved == copy);
+
+        aligned_vector<float, 32> other(16, {4.0f});
+        other = copy;
+        REQUIRE(other == copy);
+        REQUIRE(other.GetAlignedSize() == 8);
+        other = {5.0f, 6.0f};
+        REQUIRE(other.size() == 2);
+
+        other.swap(moved);
+        REQUIRE(other == copy);
+    }
+
+    TEST_CASE("mysh::core::aligned_vector.allocator", "[aligned_vector]")
+    {
+        using pmr_vector = aligned_vector<double, 64, std::pmr::polymorphic_allocator<std::byte>>;
+        ScratchArena arena{4096};
+        pmr_vector av(32, 10, 1.0, &arena);
+        REQUIRE(av.get_allocator().resource() == &arena);
+        REQUIRE(arena.used() > 0);
+        REQUIRE(std::bit_cast<std::uintptr_t>(av.data()) % 64 == 0);
+
+        // moving to another resource moves the elements instead of the buffer.
+        pmr_vector other(std::move(av), std::pmr::new_delete_resource());
+        REQUIRE(other.size() == 10);
+        REQUIRE(other.get_allocator().resource() == std::pmr::new_delete_resource());
+        REQUIRE(other[9] == 1.0);
     }
 }
@@ -0,0 +1,90 @@
+/**
+ * @file   test_checkpoint.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.05
+ *
+ * @brief  Tests for the checkpoint files.
+ */
+
+#include "core/checkpoint.h"
+
+#include <algorithm>
+#include <bit>
+#include <catch.hpp>
+#include <fstream>
+#include <numeric>
+
+namespace mysh::core
+{
+    namespace
+    {
+        struct Parameters
+        {
+            std::uint64_t grid_size = 0;
+            float delta_x = 0.0f;
+            std::string name;
+
+            template<typename Archive>
+            void serialize(Archive& archive, [[maybe_unused]] std::uint32_t version)
+            {
+                archive(grid_size, delta_x, name);
+            }
+        };
+
+        std::filesystem::path checkpoint_path(std::string_view name)
+        {
+            return std::filesystem::temp_directory_path() / name;
+        }
+    }
+
+    TEST_CASE("mysh::core::checkpoint.roundtrip", "[checkpoint]")
+    {
+        std::vector<float> velocity(1001);
+        std::iota(velocity.begin(), velocity.end(), 0.5f);
+        const std::vector<std::uint8_t> labels{0, 1, 2};
+
+        Checkpoint checkpoint{"test"};
+        checkpoint.set_parameters(Parameters{1001, 0.25f, "wave"});
+        checkpoint.add_field("labels", std::span<const std::uint8_t>{labels});
+        checkpoint.add_field("velocity", std::span<const float>{velocity});
+
+        const auto path = checkpoint_path("wavy_test_checkpoint.bin");
+        auto written = std::move(checkpoint).write_async(path);
+        written.get();
+        REQUIRE_FALSE(std::filesystem::exists(std::filesystem::path{path} += ".tmp"));
+
+        MappedCheckpoint loaded{path};
+        REQUIRE(loaded.kind() == "test");
+        auto parameters = loaded.parameters<Parameters>();
+        REQUIRE(parameters.grid_size == 1001);
+        REQUIRE(parameters.delta_x == 0.25f);
+        REQUIRE(parameters.name == "wave");
+
+        REQUIRE(loaded.contains("labels"));
+        REQUIRE_FALSE(loaded.contains("pressure"));
+        REQUIRE(std::ranges::equal(loaded.field<std::uint8_t>("labels"), labels));
+        auto mapped_velocity = loaded.field<float>("velocity");
+        REQUIRE(std::ranges::equal(mapped_velocity, velocity));
+        REQUIRE(std::bit_cast<std::uintptr_t>(mapped_velocity.data()) % detail::checkpoint_block_alignment == 0);
+
+        REQUIRE_THROWS_AS(loaded.field<float>("pressure"), CheckpointError);
+        REQUIRE_THROWS_AS(loaded.field<double>("velocity"), CheckpointError);
+
+        const MappedCheckpoint moved{std::move(loaded)};
+        REQUIRE(moved.field<float>("velocity")[1000] == 1000.5f);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("mysh::core::checkpoint.invalid", "[checkpoint]")
+    {
+        const auto path = checkpoint_path("wavy_test_invalid_checkpoint.bin");
+        REQUIRE_THROWS_AS(MappedCheckpoint{path}, CheckpointError);
+
+        {
+            std::ofstream file{path, std::ios::binary};
+            file << "not a checkpoint, but long enough to hold the preamble.";
+        }
+        REQUIRE_THROWS_AS(MappedCheckpoint{path}, CheckpointError);
+        std::filesystem::remove(path);
+    }
+}
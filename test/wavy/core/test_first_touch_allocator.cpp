@@ -0,0 +1,60 @@
+/**
+ * @file   test_first_touch_allocator.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.02
+ *
+ * @brief  Tests for the first touch allocator.
+ */
+
+#include "core/first_touch_allocator.h"
+#include "utils/field_ring.h"
+
+#include <algorithm>
+#include <bit>
+#include <catch.hpp>
+
+namespace mysh::core
+{
+    TEST_CASE("mysh::core::first_touch_allocator.allocate", "[first_touch_allocator]")
+    {
+        auto huge_pages = GENERATE(false, true);
+        // the large size takes the huge page path where it is available.
+        auto size = GENERATE(std::size_t{1}, std::size_t{1000}, std::size_t{1} << 20);
+        first_touch_vector<double> data(size, first_touch_allocator<double>{huge_pages});
+        REQUIRE(data.size() == size);
+        REQUIRE(std::bit_cast<std::uintptr_t>(data.data()) % alignof(double) == 0);
+        REQUIRE(data.get_allocator().huge_pages() == huge_pages);
+
+        data.back() = 1.0;
+        data.resize(2 * size, 2.0);
+        REQUIRE(data[size - 1] == 1.0);
+        REQUIRE(data.back() == 2.0);
+
+        const first_touch_allocator<float> rebound{data.get_allocator()};
+        REQUIRE(rebound == data.get_allocator());
+        REQUIRE_FALSE(rebound == first_touch_allocator<float>{!huge_pages});
+    }
+
+    TEST_CASE("mysh::core::first_touch_allocator.first_touch", "[first_touch_allocator]")
+    {
+        auto parallel = GENERATE(false, true);
+        auto grain_size = GENERATE(std::size_t{1}, std::size_t{64}, std::size_t{5000});
+        ThreadPool pool{{3}};
+        first_touch_vector<float> data(4099);
+        first_touch(pool, std::span<float>{data}, 3.0f, grain_size, {parallel, false});
+        REQUIRE(std::ranges::all_of(data, [](float value) { return value == 3.0f; }));
+
+        first_touch(pool, std::span<float>{}, 1.0f, grain_size);
+    }
+
+    TEST_CASE("mysh::core::first_touch_allocator.field_ring", "[first_touch_allocator]")
+    {
+        wavy::utils::field_ring<float, 2, first_touch_allocator<float>> ring{16, first_touch_allocator<float>{true}};
+        REQUIRE(ring.size() == 16);
+        REQUIRE(ring.current().get_allocator().huge_pages());
+        REQUIRE(ring.next().get_allocator().huge_pages());
+
+        wavy::utils::field_ring<float, 2, first_touch_allocator<float>> filled{16, 1.0f};
+        REQUIRE(filled.next()[15] == 1.0f);
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file   test_frame_writer.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.06
+ *
+ * @brief  Tests for the frame writer and reader.
+ */
+
+#include "core/frame_writer.h"
+
+#include <algorithm>
+#include <catch.hpp>
+#include <cmath>
+
+namespace mysh::core
+{
+    TEST_CASE("mysh::core::frame_writer.roundtrip", "[frame_writer]")
+    {
+        const bool compress = GENERATE(false, true);
+        const auto path = std::filesystem::temp_directory_path() / "wavy_test_frames.bin";
+        constexpr std::size_t frames = 10;
+
+        std::vector<float> velocity(5000);
+        std::vector<std::uint8_t> labels(5000, 1);
+        {
+            FrameWriter writer{path, FrameWriterSettings{compress}};
+            for (std::size_t frame = 0; frame < frames; ++frame) {
+                for (std::size_t i = 0; i < velocity.size(); ++i) {
+                    velocity[i] = std::sin(0.01f * static_cast<float>(i * (frame + 1)));
+                }
+                labels[frame] = 0;
+                // the fields are copied, so they can be changed right after writing.
+                writer.write_frame(0.5 * static_cast<double>(frame),
+                                   {frame_field("velocity", std::span<const float>{velocity}),
+                                    frame_field("labels", std::span<const std::uint8_t>{labels})});
+            }
+            REQUIRE(writer.frame_count() == frames);
+        }
+
+        FrameReader reader{path};
+        REQUIRE(reader.frame_count() == frames);
+        REQUIRE(reader.time(9) == 4.5);
+
+        // frames are read in any order through the index.
+        for (std::size_t frame : {7u, 2u, 9u, 0u}) {
+            auto result = reader.read_frame(frame);
+            REQUIRE(result.time == 0.5 * static_cast<double>(frame));
+            auto read_velocity = result.field<float>("velocity");
+            REQUIRE(read_velocity.size() == velocity.size());
+            REQUIRE(read_velocity[100] == std::sin(0.01f * static_cast<float>(100 * (frame + 1))));
+            auto read_labels = result.field<std::uint8_t>("labels");
+            REQUIRE(std::ranges::count(read_labels, std::uint8_t{0}) == static_cast<std::ptrdiff_t>(frame + 1));
+            REQUIRE_THROWS_AS(result.field<double>("velocity"), FrameFileError);
+            REQUIRE_THROWS_AS(result.field<float>("pressure"), FrameFileError);
+        }
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("mysh::core::frame_writer.unclosed", "[frame_writer]")
+    {
+        const auto path = std::filesystem::temp_directory_path() / "wavy_test_frames_empty.bin";
+        {
+            FrameWriter writer{path};
+            writer.close();
+            REQUIRE_THROWS_AS(writer.write_frame(0.0, {}), FrameFileError);
+        }
+        REQUIRE(FrameReader{path}.frame_count() == 0);
+
+        REQUIRE_THROWS_AS(FrameReader{path.parent_path() / "wavy_test_no_such_file.bin"}, FrameFileError);
+        std::filesystem::remove(path);
+    }
+}
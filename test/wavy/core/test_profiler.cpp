@@ -0,0 +1,64 @@
+/**
+ * @file   test_profiler.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.08
+ *
+ * @brief  Tests for the stage profiler.
+ */
+
+#include "core/profiler.h"
+
+#include <catch.hpp>
+
+namespace mysh::core
+{
+    TEST_CASE("mysh::core::profiler.statistics", "[profiler]")
+    {
+        using std::chrono::microseconds;
+        Profiler profiler{{"first", "second"}};
+        for (int i = 1; i <= 200; ++i) { profiler.record(0, microseconds{i}); }
+
+        auto statistics = profiler.endFrame();
+        REQUIRE(statistics.size() == 2);
+        REQUIRE(statistics[0].name == "first");
+        REQUIRE(statistics[0].count == 200);
+        REQUIRE(statistics[0].total == microseconds{20100});
+        REQUIRE(statistics[0].min == microseconds{1});
+        REQUIRE(statistics[0].mean == std::chrono::nanoseconds{100500});
+        REQUIRE(statistics[0].p99 == microseconds{198});
+        REQUIRE(statistics[1].name == "second");
+        REQUIRE(statistics[1].count == 0);
+
+        // every frame starts without samples.
+        profiler.record(1, microseconds{5});
+        statistics = profiler.endFrame();
+        REQUIRE(statistics[0].count == 0);
+        REQUIRE(statistics[1].count == 1);
+        REQUIRE(statistics[1].p99 == microseconds{5});
+        REQUIRE(profiler.lastFrame()[1].count == 1);
+    }
+
+    TEST_CASE("mysh::core::profiler.scoped_timer", "[profiler]")
+    {
+        Profiler profiler{{"scope"}};
+        {
+            auto timer = profiler.scope(0);
+        }
+        {
+            WAVY_PROFILE_SCOPE(profiler, 0);
+        }
+
+        const auto statistics = profiler.endFrame();
+        REQUIRE(statistics[0].count == (profiling_enabled ? 2 : 1));
+        REQUIRE(statistics[0].min >= std::chrono::nanoseconds::zero());
+    }
+
+    TEST_CASE("mysh::core::profiler.format", "[profiler]")
+    {
+        Profiler profiler{{"used", "unused"}};
+        profiler.record(0, std::chrono::microseconds{3});
+        const auto report = format_stage_statistics(profiler.endFrame());
+        REQUIRE(report.find("used") != std::string::npos);
+        REQUIRE(report.find("unused") == std::string::npos);
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * @file   test_scratch_arena.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.03
+ *
+ * @brief  Tests for the scratch arena.
+ */
+
+#include "core/scratch_arena.h"
+#include "solver/pressure_solver.h"
+
+#include <bit>
+#include <catch.hpp>
+
+namespace mysh::core
+{
+    TEST_CASE("mysh::core::scratch_arena.allocate", "[scratch_arena]")
+    {
+        ScratchArena arena{1000};
+        REQUIRE(arena.capacity() == ScratchArena::footprint(1000));
+
+        std::pmr::vector<float> first(10, 1.0f, &arena);
+        std::pmr::vector<float> second(20, 2.0f, &arena);
+        REQUIRE(std::bit_cast<std::uintptr_t>(first.data()) % ScratchArena::default_alignment == 0);
+        // fields follow each other, each starting on its own cache line.
+        REQUIRE(reinterpret_cast<std::byte*>(second.data()) // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                == reinterpret_cast<std::byte*>(first.data()) + ScratchArena::footprint<float>(10)); // NOLINT
+        REQUIRE(arena.used() == ScratchArena::footprint<float>(10) + ScratchArena::footprint<float>(20));
+        REQUIRE(arena.overflow() == 0);
+
+        SECTION("the last allocation is given back")
+        {
+            const auto used = arena.used();
+            {
+                const std::pmr::vector<float> temporary(5, 0.0f, &arena);
+                REQUIRE(arena.used() > used);
+            }
+            REQUIRE(arena.used() == used);
+        }
+
+        SECTION("rewind releases everything after the marker")
+        {
+            auto marker = arena.mark();
+            static_cast<void>(arena.allocate(100));
+            static_cast<void>(arena.allocate(100));
+            arena.rewind(marker);
+            REQUIRE(arena.used() == marker);
+        }
+
+        SECTION("requests that do not fit go upstream")
+        {
+            std::pmr::vector<float> large(1000, 3.0f, &arena);
+            REQUIRE(arena.overflow() == 1000 * sizeof(float));
+            REQUIRE(large[999] == 3.0f);
+            large = std::pmr::vector<float>{&arena};
+            REQUIRE(arena.overflow() == 0);
+        }
+
+        SECTION("reset keeps the upstream allocations of their owners")
+        {
+            std::pmr::vector<float> large(1000, 3.0f, &arena);
+            arena.reset();
+            REQUIRE(arena.used() == 0);
+            REQUIRE(arena.overflow() == 1000 * sizeof(float));
+            REQUIRE(large[999] == 3.0f);
+            large = std::pmr::vector<float>{&arena};
+            REQUIRE(arena.overflow() == 0);
+        }
+
+        first = std::pmr::vector<float>{&arena};
+        second = std::pmr::vector<float>{&arena};
+        arena.reset();
+        REQUIRE(arena.used() == 0);
+    }
+
+    TEST_CASE("mysh::core::scratch_arena.solvers", "[scratch_arena]")
+    {
+        using namespace wavy::solver;
+        auto size = GENERATE(std::size_t{1}, std::size_t{17}, std::size_t{1000});
+        PressureSolverSettings settings;
+        settings.multigrid.as_preconditioner = GENERATE(false, true);
+        settings.tridiagonal.cyclic_reduction_threshold = 100;
+
+        using enum PressureSolverMethod;
+        for (auto method : {PCG, Tridiagonal, Multigrid}) {
+            settings.method = method;
+            ScratchArena arena{scratch_bytes(size, settings)};
+            // the solver is built in one block that it fills exactly.
+            auto check = [&arena](const auto& /*solver*/) {
+                REQUIRE(arena.overflow() == 0);
+                REQUIRE(arena.used() == arena.capacity());
+            };
+            switch (method) {
+            case PCG: check(PCGSolver<1>{size, settings.pcg, &arena}); break;
+            case Tridiagonal: check(TridiagonalSolver{size, settings.tridiagonal, &arena}); break;
+            case Multigrid:
+                check(MultigridSolver{size, settings.multigrid, settings.pcg, &arena});
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/**
+ * @file   test_thread_pool.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.01
+ *
+ * @brief  Tests for the thread pool.
+ */
+
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <catch.hpp>
+#include <functional>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace mysh::core
+{
+    TEST_CASE("mysh::core::thread_pool.parallel_for", "[thread_pool]")
+    {
+        auto threads = GENERATE(std::size_t{1}, std::size_t{2}, std::size_t{5});
+        auto grain_size = GENERATE(std::size_t{1}, std::size_t{7}, std::size_t{1000});
+        ThreadPool pool{{threads}};
+        REQUIRE(pool.thread_count() == threads);
+
+        constexpr std::size_t first = 3;
+        constexpr std::size_t last = 2000;
+        for (int repetition = 0; repetition < 3; ++repetition) {
+            // catch is not thread safe, so the loop bodies only record what they saw.
+            std::vector<std::atomic<int>> visits(last);
+            std::atomic<bool> chunks_fit = true;
+            pool.parallel_for(first, last, grain_size, [&](std::size_t chunk_first, std::size_t chunk_last) {
+                if (chunk_last - chunk_first > grain_size) { chunks_fit = false; }
+                for (auto i = chunk_first; i < chunk_last; ++i) { visits[i] += 1; }
+            });
+            REQUIRE(chunks_fit);
+            for (std::size_t i = 0; i < last; ++i) { REQUIRE(visits[i] == (i < first ? 0 : 1)); }
+        }
+        bool called = false;
+        pool.parallel_for(5, 5, 1, [&called](std::size_t, std::size_t) { called = true; });
+        REQUIRE_FALSE(called);
+    }
+
+    TEST_CASE("mysh::core::thread_pool.nested loops run inline", "[thread_pool]")
+    {
+        ThreadPool pool{{4, true}};
+        std::atomic<std::size_t> sum = 0;
+        pool.parallel_for(0, 16, 1, [&pool, &sum](std::size_t outer, std::size_t) {
+            pool.parallel_for(0, 10, 3, [&sum, outer](std::size_t first, std::size_t last) {
+                for (auto i = first; i < last; ++i) { sum += outer * 10 + i; }
+            });
+        });
+        REQUIRE(sum == 160 * 159 / 2);
+    }
+
+    TEST_CASE("mysh::core::thread_pool.parallel_reduce", "[thread_pool]")
+    {
+        auto grain_size = GENERATE(std::size_t{1}, std::size_t{7}, std::size_t{1000});
+        std::vector<float> values(2000);
+        for (std::size_t i = 0; i < values.size(); ++i) { values[i] = 1.0f / static_cast<float>(i + 1); }
+        auto chunk_sum = [&values](std::size_t first, std::size_t last) {
+            auto sum = 0.0f;
+            for (auto i = first; i < last; ++i) { sum += values[i]; }
+            return sum;
+        };
+
+        // the chunk values are combined in order, float sums are the same for any number of threads.
+        ThreadPool serial{{1}};
+        const auto expected = serial.parallel_reduce(3, values.size(), grain_size, 0.0f, chunk_sum, std::plus<>{});
+        for (auto threads : {std::size_t{2}, std::size_t{5}}) {
+            ThreadPool pool{{threads}};
+            REQUIRE(pool.parallel_reduce(3, values.size(), grain_size, 0.0f, chunk_sum, std::plus<>{}) == expected);
+        }
+        REQUIRE(expected == Approx(std::accumulate(values.begin() + 3, values.end(), 0.0f)));
+
+        ThreadPool pool{{3}};
+        auto max = [](std::size_t lhs, std::size_t rhs) { return std::max(lhs, rhs); };
+        auto chunk_last = [](std::size_t, std::size_t last) { return last; };
+        REQUIRE(pool.parallel_reduce(0, 1000, grain_size, std::size_t{0}, chunk_last, max) == 1000);
+        REQUIRE(pool.parallel_reduce(5, 5, grain_size, 42.0f, chunk_sum, std::plus<>{}) == 42.0f);
+    }
+
+    TEST_CASE("mysh::core::thread_pool.exceptions", "[thread_pool]")
+    {
+        auto threads = GENERATE(std::size_t{1}, std::size_t{2}, std::size_t{5});
+        ThreadPool pool{{threads}};
+        auto throw_at = [](std::size_t index) {
+            return [index](std::size_t first, std::size_t last) {
+                if (first <= index && index < last) { throw std::runtime_error{"loop body"}; }
+            };
+        };
+
+        REQUIRE_THROWS_AS(pool.parallel_for(0, 1000, 7, throw_at(500)), std::runtime_error);
+        // a single chunk runs inline, the exception leaves the same way.
+        REQUIRE_THROWS_AS(pool.parallel_for(0, 1, 1, throw_at(0)), std::runtime_error);
+        // an exception of a nested loop passes through the outer loop.
+        REQUIRE_THROWS_AS(pool.parallel_for(0, 16, 1, [&pool, &throw_at](std::size_t outer, std::size_t) {
+            pool.parallel_for(0, 10, 3, throw_at(outer == 11 ? 5 : 10));
+        }), std::runtime_error);
+
+        // the pool keeps working, and loops of the caller run on all threads again.
+        std::mutex mutex;
+        std::set<std::thread::id> workers;
+        std::vector<std::atomic<int>> visits(64);
+        pool.parallel_for(0, visits.size(), 1, [&](std::size_t first, std::size_t last) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            {
+                const std::scoped_lock lock{mutex};
+                workers.insert(std::this_thread::get_id());
+            }
+            for (auto i = first; i < last; ++i) { visits[i] += 1; }
+        });
+        REQUIRE(std::ranges::all_of(visits, [](const std::atomic<int>& visit) { return visit == 1; }));
+        if (threads > 1) { REQUIRE(workers.size() > 1); }
+    }
+}
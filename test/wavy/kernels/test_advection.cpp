@@ -0,0 +1,124 @@
+/**
+ * @file   test_advection.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.25
+ *
+ * @brief  Tests for the batched advection kernels.
+ */
+
+#include "kernels/advection.h"
+#include "utils/padded_span.h"
+
+#include <catch.hpp>
+#include <cmath>
+#include <vector>
+
+namespace wavy::kernels
+{
+    namespace detail
+    {
+        constexpr std::size_t ghost_cells = 2;
+
+        class padded_field
+        {
+        public:
+            template<typename Fn>
+            padded_field(std::size_t size, Fn fn)
+                : m_storage(utils::padded_size(size, ghost_cells), 0.0f)
+                , m_field{m_storage, ghost_cells}
+            {
+                for (std::size_t i = 0; i < size; ++i) { m_field[i] = fn(i); }
+                m_field.fill_ghost_cells();
+            }
+
+            [[nodiscard]] const float* data() const { return &m_field[0]; }
+            [[nodiscard]] std::size_t size() const { return m_field.size(); }
+
+        private:
+            std::vector<float> m_storage;
+            utils::padded_span<float> m_field;
+        };
+
+        std::vector<float> advect(const AdvectionSettings& settings, mysh::core::SimdLevel level,
+                                  const AdvectionFields& fields, std::size_t first, std::size_t count)
+        {
+            std::vector<float> result(count, 0.0f);
+            const SemiLagrangianAdvection advection{settings, level};
+            REQUIRE(advection.level() <= level);
+            advection(fields, first, count, result.data());
+            return result;
+        }
+    }
+
+    TEST_CASE("wavy::kernels::advection.uniform flow", "[advection]")
+    {
+        using enum mysh::core::SimdLevel;
+        auto level = GENERATE(Scalar, AVX2, AVX512);
+        auto interpolation = GENERATE(InterpolationMethod::Linear, InterpolationMethod::Cubic);
+        auto integration = GENERATE(IntegrationMethod::RK2, IntegrationMethod::RK3, IntegrationMethod::RK4);
+        if (level > mysh::core::simd_level()) { return; }
+        const AdvectionSettings settings{interpolation, integration};
+
+        constexpr std::size_t size = 203;
+        constexpr float velocity_value = 2.0f;
+        constexpr float slope = 0.25f;
+        const detail::padded_field velocity{size, [](std::size_t) { return velocity_value; }};
+        const detail::padded_field quantity{size, [](std::size_t i) { return 3.0f + slope * static_cast<float>(i); }};
+        const AdvectionFields fields{velocity.data(), velocity.size(), quantity.data(), quantity.size(), 0.5f, 0.1f};
+
+        auto result = detail::advect(settings, level, fields, 0, size);
+        // the positions move back by 0.4 cells, the first one is clamped to the boundary.
+        REQUIRE(result[0] == Approx(3.0f));
+        for (std::size_t i = 2; i + 2 < size; ++i) {
+            REQUIRE(result[i] == Approx(3.0f + slope * (static_cast<float>(i) - 0.4f)));
+        }
+    }
+
+    TEST_CASE("wavy::kernels::advection.vector kernels match scalar", "[advection]")
+    {
+        using enum mysh::core::SimdLevel;
+        auto level = GENERATE(AVX2, AVX512);
+        auto interpolation = GENERATE(InterpolationMethod::Linear, InterpolationMethod::Cubic);
+        auto integration = GENERATE(IntegrationMethod::RK2, IntegrationMethod::RK3, IntegrationMethod::RK4);
+        if (level > mysh::core::simd_level()) { return; }
+        const AdvectionSettings settings{interpolation, integration};
+
+        constexpr std::size_t size = 1000;
+        const detail::padded_field velocity{size, [](std::size_t i) { return 3.0f * std::sin(0.05f * static_cast<float>(i)); }};
+        const detail::padded_field quantity{size, [](std::size_t i) { return std::cos(0.02f * static_cast<float>(i)); }};
+        const AdvectionFields fields{velocity.data(), velocity.size(), quantity.data(), quantity.size(), 0.01f, 0.004f};
+
+        // an odd start and count exercise the scalar tail after the vector batches.
+        constexpr std::size_t first = 3;
+        constexpr std::size_t count = size - 8;
+        auto expected = detail::advect(settings, Scalar, fields, first, count);
+        auto result = detail::advect(settings, level, fields, first, count);
+        for (std::size_t i = 0; i < count; ++i) { REQUIRE(result[i] == Approx(expected[i]).margin(1e-5)); }
+    }
+
+    TEST_CASE("wavy::kernels::advection.positions beyond float precision", "[advection]")
+    {
+        using enum mysh::core::SimdLevel;
+        auto level = GENERATE(Scalar, AVX2, AVX512);
+        if (level > mysh::core::simd_level()) { return; }
+        const AdvectionSettings settings{InterpolationMethod::Linear, IntegrationMethod::RK2};
+
+        // above 2^24 floats cannot hold every index, positions there are spaced by two cells or more.
+        constexpr std::size_t origin = std::size_t{1} << 24;
+        constexpr std::size_t size = origin + 4096;
+        constexpr float slope = 0.25f;
+        const detail::padded_field velocity{size, [](std::size_t) { return 2.0f; }};
+        const detail::padded_field quantity{size, [](std::size_t i) {
+            return slope * static_cast<float>(static_cast<std::ptrdiff_t>(i) - static_cast<std::ptrdiff_t>(origin));
+        }};
+        const AdvectionFields fields{velocity.data(), velocity.size(), quantity.data(), quantity.size(), 0.5f, 0.1f};
+
+        constexpr std::size_t first = origin + 1001;
+        constexpr std::size_t count = 101;
+        auto result = detail::advect(settings, level, fields, first, count);
+        // every position moves back by 0.4 cells.
+        for (std::size_t i = 0; i < count; ++i) {
+            REQUIRE(result[i] == Approx(slope * (static_cast<float>(first + i - origin) - 0.4f)).margin(1e-4));
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * @file   test_multigrid.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.23
+ *
+ * @brief  Tests for the geometric multigrid pressure solver.
+ */
+
+#include "solver/multigrid.h"
+
+#include <catch.hpp>
+#include <cmath>
+#include <vector>
+
+namespace wavy::solver
+{
+    namespace detail
+    {
+        /** Fluid column with some solid obstacles, with air on the right unless the boundary cells are already air. */
+        struct labeled_problem
+        {
+            explicit labeled_problem(std::size_t size, CellLabel boundary = CellLabel::SOLID)
+                : labels(size, CellLabel::FLUID)
+                , diag(size, 0.0f)
+                , plus(size, 0.0f)
+                , rhs(size, 0.0f)
+            {
+                if (boundary != CellLabel::EMPTY) {
+                    for (std::size_t i = size - size / 8; i < size; ++i) { labels[i] = CellLabel::EMPTY; }
+                }
+                labels[size / 3] = CellLabel::SOLID;
+                labels[size / 4] = CellLabel::EMPTY;
+
+                auto label_at = [this, boundary](std::size_t i, std::ptrdiff_t offset) {
+                    auto j = static_cast<std::ptrdiff_t>(i) + offset;
+                    if (j < 0 || j >= static_cast<std::ptrdiff_t>(labels.size())) { return boundary; }
+                    return labels[static_cast<std::size_t>(j)];
+                };
+                for (std::size_t i = 0; i < size; ++i) {
+                    if (labels[i] != CellLabel::FLUID) { continue; }
+                    if (label_at(i, -1) != CellLabel::SOLID) { diag[i] += scale; }
+                    if (label_at(i, 1) != CellLabel::SOLID) { diag[i] += scale; }
+                    if (label_at(i, 1) == CellLabel::FLUID) { plus[i] = -scale; }
+                }
+
+                // manufactured solution with rough and smooth components.
+                std::vector<float> p_exact(size, 0.0f);
+                for (std::size_t i = 0; i < size; ++i) {
+                    if (labels[i] != CellLabel::FLUID) { continue; }
+                    p_exact[i] = std::sin(static_cast<float>(i) * 0.37f) + std::cos(static_cast<float>(i) * 0.0011f);
+                }
+                for (std::size_t i = 0; i < size; ++i) { rhs[i] = stencil().apply(p_exact, i); }
+            }
+
+            [[nodiscard]] PoissonStencil<1> stencil() const { return PoissonStencil<1>{diag, {plus}, {1}}; }
+
+            [[nodiscard]] float max_residual(std::span<const float> p) const
+            {
+                auto result = 0.0f;
+                auto A = stencil();
+                for (std::size_t i = 0; i < rhs.size(); ++i) {
+                    if (labels[i] == CellLabel::FLUID) { result = std::max(result, std::abs(A.apply(p, i) - rhs[i])); }
+                }
+                return result;
+            }
+
+            constexpr static float scale = 4.0f;
+            std::vector<CellLabel> labels;
+            std::vector<float> diag;
+            std::vector<float> plus;
+            std::vector<float> rhs;
+        };
+    }
+
+    TEST_CASE("wavy::solver::MultigridSolver.grid independent convergence", "[multigrid]")
+    {
+        auto cycle = GENERATE(MultigridCycle::V, MultigridCycle::F);
+        std::size_t previous_iterations = 0;
+        for (std::size_t size : {std::size_t{1000}, std::size_t{16000}, std::size_t{256000}}) {
+            detail::labeled_problem problem{size};
+            std::vector<float> p(size);
+
+            MultigridSolver solver{size, {.cycle = cycle, .tolerance = 1e-4f}};
+            solver.setup(problem.labels, detail::labeled_problem::scale);
+            auto result = solver.solve(problem.stencil(), problem.rhs, p);
+
+            REQUIRE(result.converged);
+            REQUIRE(result.iterations <= 12);
+            REQUIRE(problem.max_residual(p) < 1e-3f);
+            if (previous_iterations > 0) { REQUIRE(result.iterations <= previous_iterations + 2); }
+            previous_iterations = result.iterations;
+        }
+    }
+
+    TEST_CASE("wavy::solver::MultigridSolver.preconditioner", "[multigrid][pcg]")
+    {
+        constexpr std::size_t size = 5000;
+        detail::labeled_problem problem{size};
+        std::vector<float> p(size);
+
+        MultigridSolver solver{size, {.as_preconditioner = true}, {.tolerance = 1e-4f}};
+        solver.setup(problem.labels, detail::labeled_problem::scale);
+        auto result = solver.solve(problem.stencil(), problem.rhs, p);
+
+        REQUIRE(result.converged);
+        REQUIRE(result.iterations <= 8);
+        auto A = problem.stencil();
+        for (std::size_t i = 0; i < size; ++i) {
+            if (problem.labels[i] != CellLabel::FLUID) {
+                REQUIRE(p[i] == 0.0f);
+                continue;
+            }
+            REQUIRE(A.apply(p, i) == Approx(problem.rhs[i]).margin(1e-3));
+        }
+    }
+
+    TEST_CASE("wavy::solver::MultigridSolver.empty boundary", "[multigrid]")
+    {
+        // open boundary faces on both ends, the interpolation must not look for coarse cells outside of the grid.
+        auto size = GENERATE(std::size_t{17}, std::size_t{999}, std::size_t{1000}, std::size_t{1024});
+        detail::labeled_problem problem{size, CellLabel::EMPTY};
+        std::vector<float> p(size);
+
+        MultigridSolver solver{size, {.tolerance = 1e-4f, .boundary_label = CellLabel::EMPTY}};
+        solver.setup(problem.labels, detail::labeled_problem::scale);
+        auto result = solver.solve(problem.stencil(), problem.rhs, p);
+
+        REQUIRE(result.converged);
+        REQUIRE(result.iterations <= 12);
+        REQUIRE(problem.max_residual(p) < 1e-3f);
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file   test_pcg.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.21
+ *
+ * @brief  Tests for the preconditioned conjugate gradient pressure solver.
+ */
+
+#include "solver/pcg.h"
+
+#include <catch.hpp>
+#include <cmath>
+#include <vector>
+
+namespace wavy::solver
+{
+    namespace detail
+    {
+        float max_residual(const PoissonStencil<2>& A, std::span<const float> p, std::span<const float> rhs)
+        {
+            auto result = 0.0f;
+            for (std::size_t i = 0; i < rhs.size(); ++i) { result = std::max(result, std::abs(A.apply(p, i) - rhs[i])); }
+            return result;
+        }
+    }
+
+    TEST_CASE("wavy::solver::PCGSolver.1d dirichlet", "[pcg]")
+    {
+        constexpr std::size_t size = 100;
+        std::vector<float> diag(size, 2.0f);
+        std::vector<float> plus(size, -1.0f);
+        plus.back() = 0.0f;
+        PoissonStencil<1> A{diag, {plus}, {1}};
+
+        std::vector<float> p_exact(size);
+        for (std::size_t i = 0; i < size; ++i) { p_exact[i] = std::sin(static_cast<float>(i) * 0.1f); }
+        std::vector<float> rhs(size);
+        for (std::size_t i = 0; i < size; ++i) { rhs[i] = A.apply(p_exact, i); }
+
+        std::vector<float> p(size);
+        PCGSolver<1> solver{size, {.tolerance = 1e-6f, .max_iterations = 50}};
+        auto result = solver.solve(A, rhs, p);
+
+        REQUIRE(result.converged);
+        // MIC(0) of a tridiagonal matrix is its exact Cholesky factorization.
+        REQUIRE(result.iterations <= 2);
+        for (std::size_t i = 0; i < size; ++i) { REQUIRE(p[i] == Approx(p_exact[i]).margin(1e-3)); }
+    }
+
+    TEST_CASE("wavy::solver::PCGSolver.2d with empty cells", "[pcg]")
+    {
+        constexpr std::size_t nx = 32;
+        constexpr std::size_t ny = 32;
+        std::vector<float> diag(nx * ny, 0.0f);
+        std::vector<float> plus_x(nx * ny, 0.0f);
+        std::vector<float> plus_y(nx * ny, 0.0f);
+        // fluid in all cells except the top rows; the domain walls are solid and the top is air.
+        auto is_fluid = [](std::size_t x, std::size_t y) { return x < nx && y < ny - 4; };
+        for (std::size_t y = 0; y < ny; ++y) {
+            for (std::size_t x = 0; x < nx; ++x) {
+                if (!is_fluid(x, y)) { continue; }
+                auto i = y * nx + x;
+                if (x > 0) { diag[i] += 1.0f; }
+                if (x + 1 < nx) {
+                    diag[i] += 1.0f;
+                    plus_x[i] = -1.0f;
+                }
+                if (y > 0) { diag[i] += 1.0f; }
+                diag[i] += 1.0f;
+                if (is_fluid(x, y + 1)) { plus_y[i] = -1.0f; }
+            }
+        }
+        PoissonStencil<2> A{diag, {plus_x, plus_y}, {1, nx}};
+
+        std::vector<float> rhs(nx * ny, 0.0f);
+        for (std::size_t i = 0; i < rhs.size(); ++i) {
+            if (diag[i] != 0.0f) { rhs[i] = std::cos(static_cast<float>(i)); }
+        }
+
+        std::vector<float> p(nx * ny);
+        PCGSolver<2> solver{nx * ny, {.tolerance = 1e-5f, .max_iterations = 200}};
+        auto result = solver.solve(A, rhs, p);
+
+        REQUIRE(result.converged);
+        REQUIRE(result.iterations < 60);
+        REQUIRE(detail::max_residual(A, p, rhs) < 1e-3f);
+    }
+
+    TEST_CASE("wavy::solver::PCGSolver.thread pools", "[pcg]")
+    {
+        // the reductions combine their chunks in order, so the solve does not depend on the threads of the pool.
+        constexpr std::size_t n = 256;
+        std::vector<float> diag(n * n, 4.0f);
+        std::vector<float> plus_x(n * n, -1.0f);
+        std::vector<float> plus_y(n * n, -1.0f);
+        for (std::size_t i = 0; i < n; ++i) {
+            plus_x[i * n + n - 1] = 0.0f;
+            plus_y[(n - 1) * n + i] = 0.0f;
+        }
+        PoissonStencil<2> A{diag, {plus_x, plus_y}, {1, n}};
+        std::vector<float> rhs(n * n);
+        for (std::size_t i = 0; i < rhs.size(); ++i) { rhs[i] = std::cos(static_cast<float>(i)); }
+
+        PCGSolver<2> solver{n * n, {.tolerance = 1e-5f, .max_iterations = 400}};
+        mysh::core::ThreadPool serial{{1}};
+        solver.setThreadPool(serial);
+        std::vector<float> p_serial(n * n);
+        auto result_serial = solver.solve(A, rhs, p_serial);
+
+        mysh::core::ThreadPool pool{{4}};
+        solver.setThreadPool(pool);
+        std::vector<float> p(n * n);
+        auto result = solver.solve(A, rhs, p);
+
+        REQUIRE(result_serial.converged);
+        REQUIRE(result.iterations == result_serial.iterations);
+        REQUIRE(result.residual == result_serial.residual);
+        REQUIRE(p == p_serial);
+        REQUIRE(detail::max_residual(A, p, rhs) < 1e-3f);
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ * @file   test_tridiagonal.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.22
+ *
+ * @brief  Tests for the direct tridiagonal pressure solvers.
+ */
+
+#include "solver/tridiagonal.h"
+
+#include <catch.hpp>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace wavy::solver
+{
+    namespace detail
+    {
+        /** Poisson matrix of a chain of fluid cells with a solid wall on the left and an optional empty cell on the right. */
+        struct tridiagonal_problem
+        {
+            tridiagonal_problem(std::size_t size, bool open_right)
+                : diag(size, 2.0f)
+                , plus(size, -1.0f)
+                , rhs(size)
+            {
+                diag.front() = 1.0f;
+                if (!open_right) { diag.back() = 1.0f; }
+                plus.back() = 0.0f;
+                for (std::size_t i = 0; i < size; ++i) { rhs[i] = std::sin(static_cast<float>(i) * 0.37f); }
+                if (!open_right) {
+                    // make the singular system consistent.
+                    auto mean = std::reduce(std::begin(rhs), std::end(rhs)) / static_cast<float>(size);
+                    for (auto& v : rhs) { v -= mean; }
+                }
+            }
+
+            [[nodiscard]] PoissonStencil<1> stencil() const { return PoissonStencil<1>{diag, {plus}, {1}}; }
+
+            [[nodiscard]] float max_residual(std::span<const float> p) const
+            {
+                auto result = 0.0f;
+                auto A = stencil();
+                for (std::size_t i = 0; i < rhs.size(); ++i) { result = std::max(result, std::abs(A.apply(p, i) - rhs[i])); }
+                return result;
+            }
+
+            std::vector<float> diag;
+            std::vector<float> plus;
+            std::vector<float> rhs;
+        };
+    }
+
+    TEST_CASE("wavy::solver::TridiagonalSolver.thomas and cyclic reduction agree", "[tridiagonal]")
+    {
+        auto size = GENERATE(std::size_t{1}, std::size_t{2}, std::size_t{7}, std::size_t{64}, std::size_t{100},
+                             std::size_t{1023}, std::size_t{1025});
+        detail::tridiagonal_problem problem{size, true};
+
+        std::vector<float> p_thomas(size);
+        std::vector<float> p_cr(size);
+        TridiagonalSolver solver{size};
+        solver.solveThomas(problem.stencil(), problem.rhs, p_thomas);
+        solver.solveCyclicReduction(problem.stencil(), problem.rhs, p_cr);
+
+        REQUIRE(problem.max_residual(p_thomas) < 1e-2f);
+        REQUIRE(problem.max_residual(p_cr) < 1e-2f);
+        for (std::size_t i = 0; i < size; ++i) {
+            REQUIRE(p_cr[i] == Approx(p_thomas[i]).epsilon(1e-3).margin(1e-2));
+        }
+    }
+
+    TEST_CASE("wavy::solver::TridiagonalSolver.singular closed domain", "[tridiagonal]")
+    {
+        constexpr std::size_t size = 200;
+        detail::tridiagonal_problem problem{size, false};
+
+        std::vector<float> p(size);
+        TridiagonalSolver solver{size};
+        solver.solveThomas(problem.stencil(), problem.rhs, p);
+        REQUIRE(problem.max_residual(p) < 1e-2f);
+
+        solver.solveCyclicReduction(problem.stencil(), problem.rhs, p);
+        REQUIRE(problem.max_residual(p) < 1e-2f);
+    }
+
+    TEST_CASE("wavy::solver::TridiagonalSolver.non-fluid cells", "[tridiagonal]")
+    {
+        constexpr std::size_t size = 10;
+        std::vector<float> diag{0.0f, 1.0f, 2.0f, 2.0f, 1.0f, 0.0f, 0.0f, 2.0f, 2.0f, 0.0f};
+        std::vector<float> plus{0.0f, -1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f};
+        std::vector<float> rhs{5.0f, 1.0f, 0.0f, 0.0f, -1.0f, 5.0f, 5.0f, 1.0f, 2.0f, 5.0f};
+        PoissonStencil<1> A{diag, {plus}, {1}};
+
+        std::vector<float> p_thomas(size);
+        std::vector<float> p_cr(size);
+        TridiagonalSolver solver{size};
+        solver.solveThomas(A, rhs, p_thomas);
+        solver.solveCyclicReduction(A, rhs, p_cr);
+        for (std::size_t i = 0; i < size; ++i) {
+            if (diag[i] == 0.0f) {
+                REQUIRE(p_thomas[i] == 0.0f);
+                REQUIRE(p_cr[i] == 0.0f);
+            } else {
+                REQUIRE(A.apply(p_thomas, i) == Approx(rhs[i]).margin(1e-4));
+                REQUIRE(A.apply(p_cr, i) == Approx(rhs[i]).margin(1e-4));
+            }
+        }
+    }
+
+    TEST_CASE("wavy::solver::TridiagonalSolver.empty system", "[tridiagonal]")
+    {
+        std::vector<float> diag;
+        std::vector<float> plus;
+        std::vector<float> rhs;
+        std::vector<float> p;
+        PoissonStencil<1> A{diag, {plus}, {1}};
+
+        TridiagonalSolver solver{0};
+        REQUIRE(solver.solveThomas(A, rhs, p).converged);
+        REQUIRE(solver.solveCyclicReduction(A, rhs, p).converged);
+        REQUIRE(solver.solve(A, rhs, p).converged);
+    }
+}
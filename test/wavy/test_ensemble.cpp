@@ -0,0 +1,112 @@
+/**
+ * @file   test_ensemble.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.10
+ *
+ * @brief  Tests for the ensemble of 1d simulations.
+ */
+
+#include "ensemble.h"
+
+#include <catch.hpp>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace wavy
+{
+    namespace detail
+    {
+        constexpr std::size_t ensemble_grid_size = 128;
+        constexpr std::size_t ensemble_frame_count = 6;
+        constexpr float ensemble_frame_time = 1.0f / 60.0f;
+
+        /** A water column with air above it and a solid obstacle in the air. */
+        std::vector<CellLabel> ensemble_labels()
+        {
+            std::vector<CellLabel> labels(ensemble_grid_size, CellLabel::FLUID);
+            std::fill(labels.begin() + 80, labels.end(), CellLabel::EMPTY);
+            labels[100] = CellLabel::SOLID;
+            return labels;
+        }
+
+        /** A sweep over cell size, gravity and density. */
+        std::vector<EnsembleMember> ensemble_members()
+        {
+            std::vector<EnsembleMember> members;
+            for (auto delta_x : {0.01f, 0.02f}) {
+                for (auto g : {9.81f, -9.81f, 3.71f}) {
+                    for (auto density : {1000.0f, 800.0f}) { members.push_back({delta_x, g, density}); }
+                }
+            }
+            return members;
+        }
+    }
+
+    TEST_CASE("wavy::Ensemble.members match single runs", "[ensemble]")
+    {
+        const auto labels = detail::ensemble_labels();
+        EnsembleSettings settings;
+        settings.grid_size = detail::ensemble_grid_size;
+        settings.labels = labels;
+        settings.pressure.method = GENERATE(solver::PressureSolverMethod::Tridiagonal, solver::PressureSolverMethod::PCG,
+                                            solver::PressureSolverMethod::Multigrid);
+
+        mysh::core::ThreadPool pool{{4}};
+        Ensemble ensemble{settings, detail::ensemble_members(), pool};
+
+        // every member is only observed by the worker running it, so the observer needs no locks.
+        std::vector<std::vector<std::size_t>> observed_frames(ensemble.size());
+        std::vector<std::vector<float>> velocities(ensemble.size());
+        auto record = [&](std::size_t member, std::size_t frame, const FluidSolver1D& solver) {
+            observed_frames[member].push_back(frame);
+            velocities[member].assign(solver.velocity().begin(), solver.velocity().end());
+        };
+        const auto results =
+            ensemble.run(detail::ensemble_frame_count, detail::ensemble_frame_time, Ensemble::FrameObserver{record});
+        REQUIRE(results.size() == ensemble.size());
+
+        std::vector<std::size_t> all_frames(detail::ensemble_frame_count);
+        std::iota(all_frames.begin(), all_frames.end(), std::size_t{0});
+        for (std::size_t index = 0; index < ensemble.size(); ++index) {
+            REQUIRE(observed_frames[index] == all_frames);
+
+            const auto& member = ensemble.member(index);
+            FluidSolver1D single{settings.grid_size, member.delta_x, member.g, member.density, settings.pressure,
+                                 settings.advection};
+            single.setLabels(labels);
+            std::size_t substeps = 0;
+            for (std::size_t frame = 0; frame < detail::ensemble_frame_count; ++frame) {
+                single.solveNextStep(detail::ensemble_frame_time);
+                substeps += single.lastSubsteps();
+            }
+
+            // the reductions of the solvers combine their chunks in order, the results match bit for bit.
+            REQUIRE(results[index].time == single.time());
+            REQUIRE(results[index].substeps == substeps);
+            REQUIRE(results[index].last_pressure_solve.iterations == single.lastPressureSolve().iterations);
+            REQUIRE(results[index].last_pressure_solve.residual == single.lastPressureSolve().residual);
+            REQUIRE(results[index].last_pressure_solve.converged == single.lastPressureSolve().converged);
+            REQUIRE(std::ranges::equal(velocities[index], single.velocity()));
+        }
+    }
+
+    TEST_CASE("wavy::Ensemble.empty runs", "[ensemble]")
+    {
+        EnsembleSettings settings;
+        settings.grid_size = detail::ensemble_grid_size;
+        mysh::core::ThreadPool pool{{2}};
+
+        std::size_t calls = 0;
+        auto count_calls = [&calls](std::size_t, std::size_t, const FluidSolver1D&) { ++calls; };
+        const Ensemble::FrameObserver count{count_calls};
+        Ensemble no_members{settings, {}, pool};
+        REQUIRE(no_members.run(detail::ensemble_frame_count, detail::ensemble_frame_time, count).empty());
+
+        Ensemble members{settings, detail::ensemble_members(), pool};
+        const auto results = members.run(0, detail::ensemble_frame_time, count);
+        REQUIRE(results.size() == members.size());
+        REQUIRE(std::ranges::all_of(results, [](const EnsembleResult& result) { return result.substeps == 0; }));
+        REQUIRE(calls == 0);
+    }
+}
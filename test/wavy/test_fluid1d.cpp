@@ -0,0 +1,63 @@
+/**
+ * @file   test_fluid1d.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.09
+ *
+ * @brief  Tests for the 1d fluid solver.
+ */
+
+#include "fluid1d.h"
+
+#include <catch.hpp>
+#include <cmath>
+#include <limits>
+
+namespace wavy
+{
+    namespace detail
+    {
+        constexpr std::size_t tank_size = 64;
+        constexpr float tank_delta_x = 0.01f;
+        constexpr float water_density = 1000.0f;
+    }
+
+    TEST_CASE("wavy::FluidSolver1D.substeps of a frame", "[fluid1d][substeps]")
+    {
+        // a closed tank at rest keeps the gravity wave speed as the only limit, sqrt(5 delta_x / |g|) ~ 0.0714 s.
+        auto g = GENERATE(9.81f, -9.81f);
+        FluidSolver1D solver{detail::tank_size, detail::tank_delta_x, g, detail::water_density};
+
+        // 0.25 s are 3.5 stable steps: two full steps and the rest split in two.
+        solver.solveNextStep(0.25f);
+        REQUIRE(solver.lastSubsteps() == 4);
+        REQUIRE(solver.time() == Approx(0.25f));
+
+        solver.solveNextStep(1.0f / 60.0f);
+        REQUIRE(solver.lastSubsteps() == 1);
+        REQUIRE(solver.time() == Approx(0.25f + 1.0f / 60.0f));
+        for (auto u : solver.velocity()) { REQUIRE(std::isfinite(u)); }
+    }
+
+    TEST_CASE("wavy::FluidSolver1D.substeps without gravity", "[fluid1d][substeps]")
+    {
+        // nothing limits the step of a fluid at rest, the frame is one step.
+        FluidSolver1D solver{detail::tank_size, detail::tank_delta_x, 0.0f, detail::water_density};
+        solver.solveNextStep(0.5f);
+        REQUIRE(solver.lastSubsteps() == 1);
+        REQUIRE(solver.time() == Approx(0.5f));
+        for (auto u : solver.velocity()) { REQUIRE(u == Approx(0.0f).margin(1e-6)); }
+    }
+
+    TEST_CASE("wavy::FluidSolver1D.empty frames", "[fluid1d][substeps]")
+    {
+        auto delta_t_frame = GENERATE(0.0f, -0.1f, std::numeric_limits<float>::quiet_NaN(),
+                                      std::numeric_limits<float>::infinity());
+        FluidSolver1D solver{detail::tank_size, detail::tank_delta_x, 9.81f, detail::water_density};
+        solver.solveNextStep(1.0f / 60.0f);
+        const auto time = solver.time();
+
+        solver.solveNextStep(delta_t_frame);
+        REQUIRE(solver.lastSubsteps() == 0);
+        REQUIRE(solver.time() == time);
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * @file   test_fluid2d.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.09
+ *
+ * @brief  Tests for the 2d fluid solver.
+ */
+
+#include "fluid2d.h"
+
+#include <catch.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace wavy
+{
+    namespace detail
+    {
+        constexpr std::size_t tank_size_x = 48;
+        constexpr std::size_t tank_size_y = 40;
+        constexpr std::size_t water_height = 24;
+        constexpr float tank_delta_x = 0.01f;
+        constexpr float water_density = 1000.0f;
+        constexpr float gravity = -9.81f;
+
+        /** Gives the tests access to the labels and the projection of the solver. */
+        class TestSolver2D : public FluidSolver2D
+        {
+        public:
+            TestSolver2D() : FluidSolver2D{tank_size_x, tank_size_y, tank_delta_x, gravity, water_density}
+            {
+                // water in the lower rows, air above it, everything enclosed by the solid walls.
+                std::vector<CellLabel> labels(tank_size_x * tank_size_y, CellLabel::FLUID);
+                std::fill(labels.begin() + static_cast<std::ptrdiff_t>(water_height * tank_size_x), labels.end(),
+                          CellLabel::EMPTY);
+                setLabels(labels);
+            }
+
+            using FluidSolver2D::project;
+
+            [[nodiscard]] bool isFluid(std::size_t i, std::size_t j) const
+            {
+                return label({static_cast<std::ptrdiff_t>(i), static_cast<std::ptrdiff_t>(j)}) == CellLabel::FLUID;
+            }
+        };
+
+        /** Random face velocities u and v. */
+        std::array<std::vector<float>, 2> random_velocity_2d()
+        {
+            std::mt19937 generator{42}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+            std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+            std::array<std::vector<float>, 2> result{std::vector<float>((tank_size_x + 1) * tank_size_y),
+                                                     std::vector<float>(tank_size_x * (tank_size_y + 1))};
+            for (auto& q : result) {
+                std::ranges::generate(q, [&] { return distribution(generator); });
+            }
+            return result;
+        }
+
+        /** Returns the largest divergence of the velocity (u, v) in a fluid cell, in 1 / s. */
+        float max_fluid_divergence(const TestSolver2D& solver, std::span<const float> u, std::span<const float> v)
+        {
+            float result = 0.0f;
+            for (std::size_t j = 0; j < tank_size_y; ++j) {
+                for (std::size_t i = 0; i < tank_size_x; ++i) {
+                    if (!solver.isFluid(i, j)) { continue; }
+                    auto u_lower = u[j * (tank_size_x + 1) + i];
+                    auto u_upper = u[j * (tank_size_x + 1) + i + 1];
+                    auto v_lower = v[j * tank_size_x + i];
+                    auto v_upper = v[(j + 1) * tank_size_x + i];
+                    result = std::max(result, std::abs((u_upper - u_lower + v_upper - v_lower) / tank_delta_x));
+                }
+            }
+            return result;
+        }
+    }
+
+    TEST_CASE("wavy::FluidSolver2D.hydrostatic rest", "[fluid2d]")
+    {
+        // gravity is balanced by the pressure gradient alone, the water in the closed tank stays at rest.
+        detail::TestSolver2D solver;
+        solver.solveNextStep(1.0f / 30.0f);
+        const auto substeps = solver.lastSubsteps();
+        for (std::size_t frame = 1; frame < 10; ++frame) {
+            solver.solveNextStep(1.0f / 30.0f);
+            REQUIRE(solver.lastSubsteps() == substeps);
+        }
+
+        // the faces in the air above the water do not pick up gravity either.
+        REQUIRE(solver.time() == Approx(10.0f / 30.0f));
+        for (auto u : solver.velocityX()) { REQUIRE(u == Approx(0.0f).margin(1e-4)); }
+        for (auto v : solver.velocityY()) { REQUIRE(v == Approx(0.0f).margin(1e-4)); }
+
+        // the pressure grows linearly with the depth below the surface, which lies half a cell below the air.
+        const auto pressure_step = detail::water_density * std::abs(detail::gravity) * detail::tank_delta_x;
+        for (std::size_t j = 0; j < detail::water_height; ++j) {
+            auto expected = pressure_step * static_cast<float>(detail::water_height - j);
+            for (std::size_t i = 0; i < detail::tank_size_x; ++i) {
+                REQUIRE(solver.pressure()[j * detail::tank_size_x + i] == Approx(expected).epsilon(1e-3));
+            }
+        }
+    }
+
+    TEST_CASE("wavy::FluidSolver2D.divergence after project", "[fluid2d]")
+    {
+        detail::TestSolver2D solver;
+        auto [u, v] = detail::random_velocity_2d();
+        REQUIRE(detail::max_fluid_divergence(solver, u, v) > 1.0f);
+
+        auto delta_t = GENERATE(0.001f, 0.02f);
+        solver.project(delta_t, {u, v});
+
+        REQUIRE(solver.lastPressureSolve().converged);
+        // the rhs is up to 4 / delta_x, the solver reduces the residual by the tolerance relative to it.
+        REQUIRE(detail::max_fluid_divergence(solver, u, v) < 1e-2f);
+        // walls next to the water are at rest after the projection.
+        for (std::size_t j = 0; j < detail::water_height; ++j) {
+            REQUIRE(u[j * (detail::tank_size_x + 1)] == 0.0f);
+            REQUIRE(u[j * (detail::tank_size_x + 1) + detail::tank_size_x] == 0.0f);
+        }
+        for (std::size_t i = 0; i < detail::tank_size_x; ++i) { REQUIRE(v[i] == 0.0f); }
+    }
+}
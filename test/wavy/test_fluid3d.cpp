@@ -0,0 +1,181 @@
+/**
+ * @file   test_fluid3d.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.09
+ *
+ * @brief  Tests for the 3d fluid solver and its active bricks.
+ */
+
+#include "fluid3d.h"
+
+#include <catch.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace wavy
+{
+    namespace detail
+    {
+        constexpr std::array<std::size_t, 3> tank_size = {32, 16, 16};
+        constexpr float tank_delta_x = 0.01f;
+        constexpr float water_density = 1000.0f;
+        constexpr float gravity = -9.81f;
+        constexpr float frame_time = 1.0f / 60.0f;
+
+        /** Gives the tests access to the active bricks of the solver. */
+        class TestSolver3D : public FluidSolver3D
+        {
+        public:
+            TestSolver3D()
+                : FluidSolver3D{tank_size[0], tank_size[1], tank_size[2], tank_delta_x, gravity, water_density}
+            {
+            }
+
+            /** Visits every brick, as a solver without the brick optimization would. */
+            void activateAllBricks()
+            {
+                auto activate = [](BrickSet& set) {
+                    set.active.resize(set.bricks.size());
+                    std::iota(set.active.begin(), set.active.end(), std::size_t{0});
+                };
+                activate(cellBricks());
+                for (std::size_t d = 0; d < 3; ++d) { activate(faceBricks(d)); }
+            }
+        };
+
+        /** Labels with fluid in the box [first, last), the cells in front of solid_x are empty, the rest solid. */
+        std::vector<CellLabel> box_labels(const std::array<std::size_t, 3>& first,
+                                          const std::array<std::size_t, 3>& last, std::size_t solid_x = tank_size[0])
+        {
+            std::vector<CellLabel> labels(tank_size[0] * tank_size[1] * tank_size[2], CellLabel::EMPTY);
+            for (std::size_t k = 0; k < tank_size[2]; ++k) {
+                for (std::size_t j = 0; j < tank_size[1]; ++j) {
+                    for (std::size_t i = 0; i < tank_size[0]; ++i) {
+                        auto& label = labels[i + tank_size[0] * (j + tank_size[1] * k)];
+                        if (i >= solid_x) { label = CellLabel::SOLID; }
+                        if (i >= first[0] && i < last[0] && j >= first[1] && j < last[1] && k >= first[2]
+                            && k < last[2]) {
+                            label = CellLabel::FLUID;
+                        }
+                    }
+                }
+            }
+            return labels;
+        }
+
+        /** Returns the faces of component dim with all coordinates below extent, which form the first face brick. */
+        std::vector<std::size_t> first_brick_faces(std::size_t dim, std::size_t extent)
+        {
+            std::array<std::size_t, 3> sizes = tank_size;
+            sizes[dim] += 1;
+            std::vector<std::size_t> result;
+            for (std::size_t k = 0; k < extent; ++k) {
+                for (std::size_t j = 0; j < extent; ++j) {
+                    for (std::size_t i = 0; i < extent; ++i) { result.push_back(i + sizes[0] * (j + sizes[1] * k)); }
+                }
+            }
+            return result;
+        }
+    }
+
+    TEST_CASE("wavy::FluidSolver3D.sparse step matches dense step", "[fluid3d][bricks]")
+    {
+        // a water column collapsing in the first brick column, the right half of the tank is solid.
+        const auto labels = detail::box_labels({0, 0, 0}, {5, 6, 16}, 16);
+        detail::TestSolver3D sparse;
+        detail::TestSolver3D dense;
+        sparse.setLabels(labels);
+        dense.setLabels(labels);
+        dense.activateAllBricks();
+        REQUIRE(sparse.activeBricks() == 2);
+        REQUIRE(dense.activeBricks() == 16);
+
+        for (std::size_t frame = 0; frame < 4; ++frame) {
+            sparse.solveNextStep(detail::frame_time);
+            dense.solveNextStep(detail::frame_time);
+        }
+
+        // skipped bricks hold no fluid and no moving faces, so both solvers compute the same values everywhere.
+        REQUIRE(sparse.lastSubsteps() == dense.lastSubsteps());
+        REQUIRE(std::ranges::equal(sparse.pressure(), dense.pressure()));
+        for (std::size_t d = 0; d < 3; ++d) {
+            REQUIRE(std::ranges::any_of(sparse.velocity(d), [](float q) { return q != 0.0f; }));
+            REQUIRE(std::ranges::equal(sparse.velocity(d), dense.velocity(d)));
+        }
+    }
+
+    TEST_CASE("wavy::FluidSolver3D.bricks follow the fluid", "[fluid3d][bricks]")
+    {
+        detail::TestSolver3D solver;
+        REQUIRE(solver.activeBricks() == 16);
+
+        solver.setLabels(detail::box_labels({0, 0, 0}, {6, 6, 6}));
+        REQUIRE(solver.activeBricks() == 1);
+        solver.setLabels(detail::box_labels({18, 0, 0}, {24, 6, 6}));
+        REQUIRE(solver.activeBricks() == 1);
+        solver.setLabels(detail::box_labels({6, 6, 0}, {10, 10, 6}));
+        REQUIRE(solver.activeBricks() == 4);
+        solver.setLabels(detail::box_labels({0, 0, 0}, {0, 0, 0}));
+        REQUIRE(solver.activeBricks() == 0);
+        solver.solveNextStep(detail::frame_time);
+        REQUIRE(solver.time() == Approx(detail::frame_time));
+    }
+
+    TEST_CASE("wavy::FluidSolver3D.velocities of inactive bricks", "[fluid3d][bricks]")
+    {
+        // the water collapses in the corner of the first brick and sets its faces in motion.
+        detail::TestSolver3D solver;
+        solver.setLabels(detail::box_labels({0, 0, 0}, {6, 6, 6}));
+        for (std::size_t frame = 0; frame < 2; ++frame) { solver.solveNextStep(detail::frame_time); }
+
+        std::array<std::vector<float>, 3> moving;
+        for (std::size_t d = 0; d < 3; ++d) {
+            for (auto face : detail::first_brick_faces(d, 8)) { moving[d].push_back(solver.velocity(d)[face]); }
+            REQUIRE(std::ranges::any_of(moving[d], [](float q) { return std::abs(q) > 1e-3f; }));
+        }
+
+        SECTION("bricks that stay active keep their velocities")
+        {
+            auto labels = detail::box_labels({0, 0, 0}, {6, 6, 6});
+            const auto far = detail::box_labels({18, 0, 0}, {24, 6, 6});
+            std::ranges::transform(labels, far, labels.begin(), [](CellLabel lhs, CellLabel rhs) {
+                return lhs == CellLabel::FLUID || rhs == CellLabel::FLUID ? CellLabel::FLUID : CellLabel::EMPTY;
+            });
+            solver.setLabels(labels);
+            REQUIRE(solver.activeBricks() == 2);
+            for (std::size_t d = 0; d < 3; ++d) {
+                auto faces = detail::first_brick_faces(d, 8);
+                for (std::size_t i = 0; i < faces.size(); ++i) {
+                    REQUIRE(solver.velocity(d)[faces[i]] == moving[d][i]);
+                }
+            }
+        }
+
+        SECTION("bricks that become inactive are cleared")
+        {
+            solver.setLabels(detail::box_labels({18, 0, 0}, {24, 6, 6}));
+            REQUIRE(solver.activeBricks() == 1);
+            for (std::size_t d = 0; d < 3; ++d) {
+                for (auto face : detail::first_brick_faces(d, 8)) { REQUIRE(solver.velocity(d)[face] == 0.0f); }
+            }
+            for (std::size_t k = 0; k < 8; ++k) {
+                for (std::size_t j = 0; j < 8; ++j) {
+                    for (std::size_t i = 0; i < 8; ++i) {
+                        auto cell = i + detail::tank_size[0] * (j + detail::tank_size[1] * k);
+                        REQUIRE(solver.pressure()[cell] == 0.0f);
+                    }
+                }
+            }
+
+            // the solver carries on with the moved water alone.
+            solver.solveNextStep(detail::frame_time);
+            REQUIRE(solver.lastPressureSolve().converged);
+            for (std::size_t d = 0; d < 3; ++d) {
+                for (auto face : detail::first_brick_faces(d, 8)) { REQUIRE(solver.velocity(d)[face] == 0.0f); }
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * @file   test_fluid_base.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.09
+ *
+ * @brief  Tests for the parts shared by the fluid solvers.
+ */
+
+#include "fluid_base.h"
+
+#include <catch.hpp>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace wavy
+{
+    namespace detail
+    {
+        std::vector<float> schedule_frame(float delta_t_max, float delta_t_frame)
+        {
+            std::vector<float> steps;
+            float t = 0.0f;
+            for (bool last = false; !last;) {
+                const auto substep = next_substep(t, delta_t_max, delta_t_frame);
+                REQUIRE(steps.size() < 1000);
+                steps.push_back(substep.delta_t);
+                t += substep.delta_t;
+                last = substep.last;
+            }
+            return steps;
+        }
+    }
+
+    TEST_CASE("wavy::next_substep.schedule", "[fluid_base][substeps]")
+    {
+        constexpr float delta_t_frame = 1.0f / 60.0f;
+        auto ratio = GENERATE(0.3f, 0.9f, 1.0f, 1.5f, 2.2f, 3.5f, 7.01f, 12.7f);
+        const auto delta_t_max = delta_t_frame / ratio;
+
+        const auto steps = detail::schedule_frame(delta_t_max, delta_t_frame);
+        REQUIRE(steps.size() == static_cast<std::size_t>(std::ceil(ratio)));
+        float t = 0.0f;
+        for (auto step : steps) {
+            t += step;
+            REQUIRE(step <= delta_t_max * (1.0f + 1e-5f));
+            // splitting the rest in two leaves no step shorter than half a stable step.
+            REQUIRE(step >= 0.5f * std::min(delta_t_max, delta_t_frame) * (1.0f - 1e-5f));
+        }
+        REQUIRE(t == Approx(delta_t_frame).epsilon(1e-6));
+    }
+
+    TEST_CASE("wavy::next_substep.without a limit", "[fluid_base][substeps]")
+    {
+        constexpr float delta_t_frame = 0.1f;
+        auto delta_t_max = GENERATE(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN(),
+                                    0.0f, -0.01f);
+
+        const auto substep = next_substep(0.0f, delta_t_max, delta_t_frame);
+        REQUIRE(substep.last);
+        REQUIRE(substep.delta_t == delta_t_frame);
+        // a step that cannot advance the time ends the frame as well.
+        REQUIRE(next_substep(0.05f, 1e-12f, delta_t_frame).last);
+    }
+}
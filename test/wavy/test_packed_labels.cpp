@@ -0,0 +1,70 @@
+/**
+ * @file   test_packed_labels.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.31
+ *
+ * @brief  Tests for the bit packed cell labels.
+ */
+
+#include "packed_labels.h"
+
+#include <algorithm>
+#include <catch.hpp>
+#include <vector>
+
+namespace wavy
+{
+    namespace detail
+    {
+        std::vector<CellLabel> test_labels(std::size_t size)
+        {
+            std::vector<CellLabel> labels(size);
+            for (std::size_t i = 0; i < size; ++i) { labels[i] = static_cast<CellLabel>((i * 7 + i / 5) % 3); }
+            return labels;
+        }
+    }
+
+    TEST_CASE("wavy::PackedLabels.get and set", "[packed_labels]")
+    {
+        auto labels = detail::test_labels(101);
+        PackedLabels packed{labels};
+        REQUIRE(packed.size() == labels.size());
+        for (std::size_t i = 0; i < labels.size(); ++i) { REQUIRE(packed.get(i) == labels[i]); }
+
+        packed.set(33, CellLabel::EMPTY);
+        labels[33] = CellLabel::EMPTY;
+        REQUIRE(packed.get(32) == labels[32]);
+        REQUIRE(packed.get(33) == CellLabel::EMPTY);
+        REQUIRE(packed.get(34) == labels[34]);
+    }
+
+    TEST_CASE("wavy::PackedLabels.masks", "[packed_labels]")
+    {
+        const auto labels = detail::test_labels(101);
+        const PackedLabels packed{labels};
+        auto label = GENERATE(CellLabel::FLUID, CellLabel::SOLID, CellLabel::EMPTY);
+        for (std::ptrdiff_t first = -40; first < 110; ++first) {
+            auto mask = packed.mask64(label, first, CellLabel::SOLID);
+            for (std::ptrdiff_t lane = 0; lane < 64; ++lane) {
+                const auto index = first + lane;
+                const auto expected = index < 0 || index >= 101 ? CellLabel::SOLID : labels[static_cast<std::size_t>(index)];
+                REQUIRE(((mask >> lane) & 1U) == (expected == label ? 1U : 0U));
+            }
+        }
+        REQUIRE(packed.count(label) == static_cast<std::size_t>(std::ranges::count(labels, label)));
+    }
+
+    TEST_CASE("wavy::PackedLabels.find_run", "[packed_labels]")
+    {
+        std::vector<CellLabel> labels(200, CellLabel::EMPTY);
+        std::fill(std::begin(labels) + 20, std::begin(labels) + 90, CellLabel::FLUID);
+        std::fill(std::begin(labels) + 150, std::end(labels), CellLabel::FLUID);
+        const PackedLabels packed{labels};
+
+        REQUIRE(packed.find_run(CellLabel::FLUID, 0) == std::pair<std::size_t, std::size_t>{20, 90});
+        REQUIRE(packed.find_run(CellLabel::FLUID, 50) == std::pair<std::size_t, std::size_t>{50, 90});
+        REQUIRE(packed.find_run(CellLabel::FLUID, 90) == std::pair<std::size_t, std::size_t>{150, 200});
+        REQUIRE(packed.find_run(CellLabel::SOLID, 0) == std::pair<std::size_t, std::size_t>{200, 200});
+        REQUIRE(packed.count(CellLabel::FLUID) == 120);
+    }
+}
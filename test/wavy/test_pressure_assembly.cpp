@@ -0,0 +1,262 @@
+/**
+ * @file   test_pressure_assembly.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.10
+ *
+ * @brief  Tests for the assembly of the pressure system, shared by the 1d, 2d and 3d fluid solver.
+ */
+
+#include "fluid1d.h"
+#include "fluid2d.h"
+#include "fluid3d.h"
+
+#include <catch.hpp>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace wavy
+{
+    namespace detail
+    {
+        constexpr float assembly_delta_x = 0.01f;
+        constexpr float assembly_density = 1000.0f;
+        constexpr float assembly_gravity = -9.81f;
+
+        /** Face velocities, one vector per component. */
+        using FaceVelocity = std::vector<std::vector<float>>;
+
+        /** Gives the tests access to the assembly stages of a solver. */
+        template<typename Solver>
+        class AssemblyAccess : public Solver
+        {
+        public:
+            using Solver::Solver;
+            using Solver::pressureMatrix;
+            using Solver::pressureRhs;
+            using Solver::setup_A;
+
+            /** Overwrites an entry of the cached matrix diagonal, which the matrix views as constant. */
+            void overwriteDiagonal(std::size_t index, float value)
+            {
+                const_cast<float&>(pressureMatrix().diag[index]) = value; // NOLINT(cppcoreguidelines-pro-type-const-cast)
+            }
+        };
+
+        /** Water with solid cells in between and air at the end. */
+        class AssemblySolver1D : public AssemblyAccess<FluidSolver1D>
+        {
+        public:
+            static constexpr std::size_t size = 64;
+
+            AssemblySolver1D() : AssemblyAccess{size, assembly_delta_x, assembly_gravity, assembly_density}
+            {
+                std::vector<CellLabel> labels(size, CellLabel::FLUID);
+                for (std::size_t i = 5; i < size; i += 9) { labels[i] = CellLabel::SOLID; }
+                for (std::size_t i = 40; i < size; ++i) { labels[i] = CellLabel::EMPTY; }
+                setLabels(labels);
+            }
+
+            [[nodiscard]] static std::vector<std::size_t> faceCounts() { return {size + 1}; }
+
+            void project(float delta_t, FaceVelocity& velocity)
+            {
+                FluidSolver1D::project(delta_t, velocity[0], velocity[0], at_rest_view());
+            }
+
+            void rhs(const FaceVelocity& velocity, std::span<float> result) const
+            {
+                presure_gradient_rhs(velocity[0], result, at_rest_view());
+            }
+
+            void changeLabels()
+            {
+                std::vector<CellLabel> labels = labels_data();
+                labels[20] = CellLabel::EMPTY;
+                setLabels(labels);
+            }
+
+        private:
+            static float at_rest([[maybe_unused]] std::size_t idx) { return 0.0f; }
+            static mysh::core::function_view<float(std::size_t)> at_rest_view()
+            {
+                return mysh::core::function_view<float(std::size_t)>{at_rest};
+            }
+        };
+
+        /** Water in the lower rows with a solid cell in it, air above. */
+        class AssemblySolver2D : public AssemblyAccess<FluidSolver2D>
+        {
+        public:
+            static constexpr std::size_t size_x = 48;
+            static constexpr std::size_t size_y = 40;
+
+            AssemblySolver2D()
+                : AssemblyAccess{size_x, size_y, assembly_delta_x, assembly_gravity, assembly_density}
+            {
+                std::vector<CellLabel> labels(size_x * size_y, CellLabel::FLUID);
+                std::fill(labels.begin() + static_cast<std::ptrdiff_t>(24 * size_x), labels.end(), CellLabel::EMPTY);
+                labels[3 * size_x + 7] = CellLabel::SOLID;
+                setLabels(labels);
+            }
+
+            [[nodiscard]] static std::vector<std::size_t> faceCounts()
+            {
+                return {(size_x + 1) * size_y, size_x * (size_y + 1)};
+            }
+
+            void project(float delta_t, FaceVelocity& velocity)
+            {
+                FluidSolver2D::project(delta_t, {velocity[0], velocity[1]});
+            }
+
+            void rhs(const FaceVelocity& velocity, std::span<float> result) const
+            {
+                presure_gradient_rhs({velocity[0], velocity[1]}, result);
+            }
+
+            void changeLabels()
+            {
+                labels_data()[10 * size_x + 10] = CellLabel::SOLID;
+                labelsChanged();
+            }
+        };
+
+        /** A block of water in front of a solid wall, air everywhere else. */
+        class AssemblySolver3D : public AssemblyAccess<FluidSolver3D>
+        {
+        public:
+            static constexpr std::array<std::size_t, 3> size = {32, 16, 16};
+
+            AssemblySolver3D()
+                : AssemblyAccess{size[0], size[1], size[2], assembly_delta_x, assembly_gravity, assembly_density}
+            {
+                setLabels(block_labels(6));
+            }
+
+            [[nodiscard]] static std::vector<std::size_t> faceCounts()
+            {
+                std::vector<std::size_t> result;
+                for (std::size_t d = 0; d < 3; ++d) {
+                    auto sizes = size;
+                    sizes[d] += 1;
+                    result.push_back(sizes[0] * sizes[1] * sizes[2]);
+                }
+                return result;
+            }
+
+            void project(float delta_t, FaceVelocity& velocity)
+            {
+                FluidSolver3D::project(delta_t, {velocity[0], velocity[1], velocity[2]});
+            }
+
+            void rhs(const FaceVelocity& velocity, std::span<float> result) const
+            {
+                presure_gradient_rhs({velocity[0], velocity[1], velocity[2]}, result);
+            }
+
+            void changeLabels() { setLabels(block_labels(4)); }
+
+        private:
+            /** Fluid in the cells with i < 12 and j < height, solid from i = 24 on. */
+            static std::vector<CellLabel> block_labels(std::size_t height)
+            {
+                std::vector<CellLabel> labels(size[0] * size[1] * size[2], CellLabel::EMPTY);
+                for (std::size_t k = 0; k < size[2]; ++k) {
+                    for (std::size_t j = 0; j < size[1]; ++j) {
+                        for (std::size_t i = 0; i < size[0]; ++i) {
+                            auto& label = labels[i + size[0] * (j + size[1] * k)];
+                            if (i >= 24) { label = CellLabel::SOLID; }
+                            if (i < 12 && j < height) { label = CellLabel::FLUID; }
+                        }
+                    }
+                }
+                return labels;
+            }
+        };
+
+        /** Copies the diagonal and the couplings of a matrix. */
+        template<std::size_t D>
+        std::vector<std::vector<float>> matrix_values(const solver::PoissonStencil<D>& A)
+        {
+            std::vector<std::vector<float>> result{{A.diag.begin(), A.diag.end()}};
+            for (auto plus : A.plus) { result.emplace_back(plus.begin(), plus.end()); }
+            return result;
+        }
+
+        /** Random velocities for faces of the given counts per component. */
+        FaceVelocity random_face_velocity(const std::vector<std::size_t>& counts)
+        {
+            std::mt19937 generator{42}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+            std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+            FaceVelocity result;
+            for (auto count : counts) {
+                auto& q = result.emplace_back(count);
+                std::ranges::generate(q, [&] { return distribution(generator); });
+            }
+            return result;
+        }
+    }
+
+    TEMPLATE_TEST_CASE("wavy::FluidSolver.fused assembly", "[assemble]", detail::AssemblySolver1D,
+                       detail::AssemblySolver2D, detail::AssemblySolver3D)
+    {
+        // the projection assembles rhs and matrix in one pass, it has to match the separate stages.
+        constexpr float delta_t = 0.01f;
+        TestType solver;
+        const auto velocity = detail::random_face_velocity(TestType::faceCounts());
+        auto projected = velocity;
+        solver.project(delta_t, projected);
+        const std::vector<float> fused_rhs{solver.pressureRhs().begin(), solver.pressureRhs().end()};
+        const auto fused_A = detail::matrix_values(solver.pressureMatrix());
+
+        std::vector<float> rhs(fused_rhs.size());
+        solver.rhs(velocity, rhs);
+        solver.setup_A(delta_t);
+        REQUIRE(fused_rhs == rhs);
+        REQUIRE(fused_A == detail::matrix_values(solver.pressureMatrix()));
+    }
+
+    TEMPLATE_TEST_CASE("wavy::FluidSolver.matrix cache", "[assemble]", detail::AssemblySolver1D,
+                       detail::AssemblySolver2D, detail::AssemblySolver3D)
+    {
+        constexpr float delta_t = 0.01f;
+        TestType solver;
+        auto velocity = detail::random_face_velocity(TestType::faceCounts());
+        auto expected_A = [&solver](float step) {
+            solver.setup_A(step);
+            return detail::matrix_values(solver.pressureMatrix());
+        };
+
+        solver.project(delta_t, velocity);
+        const auto cached = detail::matrix_values(solver.pressureMatrix());
+
+        SECTION("unchanged labels and time step")
+        {
+            // the first cell is fluid in every setup, a rebuilt matrix would restore its diagonal.
+            const auto marker = 2.0f * cached[0][0];
+            REQUIRE(marker > 0.0f);
+            solver.overwriteDiagonal(0, marker);
+            solver.project(delta_t, velocity);
+            REQUIRE(solver.pressureMatrix().diag[0] == marker);
+        }
+
+        SECTION("changed labels")
+        {
+            solver.changeLabels();
+            solver.project(delta_t, velocity);
+            const auto A = detail::matrix_values(solver.pressureMatrix());
+            REQUIRE(A != cached);
+            REQUIRE(A == expected_A(delta_t));
+        }
+
+        SECTION("changed time step")
+        {
+            solver.project(2.0f * delta_t, velocity);
+            const auto A = detail::matrix_values(solver.pressureMatrix());
+            REQUIRE(A != cached);
+            REQUIRE(A == expected_A(2.0f * delta_t));
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * @file   test_boundary_span.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.24
+ *
+ * @brief  Tests for the boundary and padded spans.
+ */
+
+#include "utils/boundary_span.h"
+#include "utils/padded_span.h"
+
+#include <catch.hpp>
+#include <numeric>
+#include <vector>
+
+namespace wavy::utils
+{
+    namespace detail
+    {
+        // negative indices as the solvers produce them from unsigned index arithmetic.
+        constexpr std::size_t before(std::size_t offset) { return std::size_t{0} - offset; }
+    }
+
+    TEST_CASE("wavy::utils::boundary_span.policies", "[boundary_span]")
+    {
+        std::vector<int> v(5);
+        std::iota(std::begin(v), std::end(v), 10);
+        const std::span<const int> content{v};
+
+        SECTION("clamp")
+        {
+            const boundary_span<const int> q{content};
+            REQUIRE(q[2] == 12);
+            REQUIRE(q[detail::before(1)] == 10);
+            REQUIRE(q[detail::before(7)] == 10);
+            REQUIRE(q[5] == 14);
+            REQUIRE(q[100] == 14);
+        }
+
+        SECTION("periodic")
+        {
+            const boundary_span<const int, boundary::periodic> q{content};
+            REQUIRE(q[detail::before(1)] == 14);
+            REQUIRE(q[detail::before(6)] == 14);
+            REQUIRE(q[5] == 10);
+            REQUIRE(q[12] == 12);
+        }
+
+        SECTION("reflect")
+        {
+            const boundary_span<const int, boundary::reflect> q{content};
+            REQUIRE(q[detail::before(1)] == 10);
+            REQUIRE(q[detail::before(2)] == 11);
+            REQUIRE(q[5] == 14);
+            REQUIRE(q[6] == 13);
+            REQUIRE(q[10] == 10);
+        }
+
+        SECTION("constant")
+        {
+            const boundary_span<const int, boundary::constant<int>> q{content, boundary::constant<int>{-1}};
+            REQUIRE(q[0] == 10);
+            REQUIRE(q[detail::before(1)] == -1);
+            REQUIRE(q[5] == -1);
+        }
+
+        SECTION("functor")
+        {
+            const boundary_span q{content, [](std::span<const int> c, std::ptrdiff_t idx) {
+                                      return static_cast<int>(idx) * c.front();
+                                  }};
+            REQUIRE(q[3] == 13);
+            REQUIRE(q[detail::before(2)] == -20);
+            REQUIRE(q[6] == 60);
+        }
+    }
+
+    TEST_CASE("wavy::utils::boundary_span.stateless policies add no storage", "[boundary_span]")
+    {
+        STATIC_REQUIRE(sizeof(boundary_span<float>) == sizeof(std::span<float>));
+        STATIC_REQUIRE(sizeof(boundary_span<float, boundary::periodic>) == sizeof(std::span<float>));
+    }
+
+    TEST_CASE("wavy::utils::padded_span.ghost cells", "[padded_span]")
+    {
+        constexpr std::size_t size = 6;
+        constexpr std::size_t ghosts = 2;
+        std::vector<float> storage(padded_size(size, ghosts), 0.0f);
+        const padded_span<float> q{storage, ghosts};
+        REQUIRE(q.size() == size);
+        std::iota(std::begin(q.get_content()), std::end(q.get_content()), 1.0f);
+
+        SECTION("matches the boundary span of the same policy")
+        {
+            q.fill_ghost_cells(boundary::reflect{});
+            const boundary_span<float, boundary::reflect> reference{q.get_content()};
+            const padded_span<const float> read_only = q;
+            for (std::size_t offset = 1; offset <= ghosts; ++offset) {
+                REQUIRE(read_only[detail::before(offset)] == reference[detail::before(offset)]);
+                REQUIRE(read_only[size - 1 + offset] == reference[size - 1 + offset]);
+            }
+        }
+
+        SECTION("clamp")
+        {
+            q.fill_ghost_cells();
+            REQUIRE(storage == std::vector<float>{1.0f, 1.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 6.0f, 6.0f});
+        }
+    }
+}
@@ -158,4 +158,39 @@ namespace wavy::utils
             });
         }
     }
+
+    TEST_CASE_METHOD(enumerate_fixture, "wavy::utils.enumerate.random access iterator", "[enumerate][random_access]")
+    {
+        auto enum_v = enumerate_v();
+        using enum_iterator = decltype(std::begin(enum_v));
+        STATIC_REQUIRE(std::is_same_v<std::iterator_traits<enum_iterator>::iterator_category,
+                                      std::random_access_iterator_tag>);
+
+        constexpr std::ptrdiff_t offset = 11;
+        auto first = std::begin(enum_v);
+        auto last = std::end(enum_v);
+        REQUIRE(last - first == static_cast<std::ptrdiff_t>(detail::vector_size));
+        REQUIRE(enum_v.size() == detail::vector_size);
+        REQUIRE(first < last);
+
+        auto it = first + offset;
+        REQUIRE(std::get<0>(*it) == offset);
+        REQUIRE(std::get<1>(*it) == offset);
+        REQUIRE(std::get<0>(first[offset]) == offset);
+        REQUIRE(std::get<0>(*(last - 1)) == detail::vector_size - 1);
+        it -= offset;
+        REQUIRE(it == first);
+    }
+
+    TEST_CASE_METHOD(enumerate_fixture_nested, "wavy::utils.enumerate.nested zip random access",
+                     "[enumerate][nested][random_access]")
+    {
+        auto enum_v = enumerate_v();
+        auto first = std::begin(enum_v);
+        for (std::ptrdiff_t i = static_cast<std::ptrdiff_t>(enum_v.size()) - 1; i >= 0; --i) {
+            auto [index, value] = first[i];
+            REQUIRE(index == static_cast<std::size_t>(i));
+            REQUIRE(index + 10 == std::get<1>(value));
+        }
+    }
 }
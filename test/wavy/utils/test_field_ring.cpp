@@ -0,0 +1,37 @@
+/**
+ * @file   test_field_ring.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.27
+ *
+ * @brief  Tests for the field ring.
+ */
+
+#include "utils/field_ring.h"
+
+#include <catch.hpp>
+
+namespace wavy::utils
+{
+    TEST_CASE("wavy::utils::field_ring.rotate", "[field_ring]")
+    {
+        constexpr std::size_t size = 16;
+        field_ring<float, 3> ring{size, 1.0f};
+        REQUIRE(ring.size() == size);
+        REQUIRE(ring.current()[size - 1] == 1.0f);
+
+        auto* first = ring.current().data();
+        auto* second = ring.next().data();
+        auto* third = ring.next(2).data();
+        REQUIRE(ring.next(3).data() == first);
+
+        ring.current()[0] = 2.0f;
+        ring.rotate();
+        REQUIRE(ring.current().data() == second);
+        REQUIRE(ring.next().data() == third);
+        REQUIRE(ring.next(2)[0] == 2.0f);
+
+        ring.rotate(2);
+        REQUIRE(ring.current().data() == first);
+        REQUIRE(ring.current()[0] == 2.0f);
+    }
+}
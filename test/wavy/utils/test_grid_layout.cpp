@@ -0,0 +1,53 @@
+/**
+ * @file   test_grid_layout.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.28
+ *
+ * @brief  Tests for the grid layout and its tiling.
+ */
+
+#include "utils/grid_layout.h"
+
+#include <algorithm>
+#include <catch.hpp>
+#include <vector>
+
+namespace wavy::utils
+{
+    TEST_CASE("wavy::utils::grid_layout.indexing", "[grid_layout]")
+    {
+        const grid_layout<3> layout{{5, 4, 3}};
+        REQUIRE(layout.cell_count() == 60);
+        REQUIRE(layout.stride(0) == 1);
+        REQUIRE(layout.stride(1) == 5);
+        REQUIRE(layout.stride(2) == 20);
+        REQUIRE(layout.linear({2, 3, 1}) == 37);
+        REQUIRE(layout.coords(37) == std::array<std::size_t, 3>{2, 3, 1});
+        for (std::size_t i = 0; i < layout.cell_count(); ++i) { REQUIRE(layout.linear(layout.coords(i)) == i); }
+
+        REQUIRE(layout.contains({4, 3, 2}));
+        REQUIRE_FALSE(layout.contains({5, 0, 0}));
+        REQUIRE_FALSE(layout.contains({0, -1, 0}));
+    }
+
+    TEST_CASE("wavy::utils::tile_grid.covers every cell once", "[grid_layout]")
+    {
+        const grid_layout<2> layout{{10, 7}};
+        const tile_grid<2> tiles{layout, {4, 3}};
+        REQUIRE(tiles.size() == 9);
+        REQUIRE(tiles.tile(8).first == std::array<std::size_t, 2>{8, 6});
+        REQUIRE(tiles.tile(8).last == std::array<std::size_t, 2>{10, 7});
+
+        std::vector<int> visits(layout.cell_count(), 0);
+        std::vector<std::size_t> order;
+        for (auto tile : tiles.indices()) {
+            for_each_cell(tiles.tile(tile), [&](const auto& cell) {
+                visits[layout.linear(cell)] += 1;
+                if (tile == 0) { order.push_back(layout.linear(cell)); }
+            });
+        }
+        REQUIRE(std::ranges::all_of(visits, [](int count) { return count == 1; }));
+        // x runs fastest inside a tile.
+        REQUIRE(order == std::vector<std::size_t>{0, 1, 2, 3, 10, 11, 12, 13, 20, 21, 22, 23});
+    }
+}
@@ -0,0 +1,42 @@
+/**
+ * @file   test_index_range.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.22
+ *
+ * @brief  Tests for the index range.
+ */
+
+#include "utils/index_range.h"
+
+#include <catch.hpp>
+#include <execution>
+#include <numeric>
+#include <vector>
+
+namespace wavy::utils
+{
+    TEST_CASE("wavy::utils::index_range.strided", "[index_range]")
+    {
+        std::vector<std::size_t> visited;
+        for (auto i : indices(3, 20, 4)) { visited.push_back(i); }
+        REQUIRE(visited == std::vector<std::size_t>{3, 7, 11, 15, 19});
+        REQUIRE(indices(3, 20, 4).size() == 5);
+        REQUIRE(indices(3, 19, 4).size() == 4);
+        REQUIRE(indices(5, 5).empty());
+        REQUIRE(indices(6, 5).empty());
+    }
+
+    TEST_CASE("wavy::utils::index_range.for_each with std_par", "[index_range][std::for_each]")
+    {
+        constexpr std::size_t size = 1000;
+        std::vector<std::size_t> v(size, 0);
+        auto range = indices(0, size, 2);
+        STATIC_REQUIRE(std::is_same_v<std::iterator_traits<decltype(std::begin(range))>::iterator_category,
+                                      std::random_access_iterator_tag>);
+        std::for_each(std::execution::par, std::begin(range), std::end(range), [&v](std::size_t i) { v[i] = i; });
+        for (std::size_t i = 0; i < size; ++i) { REQUIRE(v[i] == (i % 2 == 0 ? i : 0)); }
+
+        auto sum = std::reduce(std::execution::par, std::begin(range), std::end(range), std::size_t{0});
+        REQUIRE(sum == 249500);
+    }
+}
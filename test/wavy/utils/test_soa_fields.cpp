@@ -0,0 +1,92 @@
+/**
+ * @file   test_soa_fields.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.11.04
+ *
+ * @brief  Tests for the structure of arrays field container.
+ */
+
+#include "utils/soa_fields.h"
+
+#include <algorithm>
+#include <catch.hpp>
+
+namespace wavy::utils
+{
+    namespace
+    {
+        struct Pressure {};
+        struct Rhs {};
+        struct Flags {};
+
+        using cell_fields =
+            soa_fields<field_channel<Pressure>, field_channel<Flags, std::uint8_t>, field_channel<Rhs, double>>;
+    }
+
+    static_assert(cell_fields::index_of<Rhs> == 2);
+    static_assert(std::is_same_v<cell_fields::value_type_of<Flags>, std::uint8_t>);
+
+    TEST_CASE("wavy::utils::soa_fields.layout", "[soa_fields]")
+    {
+        auto size = GENERATE(std::size_t{1}, std::size_t{15}, std::size_t{1000});
+        cell_fields fields{size};
+        REQUIRE(fields.size() == size);
+
+        auto [p, flags, rhs] = fields.channels<Pressure, Flags, Rhs>();
+        REQUIRE(p.size() == size);
+        REQUIRE(flags.size() == size);
+        REQUIRE(rhs.size() == size);
+        // new cells are value initialized and every channel starts on its own cache line.
+        REQUIRE(std::ranges::all_of(rhs, [](double value) { return value == 0.0; }));
+        for (const auto* channel : {static_cast<const void*>(p.data()), static_cast<const void*>(flags.data()),
+                                    static_cast<const void*>(rhs.data())}) {
+            REQUIRE(std::bit_cast<std::uintptr_t>(channel) % cell_fields::channel_alignment == 0);
+        }
+        REQUIRE(static_cast<const void*>(p.data() + size) <= static_cast<const void*>(flags.data()));
+        REQUIRE(static_cast<const void*>(flags.data() + size) <= static_cast<const void*>(rhs.data()));
+    }
+
+    TEST_CASE("wavy::utils::soa_fields.access", "[soa_fields]")
+    {
+        cell_fields fields{10};
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            auto cell = fields[i];
+            cell.get<Pressure>() = static_cast<float>(i);
+            cell.get<Flags>() = static_cast<std::uint8_t>(i % 2);
+            cell.get<Rhs>() = 2.0 * static_cast<double>(i);
+        }
+
+        const auto& const_fields = fields;
+        REQUIRE(const_fields[3].get<Pressure>() == 3.0f);
+        REQUIRE(const_fields.channel<Flags>()[3] == 1);
+        REQUIRE(const_fields.channel<Rhs>()[9] == 18.0);
+
+        SECTION("resize keeps the values")
+        {
+            fields.resize(20);
+            REQUIRE(fields.channel<Pressure>()[9] == 9.0f);
+            REQUIRE(fields.channel<Rhs>()[9] == 18.0);
+            REQUIRE(fields.channel<Rhs>()[19] == 0.0);
+            fields.resize(5);
+            REQUIRE(fields.size() == 5);
+            REQUIRE(fields[4].get<Rhs>() == 8.0);
+            fields.resize(0);
+            REQUIRE(fields.empty());
+            REQUIRE(fields.channel<Pressure>().empty());
+        }
+
+        SECTION("copy and move")
+        {
+            auto copy = fields;
+            REQUIRE(copy.channel<Pressure>().data() != fields.channel<Pressure>().data());
+            REQUIRE(std::ranges::equal(copy.channel<Rhs>(), fields.channel<Rhs>()));
+
+            const auto* data = copy.channel<Flags>().data();
+            cell_fields moved{std::move(copy)};
+            REQUIRE(moved.channel<Flags>().data() == data);
+            fields = std::move(moved);
+            REQUIRE(fields.channel<Flags>().data() == data);
+            REQUIRE(fields[7].get<Pressure>() == 7.0f);
+        }
+    }
+}
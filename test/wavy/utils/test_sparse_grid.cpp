@@ -0,0 +1,67 @@
+/**
+ * @file   test_sparse_grid.cpp
+ * @author Sebastian Maisch <sebastian.maisch@googlemail.com>
+ * @date   2023.10.30
+ *
+ * @brief  Tests for the sparse block grid.
+ */
+
+#include "cell_label.h"
+#include "utils/sparse_grid.h"
+
+#include <catch.hpp>
+#include <vector>
+
+namespace wavy::utils
+{
+    TEST_CASE("wavy::utils::sparse_grid.lookup", "[sparse_grid]")
+    {
+        sparse_grid<float, 3, 2> grid{{10, 9, 7}, -1.0f};
+        REQUIRE(grid.blocks().sizes() == std::array<std::size_t, 3>{3, 3, 2});
+        REQUIRE(grid.block_count() == 0);
+        REQUIRE(grid.get({9, 8, 6}) == -1.0f);
+        REQUIRE(grid.find({9, 8, 6}) == nullptr);
+
+        grid.set({9, 8, 6}, 3.0f);
+        grid.set({8, 8, 4}, 4.0f);
+        grid.set({1, 2, 3}, 5.0f);
+        REQUIRE(grid.block_count() == 2);
+        REQUIRE(grid.get({9, 8, 6}) == 3.0f);
+        REQUIRE(grid.get({8, 8, 4}) == 4.0f);
+        REQUIRE(grid.get({1, 2, 3}) == 5.0f);
+        // untouched cells of an allocated block hold the background.
+        REQUIRE(grid.get({8, 8, 5}) == -1.0f);
+        REQUIRE(*grid.find({1, 2, 3}) == 5.0f);
+
+        auto box = grid.block_box(0);
+        REQUIRE(box.first == std::array<std::size_t, 3>{8, 8, 4});
+        REQUIRE(box.last == std::array<std::size_t, 3>{10, 9, 7});
+
+        grid.set({1, 2, 3}, -1.0f);
+        grid.prune();
+        REQUIRE(grid.block_count() == 1);
+        REQUIRE(grid.get({1, 2, 3}) == -1.0f);
+        REQUIRE(grid.get({9, 8, 6}) == 3.0f);
+    }
+
+    TEST_CASE("wavy::utils::sparse_grid.from dense labels", "[sparse_grid]")
+    {
+        const grid_layout<2> layout{{64, 32}};
+        std::vector<CellLabel> dense(layout.cell_count(), CellLabel::EMPTY);
+        for (std::size_t y = 0; y < 4; ++y) {
+            for (std::size_t x = 0; x < 20; ++x) { dense[layout.linear({x, y})] = CellLabel::FLUID; }
+        }
+
+        auto is_fluid = [](CellLabel label) { return label == CellLabel::FLUID; };
+        const auto fluid = sparse_grid<CellLabel, 2>::from_dense(layout, dense, CellLabel::EMPTY, is_fluid);
+        REQUIRE(fluid.block_count() == 3);
+        const auto surface = sparse_grid<CellLabel, 2>::from_dense(layout, dense, CellLabel::EMPTY, is_fluid, 1);
+        REQUIRE(surface.block_count() == 8);
+        REQUIRE(surface.memory_usage() < dense.size() * sizeof(CellLabel));
+
+        for (std::size_t i = 0; i < layout.cell_count(); ++i) {
+            REQUIRE(fluid.get(layout.coords(i)) == dense[i]);
+            REQUIRE(surface.get(layout.coords(i)) == dense[i]);
+        }
+    }
+}
@@ -11,6 +11,7 @@
 
 #include <catch.hpp>
 #include <execution>
+#include <list>
 #include <numeric>
 #include <vector>
 
@@ -144,4 +145,56 @@ namespace wavy::utils
             });
         }
     }
+
+    TEST_CASE_METHOD(zip_fixture, "wavy::utils.zip.random access iterator", "[zip][random_access]")
+    {
+        auto zipper = zip_v();
+        using zip_iterator = decltype(std::begin(zipper));
+        STATIC_REQUIRE(std::is_same_v<std::iterator_traits<zip_iterator>::iterator_category,
+                                      std::random_access_iterator_tag>);
+
+        constexpr std::ptrdiff_t offset = 7;
+        auto first = std::begin(zipper);
+        auto last = std::end(zipper);
+        REQUIRE(last - first == 50);
+        REQUIRE(first - last == -50);
+        REQUIRE(zipper.size() == 50);
+        REQUIRE(first < last);
+        REQUIRE(last > first + offset);
+
+        auto it = first + offset;
+        REQUIRE(std::get<0>(*it) == offset);
+        REQUIRE(std::get<1>(first[offset]) == offset + 10);
+        REQUIRE(it - first == offset);
+        it -= offset;
+        REQUIRE(it == first);
+        REQUIRE(std::get<0>(*(last - 1)) == 49);
+    }
+
+    TEST_CASE_METHOD(zip_fixture, "wavy::utils.zip.nested random access iterator", "[zip][nested][random_access]")
+    {
+        auto zipper = zip_nested_v();
+        using zip_iterator = decltype(std::begin(zipper));
+        STATIC_REQUIRE(std::is_same_v<std::iterator_traits<zip_iterator>::iterator_category,
+                                      std::random_access_iterator_tag>);
+
+        auto first = std::begin(zipper);
+        REQUIRE(std::end(zipper) - first == 50);
+        for (std::ptrdiff_t i = 0; i < 50; ++i) {
+            auto [value0, value1] = first[i];
+            REQUIRE(std::get<0>(value0) == static_cast<std::size_t>(i));
+            REQUIRE(std::get<1>(value0) + 10 == value1);
+        }
+    }
+
+    TEST_CASE("wavy::utils.zip.forward iterator fallback", "[zip][forward]")
+    {
+        std::list<int> l{1, 2, 3};
+        std::vector<int> v{4, 5, 6};
+        auto zipper = zip(l, v);
+        using zip_iterator = decltype(std::begin(zipper));
+        STATIC_REQUIRE(std::is_same_v<std::iterator_traits<zip_iterator>::iterator_category,
+                                      std::forward_iterator_tag>);
+        for (auto [value0, value1] : zipper) { REQUIRE(value0 + 3 == value1); }
+    }
 }